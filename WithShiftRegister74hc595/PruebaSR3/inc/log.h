@@ -0,0 +1,84 @@
+#ifndef LOG_H_INCLUDED
+#define LOG_H_INCLUDED
+
+/**
+ *  @file log.h
+ *  @code
+ *  #define LOG_MODULE_LEVEL MAIN_LOG_LEVEL
+ *  #include <log.h>
+ *  @endcode
+ *
+ *  @brief Debug traces with compile-time levels.
+ *
+ *  Each message has a level. Messages above the level of the module are
+ *  removed by the preprocessor and cost neither flash, SRAM nor time. The
+ *  others are sent with uart_puts_p(), the strings stay in program memory.
+ *
+ *  The level of a module is LOG_MODULE_LEVEL, defined before including this
+ *  file, or LOG_LEVEL otherwise. Both can be set per build, e.g.
+ *  make CDEFS=-DMAIN_LOG_LEVEL=LOG_LEVEL_TRACE.
+ *
+ *  @note The message argument must be a string literal.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Levels, a module shows the messages up to its own level.
+ */
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_TRACE 5
+
+/**
+ *  @brief Default level of the modules without LOG_MODULE_LEVEL.
+ */
+#ifndef LOG_LEVEL
+# define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_MODULE_LEVEL
+# define LOG_MODULE_LEVEL LOG_LEVEL
+#endif
+
+/**
+ *  @brief Message macros, empty statements above the module level.
+ */
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_ERROR
+# define LOG_ERROR(msg) uart_puts_P(msg)
+#else
+# define LOG_ERROR(msg) do { } while (0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_WARN
+# define LOG_WARN(msg) uart_puts_P(msg)
+#else
+# define LOG_WARN(msg) do { } while (0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_INFO
+# define LOG_INFO(msg) uart_puts_P(msg)
+#else
+# define LOG_INFO(msg) do { } while (0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_DEBUG
+# define LOG_DEBUG(msg) uart_puts_P(msg)
+#else
+# define LOG_DEBUG(msg) do { } while (0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_TRACE
+# define LOG_TRACE(msg) uart_puts_P(msg)
+#else
+# define LOG_TRACE(msg) do { } while (0)
+#endif
+
+#endif /* LOG_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
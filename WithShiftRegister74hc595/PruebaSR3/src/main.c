@@ -19,6 +19,13 @@
 #include <util/delay.h>
 #include "uart.h"
 
+/* Traces of this module, e.g. make CDEFS=-DMAIN_LOG_LEVEL=LOG_LEVEL_TRACE */
+#ifndef MAIN_LOG_LEVEL
+# define MAIN_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#define LOG_MODULE_LEVEL MAIN_LOG_LEVEL
+#include "log.h"
+
 /* Constants and macros ------------------------------------------------------*/
 /**
   * @brief Serial data input of 74HC595 shift register.
@@ -36,9 +43,15 @@
 #define LATCH_SHIFT PD4
 
 /**
-  * @brief Define UART buad rate
+  * @brief Define UART buad rate, e.g. make CDEFS=-DUART_BAUD_RATE=115200
   */
-#define UART_BAUD_RATE 9600
+#ifndef UART_BAUD_RATE
+# define UART_BAUD_RATE 9600
+#endif
+
+#if UART_BAUD_ERROR_AUTO(UART_BAUD_RATE, F_CPU) > UART_BAUD_ERROR_MAX
+# error "UART_BAUD_RATE cannot be generated from F_CPU accurately enough"
+#endif
 
 /* Function prototypes -------------------------------------------------------*/
 void setup(void);
@@ -105,12 +118,12 @@ int main(void)
 
     /* Enables interrupts by setting the global interrupt mask */
     //sei();
-    uart_puts("In\r\n");
+    LOG_INFO("In\r\n");
     /* Forever loop */
     while (1)
     {
 
-        uart_puts("In while of main\r\n");
+        LOG_DEBUG("In while of main\r\n");
         do_animation(1,0,4);
     	_delay_ms(200);
         do_animation(0,0,0);
@@ -140,7 +153,10 @@ void setup(void)
     sei();
     _delay_ms(100);
     /* Initialize UART: asynchronous, 8-bit data, no parity, 1-bit stop */
-    uart_init(UART_BAUD_SELECT(UART_BAUD_RATE, F_CPU));
+    uart_init(UART_BAUD_SELECT_AUTO(UART_BAUD_RATE, F_CPU));
+    /* Debug traces are dropped when the buffer is full instead of stalling
+     * the shift register updates */
+    uart_tx_policy(UART_TX_DROP_NEWEST, 0);
 
     /* Timer/Counter0: select clock and enable overflow */
     /* Clock prescaler 1024 => overflows every 16 ms */
@@ -157,7 +173,7 @@ void setup(void)
 void do_animation(uint8_t SR1, uint8_t SR2, uint8_t SR3)
 {
     uint8_t u8_i;
-    uart_puts("In do_animation\r\n");
+    LOG_TRACE("In do_animation\r\n");
 	/* Animation variable will cycle through animation_1 array */
 	/* j will change inside the for loop to jump the specific amount
 	 * for each SR */
@@ -175,7 +191,7 @@ void do_animation(uint8_t SR1, uint8_t SR2, uint8_t SR3)
 	/* Load bits for SR3 */
     for(u8_i = 0u; u8_i < 8u; u8_i++)
     {
-        uart_puts("1o for chivato\r\n");
+        LOG_TRACE("1o for chivato\r\n");
         if((SR3 << u8_i) & 0x80u)
             PORTB |= _BV(DATA_SHIFT); //write me a 1 on pin 8
         else
@@ -188,7 +204,7 @@ void do_animation(uint8_t SR1, uint8_t SR2, uint8_t SR3)
 	/* Load bits for SR2 */
 	for(u8_i = 0u; u8_i < 8u; u8_i++)
     {
-        uart_puts("2o for chivato\r\n");
+        LOG_TRACE("2o for chivato\r\n");
         if((SR2 << u8_i) & 0x80u)
             PORTB |= _BV(DATA_SHIFT); //write me a 1 on pin 8
         else
@@ -201,7 +217,7 @@ void do_animation(uint8_t SR1, uint8_t SR2, uint8_t SR3)
 	/* Load bits for SR1 */
 	for(u8_i = 0u; u8_i < 8u; u8_i++)
     {
-        uart_puts("Last for chivato\r\n");
+        LOG_TRACE("Last for chivato\r\n");
         if((SR1 << u8_i) & 0x80u)
             PORTB |= _BV(DATA_SHIFT); //write me a 1 on pin 8
         else
@@ -219,7 +235,7 @@ void do_animation(uint8_t SR1, uint8_t SR2, uint8_t SR3)
 
     /* Set latch input of shift register to low */
     PORTD &= ~_BV(LATCH_SHIFT);
-    uart_puts("Latch done\r\n");
+    LOG_TRACE("Latch done\r\n");
 }
 
 /**
@@ -36,9 +36,13 @@
 *   GNU General Public License for more details.
 *
 *************************************************************************/
+#include "settings.h"
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+#include <string.h>
 #include "uart.h"
 
 
@@ -346,6 +350,11 @@ static volatile unsigned char UART_RxHead;
 static volatile unsigned char UART_RxTail;
 static volatile unsigned char UART_LastRxError;
 
+/* behaviour of uart_putc() when the transmit buffer is full */
+static unsigned char UART_TxPolicy = UART_TX_BLOCK;
+static unsigned int  UART_TxTimeout;
+static unsigned int  UART_TxDropped;
+
 #if defined( ATMEGA_USART1 )
 static volatile unsigned char UART1_TxBuf[UART_TX_BUFFER_SIZE];
 static volatile unsigned char UART1_RxBuf[UART_RX_BUFFER_SIZE];
@@ -466,9 +475,16 @@ void uart_init(unsigned int baudrate)
         #if UART0_BIT_U2X
         UART0_STATUS = (1 << UART0_BIT_U2X); // Enable 2x speed
         #endif
+        baudrate &= ~0x8000;
+    }
+    #if UART0_BIT_U2X
+    else
+    {
+        UART0_STATUS = 0; // a bootloader may have left 2x speed on
     }
+    #endif
     #if defined(UART0_UBRRH)
-    UART0_UBRRH = (unsigned char) ((baudrate >> 8) & 0x80);
+    UART0_UBRRH = (unsigned char) ((baudrate >> 8) & 0x0F);
     #endif
     UART0_UBRRL = (unsigned char) (baudrate & 0x00FF);
 
@@ -526,13 +542,55 @@ unsigned int uart_getc(void)
 void uart_putc(unsigned char data)
 {
     unsigned char tmphead;
+    unsigned int  wait;
 
 
     tmphead = (UART_TxHead + 1) & UART_TX_BUFFER_MASK;
 
-    while (tmphead == UART_TxTail)
+    if (tmphead == UART_TxTail)
     {
-        ;/* wait for free space in buffer */
+        switch (UART_TxPolicy)
+        {
+        case UART_TX_DROP_NEWEST:
+            /* discard this byte */
+            if (UART_TxDropped != 0xFFFF)
+                UART_TxDropped++;
+            return;
+
+        case UART_TX_DROP_OLDEST:
+            /* discard the next byte to be sent, the transmit interrupt
+               must not move the tail at the same time */
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            {
+                if (tmphead == UART_TxTail)
+                {
+                    UART_TxTail = (UART_TxTail + 1) & UART_TX_BUFFER_MASK;
+                    if (UART_TxDropped != 0xFFFF)
+                        UART_TxDropped++;
+                }
+            }
+            break;
+
+        case UART_TX_TIMEOUT:
+            for (wait = UART_TxTimeout; tmphead == UART_TxTail; wait--)
+            {
+                if (wait == 0)
+                {
+                    if (UART_TxDropped != 0xFFFF)
+                        UART_TxDropped++;
+                    return;
+                }
+                _delay_us(1);
+            }
+            break;
+
+        default:
+            while (tmphead == UART_TxTail)
+            {
+                ;/* wait for free space in buffer */
+            }
+            break;
+        }
     }
 
     UART_TxBuf[tmphead] = data;
@@ -568,6 +626,83 @@ void uart_puts_p(const char *progmem_s)
         uart_putc(c);
 }/* uart_puts_p */
 
+/*************************************************************************
+ * Function: uart_write()
+ * Purpose:  copy a block to the transmit ringbuffer without waiting
+ * Input:    buffer and number of bytes to be transmitted
+ * Returns:  number of bytes accepted, less than len if the buffer is full
+ **************************************************************************/
+unsigned int uart_write(const void *buf, unsigned int len)
+{
+    const unsigned char *src = buf;
+    unsigned char head;
+    unsigned char start;
+    unsigned char space;
+    unsigned int chunk;
+
+
+    /* only the transmit interrupt moves the tail, the free space can
+       only grow while copying */
+    head  = UART_TxHead;
+    start = (head + 1) & UART_TX_BUFFER_MASK;
+    space = (UART_TxTail - head - 1) & UART_TX_BUFFER_MASK;
+
+    if (len > space)
+        len = space;
+    if (len == 0)
+        return 0;
+
+    /* at most two contiguous chunks: up to the end of the buffer, then
+       from the start of the buffer */
+    chunk = UART_TX_BUFFER_SIZE - start;
+    if (chunk > len)
+        chunk = len;
+    memcpy((unsigned char *)&UART_TxBuf[start], src, chunk);
+    if (len > chunk)
+        memcpy((unsigned char *)&UART_TxBuf[0], src + chunk, len - chunk);
+
+    /* publish the new head once */
+    UART_TxHead = (head + len) & UART_TX_BUFFER_MASK;
+
+    /* enable UDRE interrupt */
+    UART0_CONTROL |= _BV(UART0_UDRIE);
+
+    return len;
+}/* uart_write */
+
+/*************************************************************************
+ * Function: uart_tx_free()
+ * Purpose:  free space in the transmit ringbuffer
+ * Returns:  number of bytes that can be written without waiting
+ **************************************************************************/
+unsigned int uart_tx_free(void)
+{
+    return (UART_TxTail - UART_TxHead - 1) & UART_TX_BUFFER_MASK;
+}/* uart_tx_free */
+
+/*************************************************************************
+ * Function: uart_tx_policy()
+ * Purpose:  select what uart_putc() does when the ringbuffer is full
+ * Input:    policy UART_TX_BLOCK, UART_TX_DROP_NEWEST, UART_TX_DROP_OLDEST
+ *           or UART_TX_TIMEOUT, timeout in microseconds for UART_TX_TIMEOUT
+ * Returns:  none
+ **************************************************************************/
+void uart_tx_policy(unsigned char policy, unsigned int timeout_us)
+{
+    UART_TxPolicy  = policy;
+    UART_TxTimeout = timeout_us;
+}/* uart_tx_policy */
+
+/*************************************************************************
+ * Function: uart_tx_dropped()
+ * Purpose:  number of bytes discarded because the ringbuffer was full
+ * Returns:  byte count since uart_init(), saturates at 0xFFFF
+ **************************************************************************/
+unsigned int uart_tx_dropped(void)
+{
+    return UART_TxDropped;
+}/* uart_tx_dropped */
+
 /*
  * these functions are only for ATmegas with two USART
  */
@@ -674,8 +809,15 @@ void uart1_init(unsigned int baudrate)
         # if UART1_BIT_U2X
         UART1_STATUS = (1 << UART1_BIT_U2X); // Enable 2x speed
         # endif
+        baudrate &= ~0x8000;
     }
-    UART1_UBRRH = (unsigned char) ((baudrate >> 8) & 0x80);
+    # if UART1_BIT_U2X
+    else
+    {
+        UART1_STATUS = 0;
+    }
+    # endif
+    UART1_UBRRH = (unsigned char) ((baudrate >> 8) & 0x0F);
     UART1_UBRRL = (unsigned char) baudrate;
 
     /* Enable USART receiver and transmitter and receive complete interrupt */
@@ -0,0 +1,163 @@
+/**
+  ******************************************************************************
+  * @file    crcbench.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Checks both table flavours of src/crc.c against a bitwise
+  *          reference and compares their cost per byte.
+  *
+  *          crcbench [megabytes]
+  *
+  *          Times are measured on the host, so only the ratio between the
+  *          flavours carries over to the AVR. Cycle counts on the target are
+  *          taken from the .lss listing or a simulator run of the firmware.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 199309L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "crc.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define BLOCK 4096
+
+/* Function prototypes -------------------------------------------------------*/
+static uint8_t crc8_bitwise(uint8_t crc, uint8_t data);
+static uint16_t crc16_bitwise(uint16_t crc, uint8_t data);
+static double now(void);
+
+/* Global variables ----------------------------------------------------------*/
+static uint8_t block[BLOCK];
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Main function.
+  */
+int main(int argc, char *argv[])
+{
+    static const char check[] = "123456789";
+    long megabytes = (argc > 1) ? strtol(argv[1], NULL, 10) : 64;
+    long rounds = megabytes * 1024L * 1024L / BLOCK;
+    uint8_t c8[3] = {CRC8_INIT, CRC8_INIT, CRC8_INIT};
+    uint16_t c16[3] = {CRC16_INIT, CRC16_INIT, CRC16_INIT};
+    volatile uint16_t sink = 0;
+    double start, t[4];
+    long r;
+    int i, failed = 0;
+
+    for (i = 0; i < BLOCK; i++) {
+        block[i] = (uint8_t)rand();
+    }
+
+    /* Check values and random data against the bitwise reference */
+    for (i = 0; check[i]; i++) {
+        c8[0] = crc8_bitwise(c8[0], check[i]);
+        c8[1] = crc8_update_nibble(c8[1], check[i]);
+        c8[2] = crc8_update_full(c8[2], check[i]);
+        c16[0] = crc16_bitwise(c16[0], check[i]);
+        c16[1] = crc16_update_nibble(c16[1], check[i]);
+        c16[2] = crc16_update_full(c16[2], check[i]);
+    }
+    printf("check    crc8 %02x %02x %02x (f4)  crc16 %04x %04x %04x (29b1)\n",
+           c8[0], c8[1], c8[2], c16[0], c16[1], c16[2]);
+    failed |= c8[0] != 0xf4 || c8[1] != 0xf4 || c8[2] != 0xf4;
+    failed |= c16[0] != 0x29b1 || c16[1] != 0x29b1 || c16[2] != 0x29b1;
+    for (i = 0; i < BLOCK; i++) {
+        c8[0] = crc8_bitwise(c8[0], block[i]);
+        c8[1] = crc8_update_nibble(c8[1], block[i]);
+        c8[2] = crc8_update_full(c8[2], block[i]);
+        c16[0] = crc16_bitwise(c16[0], block[i]);
+        c16[1] = crc16_update_nibble(c16[1], block[i]);
+        c16[2] = crc16_update_full(c16[2], block[i]);
+    }
+    failed |= c8[0] != c8[1] || c8[0] != c8[2];
+    failed |= c16[0] != c16[1] || c16[0] != c16[2];
+    if (failed) {
+        printf("FAILED: table flavours differ from the reference\n");
+        return EXIT_FAILURE;
+    }
+
+    start = now();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < BLOCK; i++) {
+            c8[1] = crc8_update_nibble(c8[1], block[i]);
+        }
+    }
+    t[0] = now() - start;
+    start = now();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < BLOCK; i++) {
+            c8[2] = crc8_update_full(c8[2], block[i]);
+        }
+    }
+    t[1] = now() - start;
+    start = now();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < BLOCK; i++) {
+            c16[1] = crc16_update_nibble(c16[1], block[i]);
+        }
+    }
+    t[2] = now() - start;
+    start = now();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < BLOCK; i++) {
+            c16[2] = crc16_update_full(c16[2], block[i]);
+        }
+    }
+    t[3] = now() - start;
+    sink = c8[1] ^ c8[2] ^ c16[1] ^ c16[2];
+    (void)sink;
+
+    r = rounds * BLOCK;
+    printf("%-20s %10s %12s\n", "flavour", "table [B]", "ns/byte");
+    printf("%-20s %10d %12.2f\n", "crc8 nibble", 16, t[0] * 1e9 / r);
+    printf("%-20s %10d %12.2f\n", "crc8 full", 256, t[1] * 1e9 / r);
+    printf("%-20s %10d %12.2f\n", "crc16 nibble", 32, t[2] * 1e9 / r);
+    printf("%-20s %10d %12.2f\n", "crc16 full", 512, t[3] * 1e9 / r);
+    return EXIT_SUCCESS;
+}
+
+/**
+  * @brief CRC-8 one bit at a time.
+  */
+static uint8_t crc8_bitwise(uint8_t crc, uint8_t data)
+{
+    int i;
+
+    crc ^= data;
+    for (i = 0; i < 8; i++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+/**
+  * @brief CRC-16/CCITT one bit at a time.
+  */
+static uint16_t crc16_bitwise(uint16_t crc, uint8_t data)
+{
+    int i;
+
+    crc ^= (uint16_t)data << 8;
+    for (i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+/**
+  * @brief Monotonic time in seconds.
+  */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,514 @@
+/**
+  ******************************************************************************
+  * @file    cubeview.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Live view of the cube in a terminal: decodes the UART frame
+  *          stream (see inc/stream.h) and draws the LEDs in ANSI colours,
+  *          red, green or both mixed, at 16 levels.
+  *
+  *          cubeview [-p port] [-b baud] [-i] [-r rate]
+  *             -p  serial port, pseudo terminal or named pipe to read, e.g.
+  *                 the one printed by streamer -t or given to sim -F;
+  *                 stdin otherwise
+  *             -b  baud rate of a serial port, default 115200
+  *             -i  isometric view, the three layers side by side otherwise
+  *             -r  redraws per second at most, default 50
+  *
+  *          Every packet is decoded as it arrives, the screen shows the
+  *          newest frame at most rate times per second, so any number of
+  *          frames per second is followed without falling behind. The
+  *          terminal needs 24-bit colour and UTF-8. GND1 is the bottom
+  *          layer, column 1 the back left one seen from above.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "crc.h"
+#include "stream.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define LEDS (CUBE_LAYERS * CUBE_COLOURS * CUBE_COLUMNS)
+#define LED(layer, colour, column) \
+    (((layer) * CUBE_COLOURS + (colour)) * CUBE_COLUMNS + (column))
+#define LEVEL_MAX 15
+
+/* Decoded packet and its COBS encoding without delimiter */
+#define PACKET_MAX  (STREAM_HEADER + STREAM_GREY_SIZE + STREAM_TRAILER)
+#define ENCODED_MAX (PACKET_MAX + PACKET_MAX / 254 + 1)
+
+/* Bytes per read, several hundred frames */
+#define READ_SIZE 4096
+
+#define SCREEN_SIZE 8192
+
+/* Isometric view: a step along a row moves 6 characters right, a row to
+ * the back 2 right and 1 up, a layer 4 up */
+#define ISO_WIDTH  17
+#define ISO_HEIGHT 11
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief Receive counters, as stream_stats_t of the firmware.
+ */
+typedef struct {
+    unsigned long frames;
+    unsigned long lost;
+    unsigned long stale;
+    unsigned long errors;
+} counters_t;
+
+/* Function prototypes -------------------------------------------------------*/
+static int open_input(const char *path, speed_t speed);
+static speed_t baud_to_speed(long baud);
+static void on_signal(int number);
+static void restore_terminal(void);
+static long now_ms(void);
+static void feed(uint8_t data, long now);
+static int cobs_decode(const uint8_t *data, size_t length, uint8_t *out);
+static void packet(const uint8_t *data, int length, long now);
+static void draw(int isometric, double fps, double redraws);
+static void draw_layers(void);
+static void draw_isometric(void);
+static void led(uint8_t layer, uint8_t column);
+static void put(const char *format, ...);
+
+/* Global variables ----------------------------------------------------------*/
+static volatile sig_atomic_t quit = 0;
+
+/* Newest frame, level 0..15 per LED */
+static uint8_t level[LEDS];
+
+/* COBS bytes since the last delimiter */
+static uint8_t encoded[ENCODED_MAX];
+static size_t encoded_length = 0;
+static int overflow = 0;
+
+/* Last frame shown, 0 before the first one */
+static uint8_t sequence;
+static long frame_time = 0;
+static int started = 0;
+
+static counters_t counters;
+
+static char screen[SCREEN_SIZE];
+static size_t screen_length;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Main function.
+  */
+int main(int argc, char *argv[])
+{
+    const char *port = NULL;
+    int isometric = 0, fd, opt, eof = 0, dirty = 1;
+    long baud = 115200, rate = 50, next_draw, next_second, now;
+    unsigned long frames_then = 0, redraws = 0;
+    double fps = 0.0, redraw_rate = 0.0;
+    uint8_t buffer[READ_SIZE];
+    struct pollfd pfd;
+    speed_t speed;
+    ssize_t n, i;
+
+    while ((opt = getopt(argc, argv, "p:b:ir:")) != -1) {
+        switch (opt) {
+        case 'p':
+            port = optarg;
+            break;
+        case 'b':
+            baud = strtol(optarg, NULL, 10);
+            break;
+        case 'i':
+            isometric = 1;
+            break;
+        case 'r':
+            rate = strtol(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-b baud] [-i] [-r rate]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    speed = baud_to_speed(baud);
+    if (speed == B0 || rate <= 0) {
+        fprintf(stderr, "%s: unsupported baud rate %ld or rate <= 0\n",
+                argv[0], baud);
+        return EXIT_FAILURE;
+    }
+    fd = open_input(port, speed);
+    if (fd < 0) {
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    atexit(restore_terminal);
+    /* Clear the screen and hide the cursor */
+    fputs("\033[2J\033[?25l", stdout);
+    fflush(stdout);
+
+    now = now_ms();
+    next_draw = now;
+    next_second = now + 1000;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    while (!quit && !eof) {
+        int timeout = (int)((dirty ? next_draw : next_second) - now);
+
+        if (poll(&pfd, 1, timeout > 0 ? timeout : 0) > 0) {
+            n = read(fd, buffer, sizeof(buffer));
+            /* A pseudo terminal reports EIO once the other side closed */
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                eof = 1;
+            }
+            now = now_ms();
+            for (i = 0; i < n; i++) {
+                feed(buffer[i], now);
+            }
+            if (n > 0) {
+                dirty = 1;
+            }
+        }
+        now = now_ms();
+
+        if (now >= next_second) {
+            fps = (counters.frames - frames_then) * 1000.0 /
+                  (now - next_second + 1000);
+            redraw_rate = redraws * 1000.0 / (now - next_second + 1000);
+            frames_then = counters.frames;
+            redraws = 0;
+            next_second = now + 1000;
+            dirty = 1;
+        }
+        /* Coalesce: only the newest frame is drawn, at most rate per second */
+        if ((dirty && now >= next_draw) || eof) {
+            draw(isometric, fps, redraw_rate);
+            redraws++;
+            dirty = 0;
+            next_draw = now + 1000 / rate;
+        }
+    }
+
+    close(fd);
+    return EXIT_SUCCESS;
+}
+
+/**
+  * @brief Open the input, a terminal in raw mode, 8N1.
+  * @param path - File to open, NULL for stdin
+  * @return File descriptor, -1 on error
+  */
+static int open_input(const char *path, speed_t speed)
+{
+    struct termios tio;
+    int fd = path != NULL ? open(path, O_RDONLY | O_NOCTTY) : STDIN_FILENO;
+
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (!isatty(fd)) {
+        return fd;
+    }
+    if (path == NULL) {
+        fprintf(stderr, "cubeview: give -p port or pipe the frames in\n");
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) < 0) {
+        perror("tcgetattr");
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        perror("tcsetattr");
+        return -1;
+    }
+    return fd;
+}
+
+/**
+  * @brief termios speed of a baud rate.
+  * @return Speed, B0 if not supported
+  */
+static speed_t baud_to_speed(long baud)
+{
+    switch (baud) {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 500000:  return B500000;
+    case 1000000: return B1000000;
+    default:      return B0;
+    }
+}
+
+/**
+  * @brief Leave the main loop on Ctrl+C.
+  */
+static void on_signal(int number)
+{
+    (void)number;
+    quit = 1;
+}
+
+/**
+  * @brief Show the cursor again and reset the colours.
+  */
+static void restore_terminal(void)
+{
+    fputs("\033[0m\033[?25h\n", stdout);
+    fflush(stdout);
+}
+
+/**
+  * @brief Monotonic time in milliseconds.
+  */
+static long now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/**
+  * @brief Collect one received byte, 0x00 ends a packet.
+  */
+static void feed(uint8_t data, long now)
+{
+    uint8_t decoded[ENCODED_MAX];
+    int length;
+
+    if (data != 0) {
+        if (encoded_length < sizeof(encoded)) {
+            encoded[encoded_length++] = data;
+        }
+        else {
+            overflow = 1;
+        }
+        return;
+    }
+
+    if (encoded_length > 0) {
+        length = overflow ? -1 :
+                 cobs_decode(encoded, encoded_length, decoded);
+        packet(decoded, length, now);
+    }
+    encoded_length = 0;
+    overflow = 0;
+}
+
+/**
+  * @brief COBS decode a packet without its delimiter.
+  * @return Decoded length, -1 if a block runs past the end
+  */
+static int cobs_decode(const uint8_t *data, size_t length, uint8_t *out)
+{
+    size_t i = 0, n = 0;
+    uint8_t code, j;
+
+    while (i < length) {
+        code = data[i++];
+        if (i + code - 1 > length) {
+            return -1;
+        }
+        for (j = 1; j < code; j++) {
+            out[n++] = data[i++];
+        }
+        /* Every block but a full one and the last is followed by a zero */
+        if (code != 0xff && i < length) {
+            out[n++] = 0;
+        }
+    }
+    return (int)n;
+}
+
+/**
+  * @brief Check a decoded packet and take its frame, with the sequence
+  *        rules of src/stream.c.
+  * @param length - Decoded length, -1 for a broken packet
+  */
+static void packet(const uint8_t *data, int length, long now)
+{
+    int running = started && now - frame_time < STREAM_TIMEOUT_MS;
+    int size, n;
+
+    size = length < STREAM_HEADER ? -1 :
+           data[1] == STREAM_BINARY ? STREAM_BINARY_SIZE :
+           data[1] == STREAM_GREY ? STREAM_GREY_SIZE : -1;
+    if (size < 0 || length != STREAM_HEADER + size + STREAM_TRAILER ||
+        crc8_block(CRC8_INIT, data, length) != 0) {
+        /* Noise before the first frame, e.g. the shell command streamer
+         * sends first, is not an error */
+        if (started) {
+            counters.errors++;
+        }
+        return;
+    }
+    if (running && (int8_t)(data[0] - sequence) <= 0) {
+        counters.stale++;
+        return;
+    }
+    if (running) {
+        counters.lost += (uint8_t)(data[0] - sequence - 1);
+    }
+    sequence = data[0];
+    frame_time = now;
+    started = 1;
+    counters.frames++;
+
+    data += STREAM_HEADER;
+    for (n = 0; n < LEDS; n++) {
+        if (size == STREAM_BINARY_SIZE) {
+            level[n] = (data[n >> 3] >> (n & 7)) & 0x01 ? LEVEL_MAX : 0;
+        }
+        else {
+            level[n] = (data[n >> 1] >> ((n & 1) * 4)) & 0x0f;
+        }
+    }
+}
+
+/**
+  * @brief Draw the newest frame and the counters in one write.
+  */
+static void draw(int isometric, double fps, double redraws)
+{
+    screen_length = 0;
+    put("\033[H\033[0mcubeview, %s\033[K\n\n",
+        isometric ? "isometric" : "layers seen from above");
+    if (isometric) {
+        draw_isometric();
+    }
+    else {
+        draw_layers();
+    }
+    put("\n\033[0m%lu frames, %.0f fps, %.0f redraws/s, %lu lost, "
+        "%lu stale, %lu errors%s\033[K\n", counters.frames, fps, redraws,
+        counters.lost, counters.stale, counters.errors,
+        started && now_ms() - frame_time >= STREAM_TIMEOUT_MS ?
+        ", no frames" : "");
+    if (write(STDOUT_FILENO, screen, screen_length) < 0) {
+        quit = 1;
+    }
+}
+
+/**
+  * @brief Three 3x3 layers side by side, GND1 on the left.
+  */
+static void draw_layers(void)
+{
+    uint8_t layer, row, column;
+
+    for (layer = 0; layer < CUBE_LAYERS; layer++) {
+        put("\033[0m  GND%u     ", layer + 1);
+    }
+    put("\033[K\n");
+    for (row = 0; row < 3; row++) {
+        for (layer = 0; layer < CUBE_LAYERS; layer++) {
+            put("  ");
+            for (column = 3 * row; column < 3 * row + 3; column++) {
+                led(layer, column);
+                put(" ");
+            }
+            put("    ");
+        }
+        put("\033[K\n");
+    }
+}
+
+/**
+  * @brief Cube in isometric projection, GND3 on top, columns 1..3 at the
+  *        back.
+  */
+static void draw_isometric(void)
+{
+    int x, y, layer, line, position, found;
+
+    for (line = 0; line < ISO_HEIGHT; line++) {
+        put("  ");
+        for (position = 0; position < ISO_WIDTH; position++) {
+            found = 0;
+            for (layer = 0; layer < CUBE_LAYERS && !found; layer++) {
+                /* Rows from the back (0) to the front (2) */
+                y = line - 4 * (CUBE_LAYERS - 1 - layer);
+                if (y < 0 || y > 2 || (position - 2 * (2 - y)) % 6 != 0) {
+                    continue;
+                }
+                x = (position - 2 * (2 - y)) / 6;
+                if (x >= 0 && x <= 2) {
+                    led(layer, 3 * y + x);
+                    found = 1;
+                }
+            }
+            if (!found) {
+                put(" ");
+            }
+        }
+        /* Layer name next to its middle row */
+        if (line % 4 == 1) {
+            put("\033[0m  GND%d", CUBE_LAYERS - line / 4);
+        }
+        put("\033[K\n");
+    }
+}
+
+/**
+  * @brief One LED: red and green levels mixed, a dot when off.
+  */
+static void led(uint8_t layer, uint8_t column)
+{
+    unsigned red = level[LED(layer, CUBE_RED, column)];
+    unsigned green = level[LED(layer, CUBE_GREEN, column)];
+
+    if (red == 0 && green == 0) {
+        put("\033[38;2;70;70;70m·");
+        return;
+    }
+    /* Level 1 still visible on a black background */
+    put("\033[38;2;%u;%u;0m●",
+        red ? 55 + red * 200 / LEVEL_MAX : 0,
+        green ? 55 + green * 200 / LEVEL_MAX : 0);
+}
+
+/**
+  * @brief Append to the screen buffer.
+  */
+static void put(const char *format, ...)
+{
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsnprintf(&screen[screen_length], sizeof(screen) - screen_length,
+                  format, args);
+    va_end(args);
+    if (n > 0) {
+        screen_length += (size_t)n;
+        if (screen_length >= sizeof(screen)) {
+            screen_length = sizeof(screen) - 1;
+        }
+    }
+}
+
+/* END OF FILE ****************************************************************/
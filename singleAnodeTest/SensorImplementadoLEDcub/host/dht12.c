@@ -0,0 +1,359 @@
+/**
+  ******************************************************************************
+  * @file    dht12.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   DHT12 on the simulated TWI bus: register reads with checksum,
+  *          scripted measurements and fault injection.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "sim.h"
+#include "dht12.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define DHT12_CYCLES_MS (F_CPU / 1000)
+#define DHT12_LINE_SIZE 256
+
+/* Sign of the temperature in register 3 */
+#define DHT12_NEGATIVE 0x80
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    DHT12_POINT,
+    DHT12_NACK,
+    DHT12_CHECKSUM,
+    DHT12_STUCK
+} dht12_kind_t;
+
+/* Line of the script */
+typedef struct {
+    uint64_t cycles;
+    dht12_kind_t kind;
+    /* Point: degree C and %, faults: count or milliseconds in value */
+    double temperature;
+    double value;
+} dht12_event_t;
+
+/* Function prototypes -------------------------------------------------------*/
+static uint8_t dht12_load(const char *path);
+static void dht12_advance(uint64_t now);
+static void dht12_measure(uint64_t now);
+static void dht12_encode(double value, uint8_t *integer, uint8_t *decimal);
+static uint8_t dht12_start(void *context, uint8_t read);
+static uint8_t dht12_write(void *context, uint8_t data);
+static uint8_t dht12_read(void *context, uint8_t ack);
+static uint8_t dht12_hold(void *context);
+
+/* Global variables ----------------------------------------------------------*/
+static const sim_twi_device_t dht12_device = {
+    .address = DHT12_ADDRESS,
+    .start = dht12_start,
+    .write = dht12_write,
+    .read = dht12_read,
+    .stop = NULL,
+    .hold = dht12_hold,
+    .context = NULL
+};
+
+static dht12_event_t *dht12_events = NULL;
+static size_t dht12_total = 0;
+/* Faults before this event are applied */
+static size_t dht12_applied = 0;
+
+/* Registers, the copy of the read in progress and the register pointer */
+static uint8_t dht12_registers[DHT12_REGISTERS];
+static uint8_t dht12_out[DHT12_REGISTERS];
+static uint8_t dht12_pointer = 0;
+static uint8_t dht12_first = 0;
+static uint8_t dht12_measured = 0;
+static uint64_t dht12_measured_at;
+
+/* Pending faults */
+static uint32_t dht12_nacks = 0;
+static uint32_t dht12_corrupt = 0;
+static uint64_t dht12_stuck_end = 0;
+
+/* Counters for dht12_report() */
+static uint32_t dht12_transfers = 0;
+static uint32_t dht12_reads = 0;
+static uint32_t dht12_nacked = 0;
+static uint32_t dht12_corrupted = 0;
+static uint32_t dht12_stucks = 0;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Load the script and attach the sensor.
+  */
+uint8_t dht12_init(const char *path)
+{
+    if (dht12_load(path)) {
+        return 1;
+    }
+    if (sim_twi_attach(&dht12_device)) {
+        fprintf(stderr, "dht12: TWI bus full\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief Transfers and injected faults.
+  */
+void dht12_report(void)
+{
+    fprintf(stderr, "dht12: %u transfers, %u reads, injected %u NACKs, "
+            "%u bad checksums, %u stuck SDA\n", dht12_transfers, dht12_reads,
+            dht12_nacked, dht12_corrupted, dht12_stucks);
+}
+
+/**
+  * @brief Parse the script into dht12_events.
+  * @return 0, 1 on error
+  */
+static uint8_t dht12_load(const char *path)
+{
+    char line[DHT12_LINE_SIZE], word[32], extra;
+    dht12_event_t event, *events;
+    unsigned number = 0;
+    uint8_t points = 0;
+    double ms, value;
+    char *end;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        number++;
+        if ((end = strchr(line, '#')) != NULL) {
+            *end = '\0';
+        }
+        switch (sscanf(line, "%lf %31s %lf %c", &ms, word, &value, &extra)) {
+        case EOF:
+            continue;
+        case 3:
+            break;
+        default:
+            fprintf(stderr, "%s:%u: expected: ms temperature humidity, "
+                    "or ms nack|checksum|stuck value\n", path, number);
+            fclose(file);
+            return 1;
+        }
+
+        memset(&event, 0, sizeof(event));
+        event.cycles = (uint64_t)(ms * DHT12_CYCLES_MS);
+        event.value = value;
+        if (strcmp(word, "nack") == 0) {
+            event.kind = DHT12_NACK;
+        }
+        else if (strcmp(word, "checksum") == 0) {
+            event.kind = DHT12_CHECKSUM;
+        }
+        else if (strcmp(word, "stuck") == 0) {
+            event.kind = DHT12_STUCK;
+        }
+        else {
+            event.kind = DHT12_POINT;
+            event.temperature = strtod(word, &end);
+            if (*end != '\0') {
+                fprintf(stderr, "%s:%u: unknown event %s\n", path, number, word);
+                fclose(file);
+                return 1;
+            }
+            points = 1;
+        }
+        if (ms < 0 || (dht12_total > 0 &&
+                       event.cycles < dht12_events[dht12_total - 1].cycles)) {
+            fprintf(stderr, "%s:%u: times must ascend\n", path, number);
+            fclose(file);
+            return 1;
+        }
+
+        events = realloc(dht12_events, (dht12_total + 1) * sizeof(*events));
+        if (events == NULL) {
+            perror("dht12");
+            fclose(file);
+            return 1;
+        }
+        dht12_events = events;
+        dht12_events[dht12_total++] = event;
+    }
+    fclose(file);
+
+    if (!points) {
+        fprintf(stderr, "%s: no measurement\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief Apply the faults that became due.
+  */
+static void dht12_advance(uint64_t now)
+{
+    const dht12_event_t *event;
+
+    while (dht12_applied < dht12_total &&
+           dht12_events[dht12_applied].cycles <= now) {
+        event = &dht12_events[dht12_applied++];
+        switch (event->kind) {
+        case DHT12_NACK:
+            dht12_nacks += (uint32_t)event->value;
+            break;
+        case DHT12_CHECKSUM:
+            dht12_corrupt += (uint32_t)event->value;
+            break;
+        case DHT12_STUCK:
+            dht12_stuck_end = event->cycles +
+                              (uint64_t)(event->value * DHT12_CYCLES_MS);
+            dht12_stucks++;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+  * @brief New measurement: the curve of the script at time now.
+  */
+static void dht12_measure(uint64_t now)
+{
+    const dht12_event_t *before = NULL, *after = NULL;
+    double temperature, humidity, part;
+    size_t i;
+
+    for (i = 0; i < dht12_total; i++) {
+        if (dht12_events[i].kind != DHT12_POINT) {
+            continue;
+        }
+        if (dht12_events[i].cycles <= now) {
+            before = &dht12_events[i];
+        }
+        else {
+            after = &dht12_events[i];
+            break;
+        }
+    }
+    if (before == NULL) {
+        before = after;
+    }
+    temperature = before->temperature;
+    humidity = before->value;
+    if (after != NULL && after != before) {
+        part = (double)(now - before->cycles) / (after->cycles - before->cycles);
+        temperature += part * (after->temperature - before->temperature);
+        humidity += part * (after->value - before->value);
+    }
+    if (humidity < 0) {
+        humidity = 0;
+    }
+    else if (humidity > 100) {
+        humidity = 100;
+    }
+
+    dht12_encode(humidity, &dht12_registers[0], &dht12_registers[1]);
+    dht12_encode(temperature, &dht12_registers[2], &dht12_registers[3]);
+    dht12_registers[4] = (uint8_t)(dht12_registers[0] + dht12_registers[1] +
+                                   dht12_registers[2] + dht12_registers[3]);
+    dht12_measured = 1;
+    dht12_measured_at = now;
+}
+
+/**
+  * @brief Integer and tenths register of a value, sign in bit 7 of tenths.
+  */
+static void dht12_encode(double value, uint8_t *integer, uint8_t *decimal)
+{
+    long tenths = (long)(value * 10 + (value < 0 ? -0.5 : 0.5));
+    uint8_t sign = 0;
+
+    if (tenths < 0) {
+        sign = DHT12_NEGATIVE;
+        tenths = -tenths;
+    }
+    if (tenths > 2559) {
+        tenths = 2559;
+    }
+    *integer = (uint8_t)(tenths / 10);
+    *decimal = (uint8_t)(tenths % 10) | sign;
+}
+
+/**
+  * @brief Addressed: NACK if injected, otherwise start a write or a read.
+  */
+static uint8_t dht12_start(void *context, uint8_t read)
+{
+    uint64_t now = sim_cycles();
+
+    dht12_advance(now);
+    if (dht12_nacks) {
+        dht12_nacks--;
+        dht12_nacked++;
+        return 0;
+    }
+    dht12_transfers++;
+    if (!read) {
+        dht12_first = 1;
+        return 1;
+    }
+
+    if (!dht12_measured ||
+        now - dht12_measured_at >= (uint64_t)DHT12_UPDATE_MS * DHT12_CYCLES_MS) {
+        dht12_measure(now);
+    }
+    memcpy(dht12_out, dht12_registers, sizeof(dht12_out));
+    if (dht12_corrupt) {
+        dht12_corrupt--;
+        dht12_corrupted++;
+        dht12_out[4] ^= 0x01;
+    }
+    dht12_reads++;
+    return 1;
+}
+
+/**
+  * @brief Byte written: the first one is the register pointer, the registers
+  *        are read only.
+  */
+static uint8_t dht12_write(void *context, uint8_t data)
+{
+    if (dht12_first) {
+        dht12_pointer = data;
+        dht12_first = 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief Byte read, from the register pointer on.
+  */
+static uint8_t dht12_read(void *context, uint8_t ack)
+{
+    uint8_t value = dht12_pointer < DHT12_REGISTERS ?
+                    dht12_out[dht12_pointer] : 0xff;
+
+    dht12_pointer++;
+    return value;
+}
+
+/**
+  * @brief SDA held low during an injected stuck period.
+  */
+static uint8_t dht12_hold(void *context)
+{
+    uint64_t now = sim_cycles();
+
+    dht12_advance(now);
+    return now < dht12_stuck_end;
+}
+
+/* END OF FILE ****************************************************************/
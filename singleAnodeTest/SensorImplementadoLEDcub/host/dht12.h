@@ -0,0 +1,63 @@
+#ifndef DHT12_H_INCLUDED
+#define DHT12_H_INCLUDED
+
+/**
+ *  @file dht12.h
+ *  @code #include "dht12.h" @endcode
+ *
+ *  @brief DHT12 temperature and humidity sensor on the TWI bus of the
+ *         simulator, at address 0x5c like the real part.
+ *
+ *  Register map as read by src/sensor.c: 0 humidity integer, 1 humidity
+ *  tenths, 2 temperature integer, 3 temperature tenths with the sign in
+ *  bit 7, 4 the 8-bit sum of registers 0..3. The first byte written sets
+ *  the register pointer, reads continue from there. The registers take a
+ *  new measurement when read, at most once per DHT12_UPDATE_MS.
+ *
+ *  The measurements and faults come from a script, one event per line,
+ *  times in milliseconds of virtual time and ascending:
+ *  @code
+ *  # ms     what
+ *  0        21.5 40      temperature in degree C, relative humidity in %
+ *  30000    nack 3       next 3 transfers: address not acknowledged
+ *  40000    checksum 2   next 2 reads: register 4 wrong
+ *  50000    stuck 500    SDA held low for 500 ms
+ *  60000    28.0 55      linear from the previous point, held after the last
+ *  @endcode
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief TWI address, see DHT12 in inc/sensor.h.
+ */
+#define DHT12_ADDRESS 0x5c
+
+/**
+ *  @brief Registers of the part.
+ */
+#define DHT12_REGISTERS 5
+
+/**
+ *  @brief Shortest time between two measurements in milliseconds.
+ */
+#define DHT12_UPDATE_MS 2000
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Load the script and connect the sensor to the TWI bus.
+ *  @param path - Script file
+ *  @return 0, 1 if the script cannot be read, error printed to stderr
+ */
+uint8_t dht12_init(const char *path);
+
+/**
+ *  @brief Print the transfers and the injected faults to stderr.
+ */
+void dht12_report(void);
+
+#endif /* DHT12_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,263 @@
+/**
+  ******************************************************************************
+  * @file    frames.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   What the simulated cube shows, integrated per refresh and sent as
+  *          COBS framed grey scale packets of the UART frame stream.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include "settings.h"
+#include "cube.h"
+#include "crc.h"
+#include "stream.h"
+#include "sim.h"
+#include "sr595.h"
+#include "frames.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define FRAMES_LEDS (CUBE_LAYERS * CUBE_COLOURS * CUBE_COLUMNS)
+#define FRAMES_LED(layer, colour, column) \
+    (((layer) * CUBE_COLOURS + (colour)) * CUBE_COLUMNS + (column))
+
+/* Decoded packet and its COBS encoding with delimiter */
+#define FRAMES_PACKET  (STREAM_HEADER + STREAM_GREY_SIZE + STREAM_TRAILER)
+#define FRAMES_ENCODED (FRAMES_PACKET + FRAMES_PACKET / 254 + 2)
+
+/* Bit n for layer n */
+#define FRAMES_LAYERS ((1 << CUBE_LAYERS) - 1)
+
+/* Highest grey level, a whole layer slot */
+#define FRAMES_LEVEL_MAX 15
+
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+/* GND1..GND3 on SR3 bits 5..7, active low, as in src/cube.c */
+# define FRAMES_SR3_LAYER_SHIFT 5
+#else
+/* Columns 0..5 on PB0..PB5, 6..8 on PD5..PD7, GND1..GND3 on PD4..PD2 */
+# define FRAMES_PORTB_COLUMNS 0x3f
+# define FRAMES_PORTD_COLUMN_SHIFT 5
+# define FRAMES_PORTD_GND1 4
+#endif
+
+/* Function prototypes -------------------------------------------------------*/
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+static void frames_latch(uint32_t outputs, uint64_t cycles);
+#else
+static void frames_pins(uint8_t port, uint8_t old, uint8_t levels);
+#endif
+static void frames_show(uint16_t columns[CUBE_COLOURS], uint8_t layers,
+                        uint64_t cycles);
+static void frames_send(uint64_t cycles);
+static size_t frames_cobs(const uint8_t *data, size_t length, uint8_t *out);
+
+/* Global variables ----------------------------------------------------------*/
+static FILE *frames_file = NULL;
+
+/* On-time of every LED since the refresh began */
+static uint64_t frames_on[FRAMES_LEDS];
+static uint8_t frames_lit[FRAMES_LEDS];
+static uint64_t frames_last = 0;
+
+/* Start of the refresh, 0 before the first one, and whether a layer other
+ * than GND1 has been connected since */
+static uint64_t frames_begin = 0;
+static uint8_t frames_other = 0;
+static uint8_t frames_layers = 0;
+
+static uint8_t frames_sequence = 0;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Open the output and listen to the cube pins.
+  */
+uint8_t frames_init(const char *path)
+{
+    frames_file = fopen(path, "wb");
+    if (frames_file == NULL) {
+        perror(path);
+        return 1;
+    }
+    /* A viewer that quits stops the frames, not the simulation */
+    signal(SIGPIPE, SIG_IGN);
+
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+    if (sr595_init() || sr595_on_latch(frames_latch)) {
+        fprintf(stderr, "frames: no listener free\n");
+        return 1;
+    }
+#else
+    if (sim_on_pins(frames_pins)) {
+        fprintf(stderr, "frames: no listener free\n");
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+/**
+  * @brief Close the output, the refresh in progress is not sent.
+  */
+void frames_close(void)
+{
+    if (frames_file != NULL) {
+        fclose(frames_file);
+        frames_file = NULL;
+    }
+}
+
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+/**
+  * @brief Latch listener: columns and layers of the chain outputs.
+  */
+static void frames_latch(uint32_t outputs, uint64_t cycles)
+{
+    uint8_t sr1 = (uint8_t)outputs;
+    uint8_t sr2 = (uint8_t)(outputs >> 8);
+    uint8_t sr3 = (uint8_t)(outputs >> 16);
+    uint16_t columns[CUBE_COLOURS];
+
+    columns[CUBE_RED] = sr1 | ((uint16_t)(sr2 & 0x01) << 8);
+    columns[CUBE_GREEN] = (sr2 >> 1) | ((uint16_t)(sr3 & 0x03) << 7);
+    frames_show(columns, (uint8_t)(~sr3 >> FRAMES_SR3_LAYER_SHIFT) &
+                FRAMES_LAYERS, cycles);
+}
+#else
+/**
+  * @brief Pin listener: columns and layers of ports B and D.
+  */
+static void frames_pins(uint8_t port, uint8_t old, uint8_t levels)
+{
+    uint8_t portb = sim_pins(SIM_PORTB), portd = sim_pins(SIM_PORTD);
+    uint16_t columns[CUBE_COLOURS];
+    uint8_t layers = 0, layer;
+
+    (void)old;
+    (void)levels;
+    if (port == SIM_PORTC) {
+        return;
+    }
+    columns[CUBE_RED] = (portb & FRAMES_PORTB_COLUMNS) |
+                        ((uint16_t)(portd >> FRAMES_PORTD_COLUMN_SHIFT) << 6);
+    columns[CUBE_GREEN] = 0;
+    for (layer = 0; layer < CUBE_LAYERS; layer++) {
+        if (!(portd & (1 << (FRAMES_PORTD_GND1 - layer)))) {
+            layers |= 1 << layer;
+        }
+    }
+    frames_show(columns, layers, sim_cycles());
+}
+#endif
+
+/**
+  * @brief New outputs: add the time since the last change to the lit LEDs,
+  *        end the refresh when GND1 comes back, then take the new state.
+  * @param layers - Bit n set while layer n is connected
+  */
+static void frames_show(uint16_t columns[CUBE_COLOURS], uint8_t layers,
+                        uint64_t cycles)
+{
+    uint8_t layer, colour, column, i;
+
+    for (i = 0; i < FRAMES_LEDS; i++) {
+        if (frames_lit[i]) {
+            frames_on[i] += cycles - frames_last;
+        }
+    }
+    frames_last = cycles;
+
+    if ((layers & 0x01) && !(frames_layers & 0x01)) {
+        if (frames_begin && frames_other) {
+            frames_send(cycles);
+        }
+        if (!frames_begin || frames_other) {
+            memset(frames_on, 0, sizeof(frames_on));
+            frames_begin = cycles;
+            frames_other = 0;
+        }
+    }
+    if (layers & ~0x01) {
+        frames_other = 1;
+    }
+    frames_layers = layers;
+
+    for (layer = 0; layer < CUBE_LAYERS; layer++) {
+        for (colour = 0; colour < CUBE_COLOURS; colour++) {
+            for (column = 0; column < CUBE_COLUMNS; column++) {
+                frames_lit[FRAMES_LED(layer, colour, column)] =
+                    (layers & (1 << layer)) &&
+                    (columns[colour] & (1 << column));
+            }
+        }
+    }
+}
+
+/**
+  * @brief Send the refresh that ends now as a grey scale packet.
+  */
+static void frames_send(uint64_t cycles)
+{
+    uint8_t packet[FRAMES_PACKET], encoded[FRAMES_ENCODED];
+    uint8_t *data = &packet[STREAM_HEADER];
+    uint64_t refresh = cycles - frames_begin, level;
+    size_t length;
+    uint8_t i;
+
+    if (frames_file == NULL) {
+        return;
+    }
+    packet[0] = frames_sequence++;
+    packet[1] = STREAM_GREY;
+    memset(data, 0, STREAM_GREY_SIZE);
+    for (i = 0; i < FRAMES_LEDS; i++) {
+        /* A layer slot is a CUBE_LAYERS-th of the refresh */
+        level = (frames_on[i] * CUBE_LAYERS * FRAMES_LEVEL_MAX + refresh / 2) /
+                refresh;
+        if (level > FRAMES_LEVEL_MAX) {
+            level = FRAMES_LEVEL_MAX;
+        }
+        data[i >> 1] |= (uint8_t)level << ((i & 1) * 4);
+    }
+    length = STREAM_HEADER + STREAM_GREY_SIZE;
+    packet[length] = crc8_block(CRC8_INIT, packet, length);
+    length = frames_cobs(packet, length + STREAM_TRAILER, encoded);
+
+    /* Unbuffered in effect, the viewer follows the virtual time */
+    if (fwrite(encoded, 1, length, frames_file) != length ||
+        fflush(frames_file) != 0) {
+        perror("frames");
+        frames_close();
+    }
+}
+
+/**
+  * @brief COBS encode a packet and append the 0x00 delimiter.
+  * @return Encoded length
+  */
+static size_t frames_cobs(const uint8_t *data, size_t length, uint8_t *out)
+{
+    size_t code_index = 0, n = 1, i;
+    uint8_t code = 1;
+
+    for (i = 0; i < length; i++) {
+        if (data[i] != 0) {
+            out[n++] = data[i];
+            code++;
+        }
+        if (data[i] == 0 || code == 0xff) {
+            out[code_index] = code;
+            code_index = n++;
+            code = 1;
+        }
+    }
+    out[code_index] = code;
+    out[n++] = 0;
+    return n;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,47 @@
+#ifndef FRAMES_H_INCLUDED
+#define FRAMES_H_INCLUDED
+
+/**
+ *  @file frames.h
+ *  @code #include "frames.h" @endcode
+ *
+ *  @brief What the simulated cube shows, one packet per refresh in the
+ *         format of the UART frame stream (inc/stream.h), for
+ *         host/cubeview.c.
+ *
+ *  An LED is lit while its column drives high and its layer is connected:
+ *     - CUBE_DRIVER_DIRECT: columns on PB0..PB5 and PD5..PD7, GND1..GND3 on
+ *       PD4, PD3, PD2 (active low). The single colour cube is sent as the
+ *       red plane.
+ *     - CUBE_DRIVER_SR595: the 74HC595 outputs of sr595.h, as pov.h reads
+ *       them.
+ *
+ *  A refresh ends when GND1 is connected again after another layer. The
+ *  on-time of every LED in it becomes a STREAM_GREY level, 15 for a whole
+ *  layer slot, so dimming and bit angle modulation show as they are seen.
+ *  The outputs are dark while the chain shifts, full brightness comes out
+ *  as 14 with CUBE_DRIVER_SR595.
+ *  Packets carry their own sequence number and are written as the refresh
+ *  ends, 333 per second of virtual time at the default rate.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Open the output, e.g. a named pipe cubeview reads, and follow the
+ *         cube.
+ *  @param path - Output file
+ *  @return 0, 1 on error, printed to stderr
+ */
+uint8_t frames_init(const char *path);
+
+/**
+ *  @brief Close the output.
+ */
+void frames_close(void);
+
+#endif /* FRAMES_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
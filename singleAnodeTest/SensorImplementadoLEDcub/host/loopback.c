@@ -0,0 +1,118 @@
+/**
+  ******************************************************************************
+  * @file    loopback.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Sustained throughput of the UART ring buffers of src/uart.c,
+  *          run instead of the firmware on the simulator with TXD wired to
+  *          RXD.
+  *
+  *          loopback -L [-f]
+  *
+  *          At every rate of the high-speed profile a counting pattern is
+  *          kept queued with uart_write() and read back with uart_getc() for
+  *          LOOPBACK_WINDOW_MS of virtual time. Bytes per second are
+  *          compared with the line rate of the UBRR setting, a byte lost to
+  *          an overrun or a full ring fails the test.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "settings.h"
+#include "hal.h"
+#include "uart.h"
+#include "sim.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Virtual time measured at each rate */
+#define LOOPBACK_WINDOW_MS 200
+
+/* Time without a byte that ends a rate, CPU cycles */
+#define LOOPBACK_QUIET (F_CPU / 1000)
+
+/* Lowest share of the line rate in per mille that passes */
+#define LOOPBACK_RATE_MIN 990
+
+/* Function prototypes -------------------------------------------------------*/
+int sim_firmware_main(void);
+static uint8_t loopback_run(uint32_t baud);
+
+/* Global variables ----------------------------------------------------------*/
+static const uint32_t loopback_bauds[] = {115200, 250000, 500000, 1000000};
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Loopback test in place of the firmware main().
+  */
+int sim_firmware_main(void)
+{
+    uint8_t i, failed = 0;
+
+    sei();
+    printf("baud     line B/s  loop B/s  share  lost  errors\n");
+    for (i = 0; i < sizeof(loopback_bauds) / sizeof(loopback_bauds[0]); i++) {
+        failed |= loopback_run(loopback_bauds[i]);
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+  * @brief Keep the transmit ring full for a window and check what comes back.
+  * @return 0, 1 if bytes were lost or the rate fell short
+  */
+static uint8_t loopback_run(uint32_t baud)
+{
+    uint16_t ubrr = UART_BAUD_SELECT_AUTO(baud, F_CPU);
+    uint32_t line = F_CPU / ((ubrr & 0x8000 ? 8UL : 16UL) *
+                             ((ubrr & 0x0fff) + 1UL) * 10UL);
+    uint32_t received = 0, lost = 0, errors = 0, rate, share;
+    uint8_t buffer[UART_TX_BUFFER_SIZE];
+    uint8_t next_tx = 0, next_rx = 0;
+    uint64_t start, end;
+    unsigned int c, n, i;
+
+    uart_init(ubrr);
+    start = sim_cycles();
+    end = start + LOOPBACK_WINDOW_MS * (F_CPU / 1000);
+    while (sim_cycles() < end) {
+        n = uart_tx_free();
+        for (i = 0; i < n; i++) {
+            buffer[i] = next_tx++;
+        }
+        uart_write(buffer, n);
+
+        while (!((c = uart_getc()) & UART_NO_DATA)) {
+            if (c & (UART_FRAME_ERROR | UART_OVERRUN_ERROR |
+                     UART_BUFFER_OVERFLOW)) {
+                errors++;
+            }
+            lost += (uint8_t)((uint8_t)c - next_rx);
+            next_rx = (uint8_t)c + 1;
+            received++;
+        }
+        HAL_WAIT();
+    }
+
+    /* One frame time of latency is part of the window */
+    rate = (uint32_t)((uint64_t)received * F_CPU / (end - start));
+    share = (uint32_t)((uint64_t)rate * 1000 / line);
+    printf("%-8lu %-9lu %-9lu %3lu.%lu%% %-5lu %lu\n", (unsigned long)baud,
+           (unsigned long)line, (unsigned long)rate,
+           (unsigned long)(share / 10), (unsigned long)(share % 10),
+           (unsigned long)lost, (unsigned long)errors);
+
+    /* Read back the rest until the wire is quiet, an overflow of the
+     * receive ring would carry over to the next rate */
+    end = sim_cycles() + LOOPBACK_QUIET;
+    while (sim_cycles() < end) {
+        if (!(uart_getc() & UART_NO_DATA)) {
+            end = sim_cycles() + LOOPBACK_QUIET;
+        }
+        HAL_WAIT();
+    }
+    return lost != 0 || errors != 0 || share < LOOPBACK_RATE_MIN;
+}
+
+/* END OF FILE ****************************************************************/
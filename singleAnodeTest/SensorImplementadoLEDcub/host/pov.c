@@ -0,0 +1,257 @@
+/**
+  ******************************************************************************
+  * @file    pov.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Persistence of vision: per LED on-time, window spread, flicker
+  *          frequency and ghosting from the simulated 74HC595 outputs.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "settings.h"
+#include "cube.h"
+#include "sim.h"
+#include "sr595.h"
+#include "pov.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define POV_LEDS (CUBE_LAYERS * CUBE_COLOURS * CUBE_COLUMNS)
+#define POV_LED(layer, colour, column) \
+    (((layer) * CUBE_COLOURS + (colour)) * CUBE_COLUMNS + (column))
+
+#define POV_WINDOW_CYCLES ((uint64_t)POV_WINDOW_MS * (F_CPU / 1000))
+#define POV_DARK_CYCLES   ((uint64_t)POV_DARK_MS * (F_CPU / 1000))
+#define POV_GHOST_CYCLES  ((uint64_t)POV_GHOST_US * (F_CPU / 1000000))
+
+/* GND1..GND3 on SR3 bits 5..7, active low, as in src/cube.c */
+#define POV_SR3_LAYER_SHIFT 5
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    /* On-time, in the current window, with more than one layer connected */
+    uint64_t on;
+    uint64_t window;
+    uint64_t ghost;
+    /* Last rising edge and longest rise to rise time below POV_DARK_MS */
+    uint64_t rose;
+    uint64_t gap;
+    uint32_t pulses;
+    uint32_t short_pulses;
+    /* Duty of the darkest and brightest window */
+    double min;
+    double max;
+    uint8_t lit;
+} pov_led_t;
+
+/* Function prototypes -------------------------------------------------------*/
+static void pov_latch(uint32_t outputs, uint64_t cycles);
+static void pov_advance(uint64_t now);
+static void pov_window(void);
+static void pov_name(uint8_t led, char *name, size_t size);
+
+/* Global variables ----------------------------------------------------------*/
+static pov_led_t pov_leds[POV_LEDS];
+static uint8_t pov_layers = 0;
+static uint64_t pov_last = 0;
+static uint64_t pov_window_end = POV_WINDOW_CYCLES;
+static uint32_t pov_windows = 0;
+static uint32_t pov_changes = 0;
+
+static const char *const pov_colours[CUBE_COLOURS] = {"red", "green"};
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Listen to the 74HC595 model.
+  */
+uint8_t pov_init(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < POV_LEDS; i++) {
+        pov_leds[i].min = 1.0;
+    }
+    if (sr595_init()) {
+        return 1;
+    }
+    return sr595_on_latch(pov_latch);
+}
+
+/**
+  * @brief Brightness, flicker and ghosting of the run.
+  */
+void pov_report(void)
+{
+    uint64_t now = sim_cycles(), gap = 0, on = 0, ghost = 0;
+    uint32_t short_pulses = 0;
+    uint8_t layer, colour, row, column, i, gap_led = 0, spread_led = 0;
+    double spread = 0.0;
+    char name[32];
+
+    pov_advance(now);
+    if (now == 0) {
+        return;
+    }
+
+    fprintf(stderr, "pov: %.1f ms, %u windows of %u ms, %u output changes\n",
+            now * 1e3 / F_CPU, pov_windows, POV_WINDOW_MS, pov_changes);
+    fprintf(stderr, "pov: on-time in %% of the run, GND1..GND3 side by side, "
+            "columns 1..9 in rows of 3\n");
+    for (colour = 0; colour < CUBE_COLOURS; colour++) {
+        fprintf(stderr, "%s\n", pov_colours[colour]);
+        for (row = 0; row < 3; row++) {
+            for (layer = 0; layer < CUBE_LAYERS; layer++) {
+                fprintf(stderr, "   ");
+                for (column = 3 * row; column < 3 * row + 3; column++) {
+                    fprintf(stderr, " %5.1f", 100.0 *
+                            pov_leds[POV_LED(layer, colour, column)].on / now);
+                }
+            }
+            fprintf(stderr, "\n");
+        }
+    }
+
+    for (i = 0; i < POV_LEDS; i++) {
+        on += pov_leds[i].on;
+        ghost += pov_leds[i].ghost;
+        short_pulses += pov_leds[i].short_pulses;
+        if (pov_leds[i].gap > gap) {
+            gap = pov_leds[i].gap;
+            gap_led = i;
+        }
+        if (pov_windows && pov_leds[i].on &&
+            pov_leds[i].max - pov_leds[i].min > spread) {
+            spread = pov_leds[i].max - pov_leds[i].min;
+            spread_led = i;
+        }
+    }
+
+    if (spread > 0.0) {
+        pov_name(spread_led, name, sizeof(name));
+        fprintf(stderr, "pov: window spread up to %.1f %% (%s), a still "
+                "image shows one layer slot at most\n", 100.0 * spread, name);
+    }
+    if (gap) {
+        pov_name(gap_led, name, sizeof(name));
+        fprintf(stderr, "pov: flicker %.0f Hz worst case (%s)%s\n",
+                (double)F_CPU / gap, name,
+                (double)F_CPU / gap < POV_FUSION_HZ ? ", VISIBLE" : "");
+    }
+    else {
+        fprintf(stderr, "pov: no LED pulsed twice\n");
+    }
+    fprintf(stderr, "pov: ghosting %.2f %% of the light with layers "
+            "overlapping, %u pulses under %u us\n",
+            on ? 100.0 * ghost / on : 0.0, short_pulses, POV_GHOST_US);
+}
+
+/**
+  * @brief New outputs: integrate the old ones, then follow the edges.
+  */
+static void pov_latch(uint32_t outputs, uint64_t cycles)
+{
+    uint8_t sr1 = (uint8_t)outputs;
+    uint8_t sr2 = (uint8_t)(outputs >> 8);
+    uint8_t sr3 = (uint8_t)(outputs >> 16);
+    uint16_t columns[CUBE_COLOURS];
+    uint8_t layer, colour, column, lit;
+    pov_led_t *led;
+
+    pov_advance(cycles);
+    pov_changes++;
+
+    columns[CUBE_RED] = sr1 | ((uint16_t)(sr2 & 0x01) << 8);
+    columns[CUBE_GREEN] = (sr2 >> 1) | ((uint16_t)(sr3 & 0x03) << 7);
+    pov_layers = 0;
+    for (layer = 0; layer < CUBE_LAYERS; layer++) {
+        if (!(sr3 & (1 << (POV_SR3_LAYER_SHIFT + layer)))) {
+            pov_layers++;
+        }
+    }
+
+    for (layer = 0; layer < CUBE_LAYERS; layer++) {
+        for (colour = 0; colour < CUBE_COLOURS; colour++) {
+            for (column = 0; column < CUBE_COLUMNS; column++) {
+                led = &pov_leds[POV_LED(layer, colour, column)];
+                lit = !(sr3 & (1 << (POV_SR3_LAYER_SHIFT + layer))) &&
+                      (columns[colour] & (1 << column));
+                if (lit && !led->lit) {
+                    if (led->pulses && cycles - led->rose < POV_DARK_CYCLES &&
+                        cycles - led->rose > led->gap) {
+                        led->gap = cycles - led->rose;
+                    }
+                    led->rose = cycles;
+                    led->pulses++;
+                }
+                else if (!lit && led->lit &&
+                         cycles - led->rose <= POV_GHOST_CYCLES) {
+                    led->short_pulses++;
+                }
+                led->lit = lit;
+            }
+        }
+    }
+}
+
+/**
+  * @brief Add the time since the last change to the lit LEDs, window by
+  *        window.
+  */
+static void pov_advance(uint64_t now)
+{
+    uint64_t end, time;
+    uint8_t i;
+
+    while (pov_last < now) {
+        end = now < pov_window_end ? now : pov_window_end;
+        time = end - pov_last;
+        for (i = 0; i < POV_LEDS; i++) {
+            if (pov_leds[i].lit) {
+                pov_leds[i].on += time;
+                pov_leds[i].window += time;
+                if (pov_layers > 1) {
+                    pov_leds[i].ghost += time;
+                }
+            }
+        }
+        pov_last = end;
+        if (end == pov_window_end) {
+            pov_window();
+            pov_window_end += POV_WINDOW_CYCLES;
+        }
+    }
+}
+
+/**
+  * @brief Close a window: darkest and brightest duty of every LED.
+  */
+static void pov_window(void)
+{
+    double duty;
+    uint8_t i;
+
+    for (i = 0; i < POV_LEDS; i++) {
+        duty = (double)pov_leds[i].window / POV_WINDOW_CYCLES;
+        if (duty < pov_leds[i].min) {
+            pov_leds[i].min = duty;
+        }
+        if (duty > pov_leds[i].max) {
+            pov_leds[i].max = duty;
+        }
+        pov_leds[i].window = 0;
+    }
+    pov_windows++;
+}
+
+/**
+  * @brief Layer, column and colour of an LED for the report.
+  */
+static void pov_name(uint8_t led, char *name, size_t size)
+{
+    snprintf(name, size, "GND%u column %u %s",
+             led / (CUBE_COLOURS * CUBE_COLUMNS) + 1, led % CUBE_COLUMNS + 1,
+             pov_colours[led / CUBE_COLUMNS % CUBE_COLOURS]);
+}
+
+/* END OF FILE ****************************************************************/
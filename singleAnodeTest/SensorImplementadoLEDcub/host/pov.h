@@ -0,0 +1,67 @@
+#ifndef POV_H_INCLUDED
+#define POV_H_INCLUDED
+
+/**
+ *  @file pov.h
+ *  @code #include "pov.h" @endcode
+ *
+ *  @brief What the eye sees of the simulated cube: on-time of every LED
+ *         integrated from the 74HC595 outputs of sr595.h.
+ *
+ *  An LED is lit while its column output is high and its layer GND output
+ *  is low (SR1: R8..R1, SR2: G7..G1 R9, SR3: GND3..GND1 x x x G9 G8, see
+ *  cube_output() in src/cube.c). At the end of the run pov_report() prints:
+ *     - Brightness: on-time in % of the run per voxel and colour, and the
+ *       spread of the POV_WINDOW_MS windows, which the eye integrates. With
+ *       a still image a window holds one layer slot more or less than the
+ *       next, more spread is beating between refresh and animation.
+ *     - Flicker: the lowest pulse frequency of any LED while it is lit, the
+ *       longest time between two of its pulses that is shorter than
+ *       POV_DARK_MS. Below POV_FUSION_HZ the cube flickers visibly.
+ *     - Ghosting: light while more than one layer is connected, and pulses
+ *       shorter than POV_GHOST_US, which show as faint ghost images.
+ *
+ *  The model sees the outputs only, brightness is duty cycle rather than
+ *  luminance of the particular LEDs.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Integration window of the eye in milliseconds.
+ */
+#define POV_WINDOW_MS 20
+
+/**
+ *  @brief Gaps longer than this are the animation turning an LED off, not
+ *         flicker.
+ */
+#define POV_DARK_MS 100
+
+/**
+ *  @brief Flicker fusion frequency used for the warning.
+ */
+#define POV_FUSION_HZ 100
+
+/**
+ *  @brief Pulses up to this length in microseconds count as ghosts.
+ */
+#define POV_GHOST_US 20
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Start integrating the outputs of the 74HC595 model.
+ *  @return 0, 1 if no listener is free
+ */
+uint8_t pov_init(void);
+
+/**
+ *  @brief Integrate up to now and print the report to stderr.
+ */
+void pov_report(void);
+
+#endif /* POV_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
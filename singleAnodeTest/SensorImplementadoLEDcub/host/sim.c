@@ -0,0 +1,953 @@
+/**
+  ******************************************************************************
+  * @file    sim.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Firmware as a Linux program: the virtual ATmega328P of sim.h
+  *          behind hal_host, and the command line of the simulator.
+  *
+  *          sim [-p port | -t | -L] [-d ms] [-f] [-s] [-P] [-D script]
+  *              [-V vcd] [-F frames]
+  *             -p  serial port or pseudo terminal for USART0, e.g. the one
+  *                 printed by streamer -t; stdin and stdout otherwise
+  *             -t  create a pseudo terminal for USART0 and print its name
+  *             -L  loopback plug, TXD wired to RXD
+  *             -d  stop after ms milliseconds of virtual time
+  *             -f  run as fast as possible, in real time otherwise
+  *             -s  model the 74HC595 chain of CUBE_DRIVER_SR595 (sr595.h)
+  *                 and report on its protocol at the end
+  *             -P  report what the eye sees of the chain outputs (pov.h)
+  *             -D  DHT12 on the TWI bus playing the script (dht12.h)
+  *             -V  dump the pins, TWI and TXD into a VCD file (vcd.h)
+  *             -F  write what the cube shows to a file or named pipe,
+  *                 e.g. for build/cubeview (frames.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "cube.h"
+#include "sim.h"
+#include "sr595.h"
+#include "pov.h"
+#include "dht12.h"
+#include "vcd.h"
+#include "frames.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Longest step of a delay, interrupts are checked after each */
+#define SIM_STEP_CYCLES 16
+
+/* Output flush and real time check, once per virtual millisecond */
+#define SIM_PACE_CYCLES (F_CPU / 1000)
+
+#define SIM_TWI_DEVICES 8
+#define SIM_OUT_SIZE    256
+
+/* TWI status codes, see src/twi.c */
+#define SIM_TW_START        0x08
+#define SIM_TW_REP_START    0x10
+#define SIM_TW_MT_SLA_ACK   0x18
+#define SIM_TW_MT_SLA_NACK  0x20
+#define SIM_TW_MT_DATA_ACK  0x28
+#define SIM_TW_MT_DATA_NACK 0x30
+#define SIM_TW_MR_SLA_ACK   0x40
+#define SIM_TW_MR_SLA_NACK  0x48
+#define SIM_TW_MR_DATA_ACK  0x50
+#define SIM_TW_MR_DATA_NACK 0x58
+
+/* Types ---------------------------------------------------------------------*/
+/* Timer/Counter0 or Timer/Counter2, both 8-bit with the same bit layout */
+typedef struct {
+    uint8_t tccra, tccrb, tcnt, ocra, ocrb, tifr, timsk;
+    const uint16_t *prescaler;
+    uint64_t next;
+} sim_timer_t;
+
+typedef enum {
+    SIM_TWI_IDLE,
+    SIM_TWI_START,
+    SIM_TWI_TRANSMIT,
+    SIM_TWI_RECEIVE
+} sim_twi_phase_t;
+
+typedef struct {
+    const char *name;
+    void (*handler)(void);
+} sim_vector_t;
+
+/* Function prototypes -------------------------------------------------------*/
+int sim_firmware_main(void);
+
+/* Handlers of the firmware, missing ones are NULL */
+void TIMER2_COMPA_vect(void) __attribute__((weak));
+void TIMER2_COMPB_vect(void) __attribute__((weak));
+void TIMER2_OVF_vect(void) __attribute__((weak));
+void TIMER0_COMPA_vect(void) __attribute__((weak));
+void TIMER0_COMPB_vect(void) __attribute__((weak));
+void TIMER0_OVF_vect(void) __attribute__((weak));
+void USART_RX_vect(void) __attribute__((weak));
+void USART_UDRE_vect(void) __attribute__((weak));
+void TWI_vect(void) __attribute__((weak));
+
+static uint8_t sim_read(uint8_t reg);
+static void sim_write(uint8_t reg, uint8_t value);
+static void sim_modify(uint8_t reg, uint8_t clear, uint8_t set);
+static void sim_delay(uint32_t cycles);
+static void sim_step(uint32_t cycles);
+static uint8_t sim_peek(uint8_t reg);
+static void sim_store(uint8_t reg, uint8_t value);
+static void sim_port(uint8_t reg, uint8_t value);
+static void sim_timer_run(sim_timer_t *timer);
+static uint32_t sim_uart_char(void);
+static void sim_uart_send(uint8_t data, uint64_t start);
+static void sim_uart_run(void);
+static void sim_uart_put(uint8_t data);
+static void sim_twi_control(uint8_t value);
+static void sim_bus(uint8_t event, uint64_t start, uint16_t data,
+                    uint32_t bit_cycles);
+static void sim_twi_run(void);
+static void sim_interrupts(void);
+static const sim_vector_t *sim_pending(void);
+static void sim_pace(void);
+static void sim_flush(void);
+static int open_port(const char *path);
+static int open_pty(void);
+
+/* Global variables ----------------------------------------------------------*/
+static const hal_host_t sim_hal = {
+    sim_read, sim_write, sim_modify, sim_delay
+};
+const hal_host_t *hal_host = &sim_hal;
+
+/* Register file, data space addresses */
+static uint8_t sim_reg[256];
+static uint64_t sim_now = 0;
+static uint64_t sim_end = 0;
+static uint64_t sim_next_pace = SIM_PACE_CYCLES;
+static uint8_t sim_realtime = 1;
+static struct timespec sim_start;
+
+static sim_pins_t sim_pin_listeners[SIM_LISTENERS];
+static sim_bus_t sim_bus_listeners[SIM_LISTENERS];
+
+static const uint16_t sim_prescaler0[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+static const uint16_t sim_prescaler2[8] = {0, 1, 8, 32, 64, 128, 256, 1024};
+static sim_timer_t sim_timer0 = {
+    TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIFR0, TIMSK0, sim_prescaler0, 0};
+static sim_timer_t sim_timer2 = {
+    TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIFR2, TIMSK2, sim_prescaler2, 0};
+
+/* USART0: transmit shift register busy until sim_tx_end, one byte may wait
+ * in UDR0 */
+static int sim_in = STDIN_FILENO;
+static int sim_out = STDOUT_FILENO;
+static uint64_t sim_tx_end = 0;
+static int sim_tx_pending = -1;
+static uint64_t sim_rx_next = 0;
+static uint8_t sim_rx_full = 0;
+static uint8_t sim_rx_eof = 0;
+static uint8_t sim_rx_overrun = 0;
+static uint8_t sim_out_buffer[SIM_OUT_SIZE];
+static size_t sim_out_length = 0;
+
+/* Loopback plug: the byte on the wire reaches RXD at sim_wire_end */
+static uint8_t sim_loopback = 0;
+static int sim_wire = -1;
+static uint64_t sim_wire_end = 0;
+
+/* TWI master */
+static const sim_twi_device_t *sim_twi_devices[SIM_TWI_DEVICES];
+static const sim_twi_device_t *sim_twi_slave = NULL;
+static sim_twi_phase_t sim_twi_phase = SIM_TWI_IDLE;
+static uint8_t sim_twi_owner = 0;
+static uint64_t sim_twi_done = 0;
+static uint8_t sim_twi_status;
+static uint8_t sim_twi_data;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Main function.
+  */
+int main(int argc, char *argv[])
+{
+    const char *port = NULL, *script = NULL, *vcd = NULL;
+    const char *frames = NULL;
+    int pty = 0, chain = 0, pov = 0, opt;
+    long ms = 0;
+
+    while ((opt = getopt(argc, argv, "p:tLd:fsPD:V:F:")) != -1) {
+        switch (opt) {
+        case 'p':
+            port = optarg;
+            break;
+        case 't':
+            pty = 1;
+            break;
+        case 'L':
+            sim_loopback = 1;
+            break;
+        case 'd':
+            ms = strtol(optarg, NULL, 10);
+            break;
+        case 'f':
+            sim_realtime = 0;
+            break;
+        case 's':
+            chain = 1;
+            break;
+        case 'P':
+            pov = 1;
+            break;
+        case 'D':
+            script = optarg;
+            break;
+        case 'V':
+            vcd = optarg;
+            break;
+        case 'F':
+            frames = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p port | -t | -L] [-d ms] [-f] [-s] "
+                    "[-P] [-D script] [-V vcd] [-F frames]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((port != NULL) + pty + sim_loopback > 1) {
+        fprintf(stderr, "%s: give one of -p port, -t and -L\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if ((chain || pov) && CUBE_DRIVER != CUBE_DRIVER_SR595) {
+        fprintf(stderr, "%s: -s and -P need a build with CUBE_DRIVER=1\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (pty) {
+        sim_in = sim_out = open_pty();
+    }
+    else if (port != NULL) {
+        sim_in = sim_out = open_port(port);
+    }
+    if (sim_in < 0) {
+        return EXIT_FAILURE;
+    }
+    if (ms > 0) {
+        sim_end = (uint64_t)ms * (F_CPU / 1000);
+    }
+
+    /* Registers that do not reset to 0 */
+    sim_reg[UCSR0C] = _BV(UCSZ01) | _BV(UCSZ00);
+    sim_reg[TWSR] = 0xf8;
+    sim_reg[TWDR] = 0xff;
+
+    if (chain) {
+        sr595_init();
+        atexit(sr595_report);
+    }
+    if (pov) {
+        pov_init();
+        atexit(pov_report);
+    }
+    if (script != NULL) {
+        if (dht12_init(script)) {
+            return EXIT_FAILURE;
+        }
+        atexit(dht12_report);
+    }
+    if (vcd != NULL) {
+        if (vcd_init(vcd)) {
+            return EXIT_FAILURE;
+        }
+        atexit(vcd_close);
+    }
+    if (frames != NULL) {
+        if (frames_init(frames)) {
+            return EXIT_FAILURE;
+        }
+        atexit(frames_close);
+    }
+    atexit(sim_flush);
+    clock_gettime(CLOCK_MONOTONIC, &sim_start);
+    return sim_firmware_main();
+}
+
+/**
+  * @brief Virtual time in CPU cycles.
+  */
+uint64_t sim_cycles(void)
+{
+    return sim_now;
+}
+
+/**
+  * @brief Levels of a port.
+  */
+uint8_t sim_pins(uint8_t port)
+{
+    return sim_reg[PORTB + 3 * port];
+}
+
+/**
+  * @brief Register a pin listener.
+  */
+uint8_t sim_on_pins(sim_pins_t listener)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_LISTENERS; i++) {
+        if (sim_pin_listeners[i] == NULL) {
+            sim_pin_listeners[i] = listener;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+  * @brief Register a bus listener.
+  */
+uint8_t sim_on_bus(sim_bus_t listener)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_LISTENERS; i++) {
+        if (sim_bus_listeners[i] == NULL) {
+            sim_bus_listeners[i] = listener;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+  * @brief Connect a TWI slave.
+  */
+uint8_t sim_twi_attach(const sim_twi_device_t *device)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_TWI_DEVICES; i++) {
+        if (sim_twi_devices[i] == NULL) {
+            sim_twi_devices[i] = device;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+  * @brief HAL_READ().
+  */
+static uint8_t sim_read(uint8_t reg)
+{
+    uint8_t value;
+
+    sim_step(SIM_ACCESS_CYCLES);
+    value = sim_peek(reg);
+    if (reg == UDR0) {
+        sim_rx_full = 0;
+        sim_rx_overrun = 0;
+    }
+    return value;
+}
+
+/**
+  * @brief HAL_WRITE().
+  */
+static void sim_write(uint8_t reg, uint8_t value)
+{
+    sim_step(SIM_ACCESS_CYCLES);
+    sim_store(reg, value);
+}
+
+/**
+  * @brief HAL_SET() and HAL_CLEAR(), one access like sbi and cbi.
+  */
+static void sim_modify(uint8_t reg, uint8_t clear, uint8_t set)
+{
+    sim_step(SIM_ACCESS_CYCLES);
+    sim_store(reg, (sim_peek(reg) & ~clear) | set);
+}
+
+/**
+  * @brief _delay_us(), _delay_ms() and HAL_WAIT().
+  */
+static void sim_delay(uint32_t cycles)
+{
+    while (cycles > SIM_STEP_CYCLES) {
+        sim_step(SIM_STEP_CYCLES);
+        cycles -= SIM_STEP_CYCLES;
+    }
+    sim_step(cycles);
+}
+
+/**
+  * @brief Advance the virtual clock, let the peripherals catch up and run
+  *        the interrupts that are due.
+  */
+static void sim_step(uint32_t cycles)
+{
+    sim_now += cycles;
+    sim_timer_run(&sim_timer0);
+    sim_timer_run(&sim_timer2);
+    sim_uart_run();
+    sim_twi_run();
+    if (sim_now >= sim_next_pace) {
+        sim_pace();
+    }
+    sim_interrupts();
+}
+
+/**
+  * @brief Value a register reads, without side effects.
+  */
+static uint8_t sim_peek(uint8_t reg)
+{
+    uint8_t value;
+
+    switch (reg) {
+    case PINB:
+    case PINC:
+    case PIND:
+        /* Outputs and pull-ups, nothing drives the inputs */
+        return sim_reg[reg + 2];
+
+    case UCSR0A:
+        value = sim_reg[UCSR0A] & (_BV(U2X0) | _BV(MPCM0));
+        if (sim_rx_full) {
+            value |= _BV(RXC0);
+        }
+        if (sim_rx_overrun) {
+            value |= _BV(DOR0);
+        }
+        if (sim_tx_pending < 0) {
+            value |= _BV(UDRE0);
+            if (sim_now >= sim_tx_end) {
+                value |= _BV(TXC0);
+            }
+        }
+        return value;
+
+    default:
+        return sim_reg[reg];
+    }
+}
+
+/**
+  * @brief Write a register and start what the write starts.
+  */
+static void sim_store(uint8_t reg, uint8_t value)
+{
+    switch (reg) {
+    case PINB:
+    case PINC:
+    case PIND:
+        /* Writing 1 toggles the output */
+        sim_port(reg + 2, sim_reg[reg + 2] ^ value);
+        break;
+
+    case PORTB:
+    case PORTC:
+    case PORTD:
+        sim_port(reg, value);
+        break;
+
+    case TIFR0:
+    case TIFR2:
+        /* Flags are cleared by writing 1 */
+        sim_reg[reg] &= ~value;
+        break;
+
+    case TCCR0B:
+        sim_reg[reg] = value;
+        sim_timer0.next = sim_now + sim_prescaler0[value & 0x07];
+        break;
+
+    case TCCR2B:
+        sim_reg[reg] = value;
+        sim_timer2.next = sim_now + sim_prescaler2[value & 0x07];
+        break;
+
+    case UCSR0A:
+        sim_reg[reg] = value & (_BV(U2X0) | _BV(MPCM0));
+        break;
+
+    case UDR0:
+        if (sim_tx_pending < 0) {
+            if (sim_now >= sim_tx_end) {
+                sim_uart_send(value, sim_now);
+            }
+            else {
+                sim_tx_pending = value;
+            }
+        }
+        break;
+
+    case TWSR:
+        sim_reg[reg] = (sim_reg[reg] & 0xf8) | (value & (_BV(TWPS1) | _BV(TWPS0)));
+        break;
+
+    case TWCR:
+        sim_twi_control(value);
+        break;
+
+    default:
+        sim_reg[reg] = value;
+        break;
+    }
+}
+
+/**
+  * @brief Write a port register and tell the listeners about the change.
+  */
+static void sim_port(uint8_t reg, uint8_t value)
+{
+    uint8_t old = sim_reg[reg];
+    uint8_t i;
+
+    sim_reg[reg] = value;
+    if (old == value) {
+        return;
+    }
+    for (i = 0; i < SIM_LISTENERS && sim_pin_listeners[i] != NULL; i++) {
+        sim_pin_listeners[i]((reg - PORTB) / 3, old, value);
+    }
+}
+
+/**
+  * @brief Count the timer clocks up to now, normal or CTC mode.
+  */
+static void sim_timer_run(sim_timer_t *timer)
+{
+    uint16_t divider = timer->prescaler[sim_reg[timer->tccrb] & 0x07];
+    uint8_t count;
+
+    if (divider == 0) {
+        return;
+    }
+    while (timer->next <= sim_now) {
+        timer->next += divider;
+        /* Compare flags are set in the timer clock after the match */
+        count = sim_reg[timer->tcnt];
+        if (count == sim_reg[timer->ocra]) {
+            sim_reg[timer->tifr] |= _BV(OCF0A);
+        }
+        if (count == sim_reg[timer->ocrb]) {
+            sim_reg[timer->tifr] |= _BV(OCF0B);
+        }
+        if ((sim_reg[timer->tccra] & _BV(WGM01)) &&
+            count == sim_reg[timer->ocra]) {
+            count = 0;
+        }
+        else if (count == 0xff) {
+            count = 0;
+            sim_reg[timer->tifr] |= _BV(TOV0);
+        }
+        else {
+            count++;
+        }
+        sim_reg[timer->tcnt] = count;
+    }
+}
+
+/**
+  * @brief CPU cycles of one USART frame, 8N1.
+  */
+static uint32_t sim_uart_char(void)
+{
+    uint16_t ubrr = ((sim_reg[UBRR0H] & 0x0f) << 8) | sim_reg[UBRR0L];
+
+    return (sim_reg[UCSR0A] & _BV(U2X0) ? 8UL : 16UL) * (ubrr + 1) * 10;
+}
+
+/**
+  * @brief Move a byte into the transmit shift register.
+  * @param start - Cycle its start bit begins
+  */
+static void sim_uart_send(uint8_t data, uint64_t start)
+{
+    sim_tx_end = start + sim_uart_char();
+    sim_bus(SIM_BUS_TXD, start, data, sim_uart_char() / 10);
+    if (sim_loopback) {
+        sim_wire = data;
+        sim_wire_end = sim_tx_end;
+    }
+    else {
+        sim_uart_put(data);
+    }
+}
+
+/**
+  * @brief Send the waiting byte and receive one byte per frame time.
+  */
+static void sim_uart_run(void)
+{
+    struct pollfd fd = {sim_in, POLLIN, 0};
+    uint8_t data;
+    ssize_t n;
+
+    if (sim_loopback && sim_wire >= 0 && sim_now >= sim_wire_end) {
+        /* The stop bit is in: lost while UDR0 still holds a byte */
+        if (sim_rx_full) {
+            sim_rx_overrun = 1;
+        }
+        else if (sim_reg[UCSR0B] & _BV(RXEN0)) {
+            sim_reg[UDR0] = (uint8_t)sim_wire;
+            sim_rx_full = 1;
+        }
+        sim_wire = -1;
+    }
+    if (sim_tx_pending >= 0 && sim_now >= sim_tx_end) {
+        data = (uint8_t)sim_tx_pending;
+        sim_tx_pending = -1;
+        sim_uart_send(data, sim_tx_end);
+    }
+    if (sim_loopback) {
+        return;
+    }
+
+    if (!(sim_reg[UCSR0B] & _BV(RXEN0)) || sim_rx_full || sim_rx_eof ||
+        sim_now < sim_rx_next) {
+        return;
+    }
+    sim_rx_next = sim_now + sim_uart_char();
+    if (poll(&fd, 1, 0) == 1) {
+        n = read(sim_in, &data, 1);
+        if (n == 1) {
+            sim_reg[UDR0] = data;
+            sim_rx_full = 1;
+        }
+        else if (n == 0) {
+            /* End of stdin, a pseudo terminal without reader fails instead */
+            sim_rx_eof = 1;
+        }
+    }
+}
+
+/**
+  * @brief Byte on TXD.
+  */
+static void sim_uart_put(uint8_t data)
+{
+    if (sim_out_length == SIM_OUT_SIZE) {
+        sim_flush();
+    }
+    sim_out_buffer[sim_out_length++] = data;
+}
+
+/**
+  * @brief TWCR write: clearing TWINT starts the next bus action.
+  */
+static void sim_twi_control(uint8_t value)
+{
+    uint8_t i, sla;
+    uint16_t scl, byte = 0;
+
+    /* SCL period */
+    scl = 16 + 2 * sim_reg[TWBR] * (1 << (2 * (sim_reg[TWSR] & 0x03)));
+
+    if (!(value & _BV(TWEN))) {
+        /* Disabling the unit releases the bus */
+        if (sim_twi_owner) {
+            sim_bus(SIM_BUS_TWI_IDLE, sim_now, 0, scl);
+        }
+        sim_reg[TWCR] = value & ~_BV(TWINT);
+        sim_twi_phase = SIM_TWI_IDLE;
+        sim_twi_owner = 0;
+        sim_twi_done = 0;
+        return;
+    }
+    if (!(value & _BV(TWINT))) {
+        sim_reg[TWCR] = (sim_reg[TWCR] & _BV(TWINT)) | value;
+        return;
+    }
+    sim_reg[TWCR] = value & ~(_BV(TWINT) | _BV(TWSTO));
+
+    if (value & _BV(TWSTO)) {
+        if (sim_twi_slave != NULL && sim_twi_slave->stop != NULL) {
+            sim_twi_slave->stop(sim_twi_slave->context);
+        }
+        sim_twi_slave = NULL;
+        sim_twi_phase = SIM_TWI_IDLE;
+        sim_twi_owner = 0;
+        sim_bus(SIM_BUS_TWI_STOP, sim_now, 0, scl);
+        if (!(value & _BV(TWSTA))) {
+            return;
+        }
+    }
+
+    if (value & _BV(TWSTA)) {
+        sim_twi_status = sim_twi_owner ? SIM_TW_REP_START : SIM_TW_START;
+        sim_twi_owner = 1;
+        sim_twi_phase = SIM_TWI_START;
+        sim_twi_slave = NULL;
+    }
+    else if (sim_twi_phase == SIM_TWI_START) {
+        sla = sim_reg[TWDR];
+        for (i = 0; i < SIM_TWI_DEVICES && sim_twi_devices[i] != NULL; i++) {
+            if (sim_twi_devices[i]->address == sla >> 1) {
+                sim_twi_slave = sim_twi_devices[i];
+                break;
+            }
+        }
+        if (sim_twi_slave != NULL &&
+            !sim_twi_slave->start(sim_twi_slave->context, sla & 0x01)) {
+            sim_twi_slave = NULL;
+        }
+        byte = sla | (sim_twi_slave ? 0 : SIM_BUS_NACK);
+        if (sla & 0x01) {
+            sim_twi_status = sim_twi_slave ? SIM_TW_MR_SLA_ACK : SIM_TW_MR_SLA_NACK;
+            sim_twi_phase = SIM_TWI_RECEIVE;
+        }
+        else {
+            sim_twi_status = sim_twi_slave ? SIM_TW_MT_SLA_ACK : SIM_TW_MT_SLA_NACK;
+            sim_twi_phase = SIM_TWI_TRANSMIT;
+        }
+    }
+    else if (sim_twi_phase == SIM_TWI_TRANSMIT) {
+        sim_twi_status = (sim_twi_slave != NULL &&
+                          sim_twi_slave->write(sim_twi_slave->context,
+                                               sim_reg[TWDR])) ?
+                         SIM_TW_MT_DATA_ACK : SIM_TW_MT_DATA_NACK;
+        byte = sim_reg[TWDR] |
+               (sim_twi_status == SIM_TW_MT_DATA_ACK ? 0 : SIM_BUS_NACK);
+    }
+    else if (sim_twi_phase == SIM_TWI_RECEIVE) {
+        /* Released SDA reads as 1s */
+        sim_twi_data = sim_twi_slave != NULL ?
+                       sim_twi_slave->read(sim_twi_slave->context,
+                                           (value & _BV(TWEA)) != 0) : 0xff;
+        sim_twi_status = (value & _BV(TWEA)) ?
+                         SIM_TW_MR_DATA_ACK : SIM_TW_MR_DATA_NACK;
+        byte = sim_twi_data | ((value & _BV(TWEA)) ? 0 : SIM_BUS_NACK);
+    }
+    else {
+        return;
+    }
+
+    /* A start takes about one SCL period, a byte nine */
+    if (sim_twi_status == SIM_TW_START || sim_twi_status == SIM_TW_REP_START) {
+        sim_twi_done = sim_now + scl;
+        sim_bus(SIM_BUS_TWI_START, sim_now, 0, scl);
+    }
+    else {
+        sim_twi_done = sim_now + 9UL * scl;
+        sim_bus(SIM_BUS_TWI_BYTE, sim_now, byte, scl);
+    }
+}
+
+/**
+  * @brief Tell the bus listeners about a byte or condition.
+  */
+static void sim_bus(uint8_t event, uint64_t start, uint16_t data,
+                    uint32_t bit_cycles)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_LISTENERS && sim_bus_listeners[i] != NULL; i++) {
+        sim_bus_listeners[i](event, start, data, bit_cycles);
+    }
+}
+
+/**
+  * @brief Finish the running bus action: status and TWINT.
+  */
+static void sim_twi_run(void)
+{
+    uint8_t i;
+
+    if (sim_twi_done == 0 || sim_now < sim_twi_done) {
+        return;
+    }
+    /* SDA held low: no start, no byte, until the unit is disabled */
+    for (i = 0; i < SIM_TWI_DEVICES && sim_twi_devices[i] != NULL; i++) {
+        if (sim_twi_devices[i]->hold != NULL &&
+            sim_twi_devices[i]->hold(sim_twi_devices[i]->context)) {
+            return;
+        }
+    }
+    sim_twi_done = 0;
+    if (sim_twi_status == SIM_TW_MR_DATA_ACK ||
+        sim_twi_status == SIM_TW_MR_DATA_NACK) {
+        sim_reg[TWDR] = sim_twi_data;
+    }
+    sim_reg[TWSR] = sim_twi_status | (sim_reg[TWSR] & 0x03);
+    sim_reg[TWCR] |= _BV(TWINT);
+}
+
+/**
+  * @brief Run the pending interrupts while they are enabled, never nested.
+  */
+static void sim_interrupts(void)
+{
+    const sim_vector_t *vector;
+
+    while ((sim_reg[SREG] & _BV(SREG_I)) && (vector = sim_pending()) != NULL) {
+        if (vector->handler == NULL) {
+            /* avr-libc jumps to __bad_interrupt, a reset */
+            sim_flush();
+            fprintf(stderr, "sim: %s enabled without handler\n", vector->name);
+            exit(EXIT_FAILURE);
+        }
+        sim_reg[SREG] &= ~_BV(SREG_I);
+        sim_now += SIM_IRQ_CYCLES;
+        vector->handler();
+        sim_reg[SREG] |= _BV(SREG_I);
+    }
+}
+
+/**
+  * @brief Enabled interrupt with the lowest vector number. Timer flags are
+  *        cleared by taking the interrupt, the others by the handler.
+  * @return Vector, NULL if none is pending
+  */
+static const sim_vector_t *sim_pending(void)
+{
+    static const sim_vector_t vectors[] = {
+        {"TIMER2_COMPA_vect", TIMER2_COMPA_vect},
+        {"TIMER2_COMPB_vect", TIMER2_COMPB_vect},
+        {"TIMER2_OVF_vect", TIMER2_OVF_vect},
+        {"TIMER0_COMPA_vect", TIMER0_COMPA_vect},
+        {"TIMER0_COMPB_vect", TIMER0_COMPB_vect},
+        {"TIMER0_OVF_vect", TIMER0_OVF_vect},
+        {"USART_RX_vect", USART_RX_vect},
+        {"USART_UDRE_vect", USART_UDRE_vect},
+        {"TWI_vect", TWI_vect}
+    };
+    /* Compare A, compare B and overflow flags, same bits in both timers */
+    static const uint8_t timer_flags[3] = {_BV(OCF0A), _BV(OCF0B), _BV(TOV0)};
+    uint8_t pending, i;
+
+    pending = sim_reg[TIFR2] & sim_reg[TIMSK2];
+    for (i = 0; i < 3; i++) {
+        if (pending & timer_flags[i]) {
+            sim_reg[TIFR2] &= ~timer_flags[i];
+            return &vectors[i];
+        }
+    }
+    pending = sim_reg[TIFR0] & sim_reg[TIMSK0];
+    for (i = 0; i < 3; i++) {
+        if (pending & timer_flags[i]) {
+            sim_reg[TIFR0] &= ~timer_flags[i];
+            return &vectors[3 + i];
+        }
+    }
+    if (sim_rx_full && (sim_reg[UCSR0B] & _BV(RXCIE0))) {
+        return &vectors[6];
+    }
+    if (sim_tx_pending < 0 && (sim_reg[UCSR0B] & _BV(UDRIE0))) {
+        return &vectors[7];
+    }
+    if ((sim_reg[TWCR] & (_BV(TWINT) | _BV(TWIE) | _BV(TWEN))) ==
+        (_BV(TWINT) | _BV(TWIE) | _BV(TWEN))) {
+        return &vectors[8];
+    }
+    return NULL;
+}
+
+/**
+  * @brief Once per virtual millisecond: flush TXD, stop at the end of the
+  *        run and hold the virtual clock back to real time.
+  */
+static void sim_pace(void)
+{
+    struct timespec now;
+    int64_t ahead;
+
+    sim_next_pace += SIM_PACE_CYCLES;
+    sim_flush();
+    if (sim_end && sim_now >= sim_end) {
+        exit(EXIT_SUCCESS);
+    }
+    if (!sim_realtime) {
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ahead = (int64_t)(sim_now * (1000000000.0 / F_CPU)) -
+            ((int64_t)(now.tv_sec - sim_start.tv_sec) * 1000000000L +
+             (now.tv_nsec - sim_start.tv_nsec));
+    if (ahead > 0) {
+        now.tv_sec = ahead / 1000000000L;
+        now.tv_nsec = ahead % 1000000000L;
+        nanosleep(&now, NULL);
+    }
+}
+
+/**
+  * @brief Write the bytes sent on TXD.
+  */
+static void sim_flush(void)
+{
+    size_t done = 0;
+    ssize_t n;
+
+    while (done < sim_out_length) {
+        n = write(sim_out, sim_out_buffer + done, sim_out_length - done);
+        if (n <= 0) {
+            /* Nobody reads a pseudo terminal: drop, like a wire would */
+            break;
+        }
+        done += n;
+    }
+    sim_out_length = 0;
+}
+
+/**
+  * @brief Open a serial port or pseudo terminal in raw mode.
+  * @return File descriptor, -1 on error
+  */
+static int open_port(const char *path)
+{
+    struct termios tio;
+    int fd = open(path, O_RDWR | O_NOCTTY);
+
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/**
+  * @brief Create a pseudo terminal in raw mode and print the name of its
+  *        slave side, which the host tools open.
+  * @return File descriptor of the master side, -1 on error
+  */
+static int open_pty(void)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    /* Output is dropped while nobody reads the slave side */
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    printf("%s\n", ptsname(fd));
+    fflush(stdout);
+    return fd;
+}
+
+/* END OF FILE ****************************************************************/
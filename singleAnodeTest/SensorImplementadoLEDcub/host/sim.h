@@ -0,0 +1,144 @@
+#ifndef SIM_H_INCLUDED
+#define SIM_H_INCLUDED
+
+/**
+ *  @file sim.h
+ *  @code #include "sim.h" @endcode
+ *
+ *  @brief Virtual ATmega328P behind the host build of hal.h.
+ *
+ *  The firmware runs unchanged on a virtual clock counted in CPU cycles.
+ *  Every register access costs SIM_ACCESS_CYCLES, after which the
+ *  peripherals catch up and due interrupts run, highest priority first and
+ *  never nested, as on the AVR:
+ *     - Timer/Counter0 and Timer/Counter2, normal and CTC mode
+ *     - USART0, bytes to and from a file descriptor at the baud rate, or
+ *       looped back from TXD to RXD with overrun (sim -L)
+ *     - TWI master, talking to the devices given to sim_twi_attach()
+ *     - Ports B, C and D, level changes go to the sim_on_pins() listeners
+ *
+ *  TXD and the TWI lines are not modelled bit by bit, the sim_on_bus()
+ *  listeners learn about each byte when it starts instead.
+ *
+ *  Models of external parts plug in through these hooks; the register file
+ *  itself is private to host/sim.c.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief CPU cycles of one register access, e.g. lds/sts.
+ */
+#define SIM_ACCESS_CYCLES 2
+
+/**
+ *  @brief CPU cycles of interrupt entry and reti, without the handler.
+ */
+#define SIM_IRQ_CYCLES 10
+
+/**
+ *  @brief Ports of sim_pins() and the pin listeners.
+ */
+#define SIM_PORTB 0
+#define SIM_PORTC 1
+#define SIM_PORTD 2
+#define SIM_PORTS 3
+
+/**
+ *  @brief Listeners of each kind.
+ */
+#define SIM_LISTENERS 4
+
+/**
+ *  @brief Events of the sim_on_bus() listeners.
+ */
+#define SIM_BUS_TXD       0 /**< Byte on TXD, 8N1 */
+#define SIM_BUS_TWI_START 1 /**< (Repeated) start condition */
+#define SIM_BUS_TWI_BYTE  2 /**< 8 bits and acknowledge, bit 8 set for NACK */
+#define SIM_BUS_TWI_STOP  3 /**< Stop condition */
+#define SIM_BUS_TWI_IDLE  4 /**< Unit disabled, both lines released */
+
+/**
+ *  @brief NACK bit of SIM_BUS_TWI_BYTE.
+ */
+#define SIM_BUS_NACK 0x100
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief Level change of a port.
+ *  @param port - SIM_PORTB .. SIM_PORTD
+ *  @param old - Levels before, bit n is pin n
+ *  @param levels - Levels now
+ */
+typedef void (*sim_pins_t)(uint8_t port, uint8_t old, uint8_t levels);
+
+/**
+ *  @brief Byte or condition on TXD or the TWI bus.
+ *  @param event - SIM_BUS_x
+ *  @param start - sim_cycles() of the start, may lie a few cycles back
+ *  @param data - Byte, with SIM_BUS_NACK for TWI
+ *  @param bit_cycles - Length of a bit, the SCL period for TWI
+ */
+typedef void (*sim_bus_t)(uint8_t event, uint64_t start, uint16_t data,
+                          uint32_t bit_cycles);
+
+/**
+ *  @brief TWI slave on the simulated bus. Every byte takes the bus time of
+ *         9 SCL periods, the handlers answer at once.
+ */
+typedef struct {
+    /** 7-bit address */
+    uint8_t address;
+    /** Addressed after a (repeated) start, return 1 for ACK */
+    uint8_t (*start)(void *context, uint8_t read);
+    /** Byte from the master, return 1 for ACK */
+    uint8_t (*write)(void *context, uint8_t data);
+    /** Byte to the master, ack is 1 if the master ACKs it */
+    uint8_t (*read)(void *context, uint8_t ack);
+    /** Stop condition */
+    void (*stop)(void *context);
+    /** 1 while the device holds SDA low, the bus action in progress does
+     *  not finish until it lets go; NULL if it never does */
+    uint8_t (*hold)(void *context);
+    void *context;
+} sim_twi_device_t;
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Virtual time.
+ *  @return CPU cycles since reset
+ */
+uint64_t sim_cycles(void);
+
+/**
+ *  @brief Levels of a port, the output value or the pull-up of each pin.
+ *  @param port - SIM_PORTB .. SIM_PORTD
+ */
+uint8_t sim_pins(uint8_t port);
+
+/**
+ *  @brief Call listener after every level change of a port, with
+ *         sim_cycles() at the time of the change.
+ *  @return 0, 1 if SIM_LISTENERS are registered already
+ */
+uint8_t sim_on_pins(sim_pins_t listener);
+
+/**
+ *  @brief Call listener at the start of every byte on TXD and every bus
+ *         action of the TWI master.
+ *  @return 0, 1 if SIM_LISTENERS are registered already
+ */
+uint8_t sim_on_bus(sim_bus_t listener);
+
+/**
+ *  @brief Connect a slave to the TWI bus.
+ *  @param device - Must stay valid, not copied
+ *  @return 0, 1 if the bus is full
+ */
+uint8_t sim_twi_attach(const sim_twi_device_t *device);
+
+#endif /* SIM_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
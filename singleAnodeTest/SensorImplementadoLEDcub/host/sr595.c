@@ -0,0 +1,216 @@
+/**
+  ******************************************************************************
+  * @file    sr595.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Three daisy chained 74HC595 on the simulated pins: shift and
+  *          storage registers, protocol checks and shift time per frame.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "settings.h"
+#include "sr595.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define SR595_MASK ((1UL << SR595_BITS) - 1)
+
+/* Setup time in CPU cycles, a change in the same cycle always violates it */
+#define SR595_SETUP_CYCLES \
+    ((uint64_t)SR595_SETUP_NS * (F_CPU / 1000000UL) / 1000 + 1)
+
+/* Function prototypes -------------------------------------------------------*/
+static void sr595_pins(uint8_t port, uint8_t old, uint8_t levels);
+static void sr595_clock(uint64_t now);
+static void sr595_latch(uint64_t now);
+static void sr595_violation(uint64_t now, const char *what);
+
+/* Global variables ----------------------------------------------------------*/
+static uint32_t sr595_shift = 0;
+static uint32_t sr595_storage = 0;
+static sr595_stats_t sr595_counters;
+static sr595_latch_t sr595_latch_listeners[SIM_LISTENERS];
+
+/* Clocks since the last latch, up to SR595_BITS, and the times of the last
+ * SR595_BITS clocks: bits clocked in before those have left the chain */
+static uint8_t sr595_pending = 0;
+static uint64_t sr595_clock_times[SR595_BITS];
+static uint8_t sr595_clock_index = 0;
+
+/* Last change of DATA and last rising CLK edge, for the setup times; no
+ * change yet counts as long ago */
+static uint64_t sr595_data_changed;
+static uint64_t sr595_clock_rose;
+static uint8_t sr595_data_seen = 0;
+static uint8_t sr595_clock_seen = 0;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Connect the model to the pins.
+  */
+uint8_t sr595_init(void)
+{
+    static uint8_t connected = 0;
+
+    /* Several users, one model */
+    if (!connected) {
+        if (sim_on_pins(sr595_pins)) {
+            return 1;
+        }
+        connected = 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief Register a latch listener.
+  */
+uint8_t sr595_on_latch(sr595_latch_t listener)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_LISTENERS; i++) {
+        if (sr595_latch_listeners[i] == NULL) {
+            sr595_latch_listeners[i] = listener;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+  * @brief Outputs of the chain.
+  */
+uint32_t sr595_outputs(void)
+{
+    return sr595_storage;
+}
+
+/**
+  * @brief Level of QA..QH of SR1..SR3.
+  */
+uint8_t sr595_q(uint8_t sr, uint8_t q)
+{
+    return (sr595_storage >> ((sr - 1) * SR595_OUTPUTS + q)) & 0x01;
+}
+
+/**
+  * @brief Counters.
+  */
+const sr595_stats_t *sr595_stats(void)
+{
+    return &sr595_counters;
+}
+
+/**
+  * @brief Counters and shift time per frame.
+  */
+void sr595_report(void)
+{
+    const sr595_stats_t *s = &sr595_counters;
+    double now = (double)sim_cycles();
+
+    fprintf(stderr, "sr595: %u latches, %u words, %u changed the outputs, "
+            "%u clocks, %u violations, outputs 0x%06x\n", s->latches, s->words,
+            s->frames, s->clocks, s->violations, sr595_storage);
+    if (s->words == 0) {
+        return;
+    }
+    fprintf(stderr, "sr595: shift time per word %.1f us, max %.1f us, "
+            "%.1f %% of the CPU\n",
+            s->shift_cycles * 1e6 / F_CPU / s->words,
+            s->shift_max * 1e6 / F_CPU,
+            now > 0 ? 100.0 * s->shift_cycles / now : 0.0);
+}
+
+/**
+  * @brief Pin listener: rising CLK and LATCH edges, DATA changes.
+  */
+static void sr595_pins(uint8_t port, uint8_t old, uint8_t levels)
+{
+    uint64_t now = sim_cycles();
+    uint8_t rose = ~old & levels;
+
+    if (port == SR595_DATA_PORT && ((old ^ levels) & (1 << SR595_DATA_PIN))) {
+        sr595_data_changed = now;
+        sr595_data_seen = 1;
+    }
+    if (port == SR595_CLK_PORT && (rose & (1 << SR595_CLK_PIN))) {
+        sr595_clock(now);
+    }
+    if (port == SR595_LATCH_PORT && (rose & (1 << SR595_LATCH_PIN))) {
+        sr595_latch(now);
+    }
+}
+
+/**
+  * @brief Rising CLK: DATA into QA of SR1, every bit one stage further.
+  */
+static void sr595_clock(uint64_t now)
+{
+    uint8_t data = (sim_pins(SR595_DATA_PORT) >> SR595_DATA_PIN) & 0x01;
+
+    if (sr595_data_seen && now - sr595_data_changed < SR595_SETUP_CYCLES) {
+        sr595_violation(now, "DATA changed within the setup time of CLK");
+    }
+    sr595_shift = ((sr595_shift << 1) | data) & SR595_MASK;
+    sr595_counters.clocks++;
+    sr595_clock_times[sr595_clock_index] = now;
+    sr595_clock_index = (sr595_clock_index + 1) % SR595_BITS;
+    if (sr595_pending < SR595_BITS) {
+        sr595_pending++;
+    }
+    sr595_clock_rose = now;
+    sr595_clock_seen = 1;
+}
+
+/**
+  * @brief Rising LATCH: shift registers to the outputs.
+  */
+static void sr595_latch(uint64_t now)
+{
+    uint32_t shift;
+    uint8_t i;
+
+    if (sr595_clock_seen && now - sr595_clock_rose < SR595_SETUP_CYCLES) {
+        sr595_violation(now, "CLK rose within the setup time of LATCH");
+    }
+    /* No clock at all latches the same word again, harmless */
+    if (sr595_pending > 0 && sr595_pending < SR595_BITS) {
+        sr595_violation(now, "LATCH after a partly shifted word");
+    }
+    sr595_counters.latches++;
+    if (sr595_pending > 0) {
+        /* Oldest clock of the word on the outputs */
+        shift = (uint32_t)(now - sr595_clock_times[
+            (sr595_clock_index + SR595_BITS - sr595_pending) % SR595_BITS]);
+        sr595_counters.shift_cycles += shift;
+        if (shift > sr595_counters.shift_max) {
+            sr595_counters.shift_max = shift;
+        }
+        sr595_counters.words++;
+        sr595_pending = 0;
+    }
+
+    if (sr595_storage == sr595_shift) {
+        return;
+    }
+    sr595_storage = sr595_shift;
+    sr595_counters.frames++;
+    for (i = 0; i < SIM_LISTENERS && sr595_latch_listeners[i] != NULL; i++) {
+        sr595_latch_listeners[i](sr595_storage, now);
+    }
+}
+
+/**
+  * @brief Count a violation, print the first ones.
+  */
+static void sr595_violation(uint64_t now, const char *what)
+{
+    if (sr595_counters.violations++ < SR595_REPORTS) {
+        fprintf(stderr, "sr595: %.3f ms: %s\n", now * 1e3 / F_CPU, what);
+    }
+}
+
+/* END OF FILE ****************************************************************/
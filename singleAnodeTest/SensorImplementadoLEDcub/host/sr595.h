@@ -0,0 +1,122 @@
+#ifndef SR595_H_INCLUDED
+#define SR595_H_INCLUDED
+
+/**
+ *  @file sr595.h
+ *  @code #include "sr595.h" @endcode
+ *
+ *  @brief Model of the three daisy chained 74HC595 of CUBE_DRIVER_SR595 for
+ *         the simulator, driven by the pin listeners of sim.h.
+ *
+ *  DATA (PB0) goes to SER of SR1, QH' of SR1 to SR2 and QH' of SR2 to SR3,
+ *  all SRCLK on CLK (PD7), all RCLK on LATCH (PD4). A rising CLK edge shifts
+ *  DATA into QA of SR1, a rising LATCH edge copies the shift registers to
+ *  the outputs. The first of 24 bits ends up on QH of SR3, which is why the
+ *  firmware shifts SR3 first, MSB first.
+ *
+ *  Outputs are given as one word: SR3 in bits 23..16, SR2 in 15..8, SR1 in
+ *  7..0, QA the lowest bit of each byte. This is the layout of cube_latched
+ *  in src/cube.c.
+ *
+ *  The model reports protocol violations on stderr:
+ *     - DATA changed less than SR595_SETUP_NS before a CLK edge
+ *     - CLK rose less than SR595_SETUP_NS before a LATCH edge
+ *     - LATCH after 1..23 clocks, a word only partly shifted in
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "sim.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Pins of the chain, see src/cube.c.
+ */
+#define SR595_DATA_PORT  SIM_PORTB
+#define SR595_DATA_PIN   0
+#define SR595_CLK_PORT   SIM_PORTD
+#define SR595_CLK_PIN    7
+#define SR595_LATCH_PORT SIM_PORTD
+#define SR595_LATCH_PIN  4
+
+/**
+ *  @brief Bits of the chain and outputs of one register.
+ */
+#define SR595_BITS    24
+#define SR595_OUTPUTS 8
+
+/**
+ *  @brief Setup times of the 74HC595 at 4.5 V, SER to SRCLK and SRCLK to
+ *         RCLK, with margin.
+ */
+#define SR595_SETUP_NS 25
+
+/**
+ *  @brief Violations printed, the rest is counted only.
+ */
+#define SR595_REPORTS 10
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief New outputs after a LATCH edge.
+ *  @param outputs - SR3 in bits 23..16, SR2 in 15..8, SR1 in 7..0
+ *  @param cycles - sim_cycles() of the edge
+ */
+typedef void (*sr595_latch_t)(uint32_t outputs, uint64_t cycles);
+
+/**
+ *  @brief Counters since sr595_init().
+ */
+typedef struct {
+    /** Rising LATCH and CLK edges */
+    uint32_t latches;
+    uint32_t clocks;
+    /** Latches of a newly shifted word, latches that changed the outputs */
+    uint32_t words;
+    uint32_t frames;
+    /** Protocol violations */
+    uint32_t violations;
+    /** CPU cycles from the first of the last SR595_BITS clocks to the latch */
+    uint64_t shift_cycles;
+    uint32_t shift_max;
+} sr595_stats_t;
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Connect the model to the pins, outputs and shift registers start
+ *         cleared. Calls after the first one do nothing.
+ *  @return 0, 1 if no pin listener is free
+ */
+uint8_t sr595_init(void);
+
+/**
+ *  @brief Call listener after every LATCH edge that changed the outputs.
+ *  @return 0, 1 if SIM_LISTENERS are registered already
+ */
+uint8_t sr595_on_latch(sr595_latch_t listener);
+
+/**
+ *  @brief Outputs, SR3 in bits 23..16, SR2 in 15..8, SR1 in 7..0.
+ */
+uint32_t sr595_outputs(void);
+
+/**
+ *  @brief Level of one output.
+ *  @param sr - 1 .. 3
+ *  @param q - 0 (QA) .. 7 (QH)
+ */
+uint8_t sr595_q(uint8_t sr, uint8_t q);
+
+/**
+ *  @brief Counters since sr595_init().
+ */
+const sr595_stats_t *sr595_stats(void);
+
+/**
+ *  @brief Print the counters and the shift time per frame to stderr.
+ */
+void sr595_report(void);
+
+#endif /* SR595_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file    sr595test.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Checks of the 74HC595 chain model of sr595.h, run instead of the
+  *          firmware on the simulator.
+  *
+  *          sr595test [-f]
+  *
+  *          Known DATA/CLK/LATCH sequences are driven on the pins, SR3
+  *          first and MSB first as src/cube.c shifts them, and the outputs
+  *          and counters of the model are compared with the expected ones.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "settings.h"
+#include "hal.h"
+#include "sr595.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Half a CLK period, well above SR595_SETUP_NS */
+#define SR595TEST_HALF_US 1
+
+/* Function prototypes -------------------------------------------------------*/
+int sim_firmware_main(void);
+static void sr595test_shift(uint32_t word, uint8_t bits);
+static void sr595test_latch(void);
+static void sr595test_expect(const char *what, uint32_t value,
+                             uint32_t expected);
+
+/* Global variables ----------------------------------------------------------*/
+static uint8_t sr595test_failed = 0;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Test sequences in place of the firmware main().
+  */
+int sim_firmware_main(void)
+{
+    const sr595_stats_t *stats = sr595_stats();
+
+    if (sr595_init()) {
+        fprintf(stderr, "sr595test: no listener free\n");
+        return EXIT_FAILURE;
+    }
+    HAL_SET(HAL_DDR(PORTB), _BV(SR595_DATA_PIN));
+    HAL_SET(HAL_DDR(PORTD), _BV(SR595_CLK_PIN) | _BV(SR595_LATCH_PIN));
+
+    /* A whole word: SR3 = 0xa5, SR2 = 0x3c, SR1 = 0x81 */
+    sr595test_shift(0xa53c81, SR595_BITS);
+    sr595test_expect("outputs before the latch", sr595_outputs(), 0);
+    sr595test_latch();
+    sr595test_expect("outputs of a word", sr595_outputs(), 0xa53c81);
+    sr595test_expect("SR3 QH, first bit shifted", sr595_q(3, 7), 1);
+    sr595test_expect("SR3 QG", sr595_q(3, 6), 0);
+    sr595test_expect("SR2 QF", sr595_q(2, 5), 1);
+    sr595test_expect("SR2 QA", sr595_q(2, 0), 0);
+    sr595test_expect("SR1 QH", sr595_q(1, 7), 1);
+    sr595test_expect("SR1 QA, last bit shifted", sr595_q(1, 0), 1);
+    sr595test_expect("violations of a word", stats->violations, 0);
+
+    /* Latching again without clocks keeps the outputs */
+    sr595test_latch();
+    sr595test_expect("outputs of a second latch", sr595_outputs(), 0xa53c81);
+    sr595test_expect("words of a second latch", stats->words, 1);
+    sr595test_expect("violations of a second latch", stats->violations, 0);
+
+    /* 8 bits only: the word moves on by one register, a violation */
+    sr595test_shift(0xff, 8);
+    sr595test_latch();
+    sr595test_expect("outputs of a partly shifted word", sr595_outputs(),
+                     0x3c81ff);
+    sr595test_expect("violations of a partly shifted word",
+                     stats->violations, 1);
+
+    /* CLK and LATCH rise in the same write to PORTD: the 24th bit is
+     * latched, but without setup time */
+    sr595test_shift(0x123456 >> 1, SR595_BITS - 1);
+    HAL_CLEAR(PORTB, _BV(SR595_DATA_PIN));
+    _delay_us(SR595TEST_HALF_US);
+    HAL_SET(PORTD, _BV(SR595_CLK_PIN) | _BV(SR595_LATCH_PIN));
+    _delay_us(SR595TEST_HALF_US);
+    HAL_CLEAR(PORTD, _BV(SR595_CLK_PIN) | _BV(SR595_LATCH_PIN));
+    sr595test_expect("outputs of a latch with the last clock",
+                     sr595_outputs(), 0x123456);
+    sr595test_expect("violations of a latch with the last clock",
+                     stats->violations, 2);
+
+    sr595test_expect("clocks", stats->clocks, 2 * SR595_BITS + 8);
+    sr595test_expect("latches", stats->latches, 4);
+    sr595test_expect("words", stats->words, 3);
+    sr595test_expect("output changes", stats->frames, 3);
+    return sr595test_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+  * @brief Shift the lowest bits of a word, MSB first.
+  */
+static void sr595test_shift(uint32_t word, uint8_t bits)
+{
+    while (bits--) {
+        if (word & (1UL << bits)) {
+            HAL_SET(PORTB, _BV(SR595_DATA_PIN));
+        }
+        else {
+            HAL_CLEAR(PORTB, _BV(SR595_DATA_PIN));
+        }
+        _delay_us(SR595TEST_HALF_US);
+        HAL_SET(PORTD, _BV(SR595_CLK_PIN));
+        _delay_us(SR595TEST_HALF_US);
+        HAL_CLEAR(PORTD, _BV(SR595_CLK_PIN));
+    }
+}
+
+/**
+  * @brief Pulse LATCH after the setup time.
+  */
+static void sr595test_latch(void)
+{
+    _delay_us(SR595TEST_HALF_US);
+    HAL_SET(PORTD, _BV(SR595_LATCH_PIN));
+    _delay_us(SR595TEST_HALF_US);
+    HAL_CLEAR(PORTD, _BV(SR595_LATCH_PIN));
+}
+
+/**
+  * @brief Print one check, remember a failure.
+  */
+static void sr595test_expect(const char *what, uint32_t value,
+                             uint32_t expected)
+{
+    if (value == expected) {
+        printf("ok   %s: %lu\n", what, (unsigned long)value);
+    }
+    else {
+        printf("FAIL %s: %lu, expected %lu\n", what, (unsigned long)value,
+               (unsigned long)expected);
+        sr595test_failed = 1;
+    }
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,323 @@
+/**
+  ******************************************************************************
+  * @file    streamer.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Host side of the UART frame stream: renders test patterns and
+  *          sends them COBS framed to the cube (see inc/stream.h).
+  *
+  *          streamer [-p port | -t] [-b baud] [-f fps] [-g] [-n frames]
+  *             -p  serial port, e.g. /dev/ttyUSB0
+  *             -t  create a pseudo terminal and print its name instead,
+  *                 for a simulator or a viewer on the other side
+  *             -b  baud rate, default 115200
+  *             -f  frames per second, default 100
+  *             -g  grey scale frames, binary otherwise
+  *             -n  number of frames, default endless
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "crc.h"
+#include "stream.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define LEDS (CUBE_LAYERS * CUBE_COLOURS * CUBE_COLUMNS)
+
+/* Decoded packet and its COBS encoding with delimiter */
+#define PACKET_MAX  (STREAM_HEADER + STREAM_GREY_SIZE + STREAM_TRAILER)
+#define ENCODED_MAX (PACKET_MAX + PACKET_MAX / 254 + 2)
+
+/* Function prototypes -------------------------------------------------------*/
+static int open_port(const char *path, speed_t speed);
+static int open_pty(void);
+static speed_t baud_to_speed(long baud);
+static int start_stream(int fd);
+static size_t cobs_encode(const uint8_t *data, size_t length, uint8_t *out);
+static void render(uint8_t *level, unsigned long frame);
+static size_t pack(const uint8_t *level, int grey, uint8_t sequence,
+                   uint8_t *packet);
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Main function.
+  */
+int main(int argc, char *argv[])
+{
+    const char *port = NULL;
+    int pty = 0, grey = 0, fd, opt;
+    long baud = 115200, fps = 100, frames = -1;
+    uint8_t level[LEDS], packet[PACKET_MAX], encoded[ENCODED_MAX];
+    struct timespec next;
+    unsigned long frame;
+    speed_t speed;
+
+    while ((opt = getopt(argc, argv, "p:tb:f:gn:")) != -1) {
+        switch (opt) {
+        case 'p':
+            port = optarg;
+            break;
+        case 't':
+            pty = 1;
+            break;
+        case 'b':
+            baud = strtol(optarg, NULL, 10);
+            break;
+        case 'f':
+            fps = strtol(optarg, NULL, 10);
+            break;
+        case 'g':
+            grey = 1;
+            break;
+        case 'n':
+            frames = strtol(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p port | -t] [-b baud] [-f fps] "
+                            "[-g] [-n frames]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((port == NULL) == !pty || fps <= 0) {
+        fprintf(stderr, "%s: give either -p port or -t, fps > 0\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (pty) {
+        fd = open_pty();
+    }
+    else {
+        speed = baud_to_speed(baud);
+        if (speed == B0) {
+            fprintf(stderr, "%s: unsupported baud rate %ld\n", argv[0], baud);
+            return EXIT_FAILURE;
+        }
+        fd = open_port(port, speed);
+    }
+    if (fd < 0) {
+        return EXIT_FAILURE;
+    }
+    if (start_stream(fd) < 0) {
+        perror("write");
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (frame = 0; frames < 0 || frame < (unsigned long)frames; frame++) {
+        size_t length;
+
+        render(level, frame);
+        length = pack(level, grey, (uint8_t)frame, packet);
+        length = cobs_encode(packet, length, encoded);
+        if (write(fd, encoded, length) < 0 && errno != EAGAIN) {
+            perror("write");
+            return EXIT_FAILURE;
+        }
+
+        /* Fixed frame rate without drift */
+        next.tv_nsec += 1000000000L / fps;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    close(fd);
+    return EXIT_SUCCESS;
+}
+
+/**
+  * @brief Open a serial port in raw mode, 8N1.
+  * @return File descriptor, -1 on error
+  */
+static int open_port(const char *path, speed_t speed)
+{
+    struct termios tio;
+    int fd = open(path, O_RDWR | O_NOCTTY);
+
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) < 0) {
+        perror("tcgetattr");
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        perror("tcsetattr");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+  * @brief Create a pseudo terminal in raw mode and print the name of its
+  *        slave side, which the receiver opens.
+  * @return File descriptor of the master side, -1 on error
+  */
+static int open_pty(void)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    /* Frames are dropped while nobody reads the slave side */
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    printf("%s\n", ptsname(fd));
+    fflush(stdout);
+    return fd;
+}
+
+/**
+  * @brief termios speed of a baud rate.
+  * @return Speed, B0 if not supported
+  */
+static speed_t baud_to_speed(long baud)
+{
+    switch (baud) {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 500000:  return B500000;
+    case 1000000: return B1000000;
+    default:      return B0;
+    }
+}
+
+/**
+  * @brief Switch the cube from the command shell to the frame stream. The
+  *        delimiter after the command starts the first packet on a clean
+  *        decoder, also on a receiver without a shell.
+  * @return 0, -1 on error
+  */
+static int start_stream(int fd)
+{
+    static const char command[] = "\rstream\r";
+    static const uint8_t delimiter = 0;
+
+    if (write(fd, command, sizeof(command) - 1) < 0 && errno != EAGAIN) {
+        return -1;
+    }
+    /* Let the shell execute the command before the first frame */
+    usleep(50000);
+    if (write(fd, &delimiter, 1) < 0 && errno != EAGAIN) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+  * @brief COBS encode a packet and append the 0x00 delimiter.
+  * @return Encoded length
+  */
+static size_t cobs_encode(const uint8_t *data, size_t length, uint8_t *out)
+{
+    size_t code_index = 0, n = 1, i;
+    uint8_t code = 1;
+
+    for (i = 0; i < length; i++) {
+        if (data[i] != 0) {
+            out[n++] = data[i];
+            code++;
+        }
+        if (data[i] == 0 || code == 0xff) {
+            out[code_index] = code;
+            code_index = n++;
+            code = 1;
+        }
+    }
+    out[code_index] = code;
+    out[n++] = 0;
+    return n;
+}
+
+/**
+  * @brief Test pattern: a lit layer moving up on the red plane and a
+  *        brightness wave running through the columns of the green plane.
+  */
+static void render(uint8_t *level, unsigned long frame)
+{
+    unsigned layer, colour, column;
+    unsigned step = frame / 10;
+
+    for (layer = 0; layer < CUBE_LAYERS; layer++) {
+        for (colour = 0; colour < CUBE_COLOURS; colour++) {
+            for (column = 0; column < CUBE_COLUMNS; column++) {
+                unsigned n = (layer * CUBE_COLOURS + colour) * CUBE_COLUMNS +
+                             column;
+
+                if (colour == CUBE_RED) {
+                    level[n] = (layer == step % CUBE_LAYERS) ? 15 : 0;
+                }
+                else {
+                    level[n] = (column + layer + frame / 4) % 16;
+                }
+            }
+        }
+    }
+}
+
+/**
+  * @brief Build a packet from one level 0..15 per LED, CRC-8 included.
+  * @return Packet length
+  */
+static size_t pack(const uint8_t *level, int grey, uint8_t sequence,
+                   uint8_t *packet)
+{
+    uint8_t *data = &packet[STREAM_HEADER];
+    size_t length;
+    unsigned n;
+
+    packet[0] = sequence;
+    if (grey) {
+        packet[1] = STREAM_GREY;
+        memset(data, 0, STREAM_GREY_SIZE);
+        for (n = 0; n < LEDS; n++) {
+            data[n >> 1] |= (level[n] & 0x0f) << ((n & 1) * 4);
+        }
+        length = STREAM_HEADER + STREAM_GREY_SIZE;
+    }
+    else {
+        packet[1] = STREAM_BINARY;
+        memset(data, 0, STREAM_BINARY_SIZE);
+        for (n = 0; n < LEDS; n++) {
+            if (level[n] >= 8) {
+                data[n >> 3] |= 1 << (n & 7);
+            }
+        }
+        length = STREAM_HEADER + STREAM_BINARY_SIZE;
+    }
+    packet[length] = crc8_block(CRC8_INIT, packet, length);
+    return length + STREAM_TRAILER;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file    teldump.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Prints the binary telemetry frames of inc/telemetry.h as text,
+  *          one line per frame, e.g. build/sim -f -d 5000 | build/teldump
+  *
+  *          teldump [file]
+  *
+  *          Reads stdin without a file. Shell text between the frames is
+  *          skipped, a frame with a bad CRC is printed as such and the
+  *          search for the next TELEMETRY_SYNC goes on after its sync byte.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "crc.h"
+#include "telemetry.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define FRAME_MAX (TELEMETRY_PAYLOAD_MAX + TELEMETRY_OVERHEAD)
+
+/* Little endian fields of the payloads */
+#define U16(p) ((uint16_t)((p)[0] | ((p)[1] << 8)))
+#define S16(p) ((int16_t)U16(p))
+#define U32(p) ((uint32_t)U16(p) | ((uint32_t)U16((p) + 2) << 16))
+
+/* Function prototypes -------------------------------------------------------*/
+static void print_frame(const uint8_t *frame);
+static void print_fixed(int16_t value);
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Main function.
+  */
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin;
+    uint8_t frame[FRAME_MAX];
+    int c, n = 0, length = 0, i;
+
+    if (argc > 1 && (in = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    while ((c = fgetc(in)) != EOF) {
+        if (n == 0 && c != TELEMETRY_SYNC) {
+            continue;
+        }
+        if (n == 2 && c > TELEMETRY_PAYLOAD_MAX) {
+            /* Not a header, look for the next sync after this one */
+            n = 0;
+            continue;
+        }
+        frame[n++] = (uint8_t)c;
+        if (n == 3) {
+            length = c + TELEMETRY_OVERHEAD;
+        }
+        if (n < 3 || n < length) {
+            continue;
+        }
+        n = 0;
+        if (crc16_block(CRC16_INIT, &frame[1], length - 1) == 0) {
+            print_frame(frame);
+            continue;
+        }
+        printf("bad crc:");
+        for (i = 0; i < length; i++) {
+            printf(" %02x", frame[i]);
+        }
+        printf("\n");
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+  * @brief One line per frame, values in their units.
+  */
+static void print_frame(const uint8_t *frame)
+{
+    const uint8_t *p = &frame[3];
+    uint8_t length = frame[2], i;
+
+    switch (frame[1]) {
+    case TELEMETRY_SAMPLE:
+        printf("sample ");
+        print_fixed(S16(p));
+        printf(" C ");
+        print_fixed(S16(p + 2));
+        printf(" %%\n");
+        break;
+    case TELEMETRY_DEVICE:
+        printf("device region %u 0x%02x ", p[0], p[1]);
+        print_fixed(S16(p + 2));
+        printf(" C\n");
+        break;
+    case TELEMETRY_SCAN:
+        printf("scan");
+        for (i = 0; i < length; i++) {
+            printf(" 0x%02x", p[i]);
+        }
+        printf("\n");
+        break;
+    case TELEMETRY_COUNTERS:
+        printf("counters uptime %lu ms frames %u swaps %u anim %u dropped %u "
+               "uart %u\n", (unsigned long)U32(p), U16(p + 4), p[6], p[7],
+               U16(p + 8), U16(p + 10));
+        break;
+    case TELEMETRY_ERRORS:
+        printf("errors");
+        for (i = 0; i + 4 <= length; i += 4) {
+            printf(" 0x%02x %u/%u", p[i], U16(p + i + 1), p[i + 3]);
+        }
+        printf("\n");
+        break;
+    default:
+        printf("type 0x%02x, %u bytes\n", frame[1], length);
+        break;
+    }
+}
+
+/**
+  * @brief Hundredths as a decimal number.
+  */
+static void print_fixed(int16_t value)
+{
+    int v = value < 0 ? -value : value;
+
+    printf("%s%d.%02d", value < 0 ? "-" : "", v / 100, v % 100);
+}
+
+/* END OF FILE ****************************************************************/
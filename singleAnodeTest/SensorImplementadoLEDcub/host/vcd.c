@@ -0,0 +1,369 @@
+/**
+  ******************************************************************************
+  * @file    vcd.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Value Change Dump of the simulated pins, TXD, SDA/SCL and the
+  *          74HC595 outputs.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "settings.h"
+#include "cube.h"
+#include "sim.h"
+#include "sr595.h"
+#include "vcd.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Signals: port pins first, identifier is '!' + signal */
+#define VCD_PINS    (SIM_PORTS * 8)
+#define VCD_SDA     (VCD_PINS + 0)
+#define VCD_SCL     (VCD_PINS + 1)
+#define VCD_TXD     (VCD_PINS + 2)
+#define VCD_GND1    (VCD_PINS + 3)
+#define VCD_OUTPUTS (VCD_PINS + 6)
+#define VCD_SIGNALS (VCD_PINS + 7)
+#define VCD_ID(signal) ((char)('!' + (signal)))
+#define VCD_PIN(port, pin) ((port) * 8 + (pin))
+
+/* Bits of TXD and TWI still to come */
+#define VCD_QUEUE_SIZE 256
+
+/* GND1..GND3 on outputs 21..23 of the chain, see src/cube.c */
+#define VCD_GND_OUTPUT 21
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint64_t cycles;
+    uint8_t signal;
+    uint8_t level;
+} vcd_change_t;
+
+/* Function prototypes -------------------------------------------------------*/
+static void vcd_header(void);
+static void vcd_var(uint8_t signal, const char *name);
+static void vcd_pins(uint8_t port, uint8_t old, uint8_t levels);
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+static void vcd_latch(uint32_t outputs, uint64_t cycles);
+#endif
+static void vcd_bus(uint8_t event, uint64_t start, uint16_t data,
+                    uint32_t bit_cycles);
+static void vcd_queue(uint64_t cycles, uint8_t signal, uint8_t level);
+static void vcd_drop(uint8_t signal);
+static void vcd_until(uint64_t cycles);
+static void vcd_time(uint64_t cycles);
+static void vcd_write(uint8_t signal, uint8_t level);
+
+/* Global variables ----------------------------------------------------------*/
+static FILE *vcd_file = NULL;
+static uint64_t vcd_now = 0;
+static uint8_t vcd_level[VCD_SIGNALS];
+
+/* Sorted by time, equal times in the order queued */
+static vcd_change_t vcd_changes[VCD_QUEUE_SIZE];
+static uint16_t vcd_queued = 0;
+
+static const char vcd_ports[SIM_PORTS] = {'B', 'C', 'D'};
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Create the dump.
+  */
+uint8_t vcd_init(const char *path)
+{
+    uint8_t port, pin;
+
+    vcd_file = fopen(path, "w");
+    if (vcd_file == NULL) {
+        perror(path);
+        return 1;
+    }
+    for (port = 0; port < SIM_PORTS; port++) {
+        for (pin = 0; pin < 8; pin++) {
+            vcd_level[VCD_PIN(port, pin)] = (sim_pins(port) >> pin) & 0x01;
+        }
+    }
+    /* Lines released, layers off */
+    vcd_level[VCD_SDA] = vcd_level[VCD_SCL] = vcd_level[VCD_TXD] = 1;
+    vcd_level[VCD_GND1] = vcd_level[VCD_GND1 + 1] = vcd_level[VCD_GND1 + 2] = 1;
+    vcd_header();
+
+    if (sim_on_pins(vcd_pins) || sim_on_bus(vcd_bus)) {
+        fprintf(stderr, "vcd: no listener free\n");
+        return 1;
+    }
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+    if (sr595_init() || sr595_on_latch(vcd_latch)) {
+        fprintf(stderr, "vcd: no listener free\n");
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+/**
+  * @brief Write what is queued and close the dump.
+  */
+void vcd_close(void)
+{
+    if (vcd_file == NULL) {
+        return;
+    }
+    vcd_until(UINT64_MAX);
+    vcd_time(sim_cycles() > vcd_now ? sim_cycles() : vcd_now);
+    fclose(vcd_file);
+    vcd_file = NULL;
+}
+
+/**
+  * @brief Declarations and initial values.
+  */
+static void vcd_header(void)
+{
+    static const char *const names[] = {"DATA_SHIFT", "CLK_SHIFT", "LATCH_SHIFT",
+                                        "GND1", "GND2", "GND3"};
+    time_t now = time(NULL);
+    char name[8];
+    uint8_t port, pin, i;
+
+    fprintf(vcd_file, "$date %.24s $end\n", ctime(&now));
+    fprintf(vcd_file, "$version sim, %s %s $end\n", __DATE__, __TIME__);
+    fprintf(vcd_file, "$timescale 1 ps $end\n");
+
+    fprintf(vcd_file, "$scope module ports $end\n");
+    for (port = 0; port < SIM_PORTS; port++) {
+        for (pin = 0; pin < 8; pin++) {
+            snprintf(name, sizeof(name), "P%c%u", vcd_ports[port], pin);
+            vcd_var(VCD_PIN(port, pin), name);
+        }
+    }
+    fprintf(vcd_file, "$upscope $end\n");
+
+    fprintf(vcd_file, "$scope module cube $end\n");
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+    vcd_var(VCD_PIN(SR595_DATA_PORT, SR595_DATA_PIN), names[0]);
+    vcd_var(VCD_PIN(SR595_CLK_PORT, SR595_CLK_PIN), names[1]);
+    vcd_var(VCD_PIN(SR595_LATCH_PORT, SR595_LATCH_PIN), names[2]);
+    for (i = 0; i < CUBE_LAYERS; i++) {
+        vcd_var(VCD_GND1 + i, names[3 + i]);
+    }
+    fprintf(vcd_file, "$var wire %u %c outputs [%u:0] $end\n", SR595_BITS,
+            VCD_ID(VCD_OUTPUTS), SR595_BITS - 1);
+#else
+    /* Layer pins PD4, PD3, PD2 */
+    for (i = 0; i < CUBE_LAYERS; i++) {
+        vcd_var(VCD_PIN(SIM_PORTD, 4 - i), names[3 + i]);
+    }
+#endif
+    fprintf(vcd_file, "$upscope $end\n");
+
+    fprintf(vcd_file, "$scope module twi $end\n");
+    vcd_var(VCD_SDA, "SDA");
+    vcd_var(VCD_SCL, "SCL");
+    fprintf(vcd_file, "$upscope $end\n");
+    fprintf(vcd_file, "$scope module uart $end\n");
+    vcd_var(VCD_TXD, "TXD");
+    fprintf(vcd_file, "$upscope $end\n");
+    fprintf(vcd_file, "$enddefinitions $end\n");
+
+    fprintf(vcd_file, "#0\n$dumpvars\n");
+    for (i = 0; i < VCD_GND1; i++) {
+        fprintf(vcd_file, "%u%c\n", vcd_level[i], VCD_ID(i));
+    }
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+    for (i = VCD_GND1; i < VCD_GND1 + CUBE_LAYERS; i++) {
+        fprintf(vcd_file, "%u%c\n", vcd_level[i], VCD_ID(i));
+    }
+    fprintf(vcd_file, "b0 %c\n", VCD_ID(VCD_OUTPUTS));
+#endif
+    fprintf(vcd_file, "$end\n");
+}
+
+/**
+  * @brief Declare a 1-bit signal.
+  */
+static void vcd_var(uint8_t signal, const char *name)
+{
+    fprintf(vcd_file, "$var wire 1 %c %s $end\n", VCD_ID(signal), name);
+}
+
+/**
+  * @brief Pin listener.
+  */
+static void vcd_pins(uint8_t port, uint8_t old, uint8_t levels)
+{
+    uint8_t pin;
+
+    vcd_until(sim_cycles());
+    for (pin = 0; pin < 8; pin++) {
+        if ((old ^ levels) & (1 << pin)) {
+            vcd_time(sim_cycles());
+            vcd_write(VCD_PIN(port, pin), (levels >> pin) & 0x01);
+        }
+    }
+}
+
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+/**
+  * @brief Latch listener: outputs and the layer GNDs.
+  */
+static void vcd_latch(uint32_t outputs, uint64_t cycles)
+{
+    char bits[SR595_BITS + 1];
+    uint8_t i;
+
+    vcd_until(cycles);
+    vcd_time(cycles);
+    for (i = 0; i < SR595_BITS; i++) {
+        bits[i] = (outputs >> (SR595_BITS - 1 - i)) & 0x01 ? '1' : '0';
+    }
+    bits[SR595_BITS] = '\0';
+    fprintf(vcd_file, "b%s %c\n", bits, VCD_ID(VCD_OUTPUTS));
+    for (i = 0; i < CUBE_LAYERS; i++) {
+        vcd_write(VCD_GND1 + i, (outputs >> (VCD_GND_OUTPUT + i)) & 0x01);
+    }
+}
+#endif
+
+/**
+  * @brief Bus listener: queue the bits of a byte or condition.
+  */
+static void vcd_bus(uint8_t event, uint64_t start, uint16_t data,
+                    uint32_t bit_cycles)
+{
+    uint64_t t;
+    uint8_t i, level;
+
+    switch (event) {
+    case SIM_BUS_TXD:
+        /* Start bit, LSB first, stop bit */
+        vcd_queue(start, VCD_TXD, 0);
+        for (i = 0; i < 8; i++) {
+            vcd_queue(start + (i + 1) * bit_cycles, VCD_TXD, (data >> i) & 0x01);
+        }
+        vcd_queue(start + 9 * bit_cycles, VCD_TXD, 1);
+        break;
+
+    case SIM_BUS_TWI_START:
+        /* SDA falls while SCL is high, from idle or after a byte */
+        vcd_queue(start, VCD_SDA, 1);
+        vcd_queue(start + bit_cycles / 4, VCD_SCL, 1);
+        vcd_queue(start + bit_cycles / 2, VCD_SDA, 0);
+        vcd_queue(start + bit_cycles, VCD_SCL, 0);
+        break;
+
+    case SIM_BUS_TWI_BYTE:
+        /* MSB first, then the acknowledge, SDA changes while SCL is low */
+        for (i = 0; i < 9; i++) {
+            t = start + (uint64_t)i * bit_cycles;
+            level = i < 8 ? (data >> (7 - i)) & 0x01 : (data & SIM_BUS_NACK) != 0;
+            vcd_queue(t, VCD_SDA, level);
+            vcd_queue(t + bit_cycles / 2, VCD_SCL, 1);
+            vcd_queue(t + bit_cycles, VCD_SCL, 0);
+        }
+        break;
+
+    case SIM_BUS_TWI_STOP:
+        /* SDA rises while SCL is high */
+        vcd_queue(start, VCD_SDA, 0);
+        vcd_queue(start + bit_cycles / 4, VCD_SCL, 1);
+        vcd_queue(start + bit_cycles / 2, VCD_SDA, 1);
+        break;
+
+    case SIM_BUS_TWI_IDLE:
+        /* Bits of an aborted byte never come */
+        vcd_drop(VCD_SDA);
+        vcd_drop(VCD_SCL);
+        vcd_queue(start, VCD_SDA, 1);
+        vcd_queue(start, VCD_SCL, 1);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+  * @brief Insert a change behind those of the same time or earlier.
+  */
+static void vcd_queue(uint64_t cycles, uint8_t signal, uint8_t level)
+{
+    uint16_t i;
+
+    if (vcd_queued == VCD_QUEUE_SIZE) {
+        /* Cannot happen with one TXD and one TWI byte at a time */
+        vcd_until(vcd_changes[0].cycles);
+    }
+    for (i = vcd_queued; i > 0 && vcd_changes[i - 1].cycles > cycles; i--) {
+        vcd_changes[i] = vcd_changes[i - 1];
+    }
+    vcd_changes[i].cycles = cycles;
+    vcd_changes[i].signal = signal;
+    vcd_changes[i].level = level;
+    vcd_queued++;
+}
+
+/**
+  * @brief Remove the queued changes of a signal.
+  */
+static void vcd_drop(uint8_t signal)
+{
+    uint16_t i, kept = 0;
+
+    for (i = 0; i < vcd_queued; i++) {
+        if (vcd_changes[i].signal != signal) {
+            vcd_changes[kept++] = vcd_changes[i];
+        }
+    }
+    vcd_queued = kept;
+}
+
+/**
+  * @brief Write the queued changes up to a time.
+  */
+static void vcd_until(uint64_t cycles)
+{
+    uint16_t done = 0;
+
+    while (done < vcd_queued && vcd_changes[done].cycles <= cycles) {
+        vcd_time(vcd_changes[done].cycles);
+        vcd_write(vcd_changes[done].signal, vcd_changes[done].level);
+        done++;
+    }
+    if (done) {
+        memmove(vcd_changes, vcd_changes + done,
+                (vcd_queued - done) * sizeof(vcd_changes[0]));
+        vcd_queued -= done;
+    }
+}
+
+/**
+  * @brief Time stamp, never back in time: a byte may start a few cycles
+  *        before the step that reports it.
+  */
+static void vcd_time(uint64_t cycles)
+{
+    if (cycles > vcd_now) {
+        vcd_now = cycles;
+        fprintf(vcd_file, "#%" PRIu64 "\n",
+                (uint64_t)(vcd_now * VCD_PS_PER_CYCLE));
+    }
+}
+
+/**
+  * @brief Value change of a 1-bit signal.
+  */
+static void vcd_write(uint8_t signal, uint8_t level)
+{
+    if (vcd_level[signal] != level) {
+        vcd_level[signal] = level;
+        fprintf(vcd_file, "%u%c\n", level, VCD_ID(signal));
+    }
+}
+
+/* END OF FILE ****************************************************************/
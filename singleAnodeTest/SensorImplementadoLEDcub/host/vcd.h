@@ -0,0 +1,51 @@
+#ifndef VCD_H_INCLUDED
+#define VCD_H_INCLUDED
+
+/**
+ *  @file vcd.h
+ *  @code #include "vcd.h" @endcode
+ *
+ *  @brief Value Change Dump of the simulated pins, for GTKWave and for
+ *         diffs between firmware revisions.
+ *
+ *  Scopes of the dump:
+ *     - ports: every pin of ports B, C and D
+ *     - cube: DATA_SHIFT, CLK_SHIFT, LATCH_SHIFT, GND1..GND3 and the 24
+ *       74HC595 outputs with CUBE_DRIVER_SR595 (sr595.h), the layer pins
+ *       GND1..GND3 with CUBE_DRIVER_DIRECT
+ *     - twi: SDA and SCL
+ *     - uart: TXD
+ *
+ *  Names in the cube scope are the port pins under a second name. SDA, SCL
+ *  and TXD are drawn from the bytes of sim_on_bus(): 8N1 on TXD, start,
+ *  nine clocks per byte and stop on the TWI lines. A slave holding SDA low
+ *  is not drawn.
+ *
+ *  Time stamps are in ps, VCD_PS_PER_CYCLE per CPU cycle.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Resolution of the dump.
+ */
+#define VCD_PS_PER_CYCLE (1000000000000ULL / F_CPU)
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Create the dump and follow the pins.
+ *  @param path - Output file
+ *  @return 0, 1 on error, printed to stderr
+ */
+uint8_t vcd_init(const char *path);
+
+/**
+ *  @brief Write the bits still to come on TXD and TWI and close the dump.
+ */
+void vcd_close(void);
+
+#endif /* VCD_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,66 @@
+#ifndef ANIM_H_INCLUDED
+#define ANIM_H_INCLUDED
+
+/**
+ *  @file anim.h
+ *  @code #include <anim.h> @endcode
+ *
+ *  @brief Non-blocking player of the cube animations stored in flash.
+ *
+ *  Each animation is a sequence of frames with a display time. anim_task()
+ *  draws the next frame into the cube back buffer and swaps it in when the
+ *  display time of the current frame has elapsed, so the main loop keeps
+ *  running the other tasks while an animation is shown.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "hal.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Animation ids.
+ *     - ANIM_NONE: player stopped, the framebuffer is left to other writers
+ *     - ANIM_LAYERS: one full layer at a time, shifting up (was TestAnimation1)
+ *     - ANIM_SLICES: vertical slices shifting to the side (was TestAnimation2)
+ */
+#define ANIM_NONE   0
+#define ANIM_LAYERS 1
+#define ANIM_SLICES 2
+
+/**
+ *  @brief Number of animation ids, including ANIM_NONE.
+ */
+#define ANIM_COUNT  3
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Start an animation from its first frame.
+ *  @param id - ANIM_x, invalid ids stop the player
+ */
+void anim_start(uint8_t id);
+
+/**
+ *  @brief Animation being played.
+ *  @return ANIM_x
+ */
+uint8_t anim_current(void);
+
+/**
+ *  @brief Name of an animation, e.g. for a command line.
+ *  @param id - ANIM_x
+ *  @return String in program memory, NULL for invalid ids
+ */
+PGM_P anim_name(uint8_t id);
+
+/**
+ *  @brief Show the next frame when the current one has been shown long enough.
+ *  @retval 1 - The last frame has just ended, the animation restarts unless
+ *              another one is started
+ *  @retval 0 - Otherwise
+ */
+uint8_t anim_task(void);
+
+#endif /* ANIM_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
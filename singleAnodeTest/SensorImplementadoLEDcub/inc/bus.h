@@ -0,0 +1,67 @@
+#ifndef BUS_H_INCLUDED
+#define BUS_H_INCLUDED
+
+/**
+ *  @file bus.h
+ *  @code #include <bus.h> @endcode
+ *
+ *  @brief Arbiter for the pins the LCD shares with the 74HC595 chain.
+ *
+ *  | Pin | LCD (lcd_definitions.h) | 74HC595 (CUBE_DRIVER_SR595)     |
+ *  |-----|-------------------------|---------------------------------|
+ *  | PD4 | D4                      | LATCH_SHIFT, rising edge latches|
+ *  | PD7 | D7                      | CLK_SHIFT, rising edge shifts   |
+ *  | PB0 | RS                      | DATA_SHIFT                      |
+ *  | PB1 | E, falling edge latches | -                               |
+ *
+ *  Each device only acts on its own edges, so the pins are time
+ *  multiplexed between them:
+ *     - The LCD ignores the shift register traffic because E stays low
+ *       outside lcd_tick().
+ *     - lcd_tick() runs in the Timer/Counter0 interrupt and the refresh in
+ *       the Timer/Counter2 interrupts. AVR interrupts do not nest, so an LCD
+ *       transfer always falls between two refresh shifts and never splits
+ *       one.
+ *     - An LCD nibble may clock garbage into the shift registers on D7, it
+ *       only reaches the LEDs if D4 then latches it. Before D4 rises after
+ *       such a clock, bus_lcd_nibble() shifts the word on the outputs in
+ *       again (cube_reload()), so the latch copies what is shown already.
+ *       The next refresh shifts a complete word and flushes the rest.
+ *
+ *  The direct driver uses PB1 as a column and cannot share it with E.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "cube.h"
+#include "display.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief 1 if the LCD and the 74HC595 chain share pins.
+ */
+#define BUS_SHARED (DISPLAY_ENABLE && CUBE_DRIVER == CUBE_DRIVER_SR595)
+
+#if DISPLAY_ENABLE && CUBE_DRIVER == CUBE_DRIVER_DIRECT
+# error "The LCD needs CUBE_DRIVER_SR595, the direct driver drives E (PB1)"
+#endif
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Put a nibble and RS on the LCD lines without a visible latch of
+ *         the 74HC595 chain. E is pulsed by the caller.
+ *  @param nibble - D7..D4 in bits 3..0
+ *  @param rs - 1: data, 0: instruction
+ *  @note Call from the interrupt that runs lcd_tick().
+ */
+void bus_lcd_nibble(uint8_t nibble, uint8_t rs);
+
+/**
+ *  @brief Return the shared lines to the idle levels of the 74HC595 chain,
+ *         CLK_SHIFT and LATCH_SHIFT low.
+ */
+void bus_lcd_release(void);
+
+#endif /* BUS_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,51 @@
+#ifndef CONFIG_H_INCLUDED
+#define CONFIG_H_INCLUDED
+
+/**
+ *  @file config.h
+ *  @code #include <config.h> @endcode
+ *
+ *  @brief Run-time settings kept in EEPROM.
+ *
+ *  Brightness, refresh rate, animation threshold and fixed animation are
+ *  stored together with a CRC-16 (crc.h). A record with a wrong CRC or
+ *  version, e.g. an erased EEPROM or a save interrupted by a reset, is
+ *  ignored and the compiled-in defaults stay in effect. The refresh rate is
+ *  stored as requested and checked by cube_set_rate() when loaded, a rate
+ *  out of range keeps the default and is reported by config_load().
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Layout version of the record, increment when it changes.
+ */
+#define CONFIG_VERSION 1
+
+/**
+ *  @brief Results of config_load().
+ */
+#define CONFIG_DEFAULTS 0 /**< No valid record, defaults kept */
+#define CONFIG_APPLIED  1 /**< Settings applied */
+#define CONFIG_RATE_BAD 2 /**< Applied, but the rate was out of range and
+                               CUBE_RATE_DEFAULT is kept */
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Apply the settings stored in EEPROM.
+ *  @return CONFIG_DEFAULTS, CONFIG_APPLIED or CONFIG_RATE_BAD
+ *  @note Call after cube_init().
+ */
+uint8_t config_load(void);
+
+/**
+ *  @brief Store the current settings, only changed bytes are written.
+ *  @note Waits about 3.4 ms per changed byte for the EEPROM.
+ */
+void config_save(void);
+
+#endif /* CONFIG_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
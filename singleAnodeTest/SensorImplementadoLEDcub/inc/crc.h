@@ -0,0 +1,88 @@
+#ifndef CRC_H_INCLUDED
+#define CRC_H_INCLUDED
+
+/**
+ *  @file crc.h
+ *  @code #include <crc.h> @endcode
+ *
+ *  @brief Table driven CRC-8 and CRC-16 shared by the telemetry frames, the
+ *         frame stream and the settings stored in EEPROM.
+ *
+ *     - CRC-8: polynomial 0x07, MSB first, no final XOR (CRC-8/SMBUS when
+ *       started with CRC8_INIT), check value 0xf4
+ *     - CRC-16: polynomial 0x1021, MSB first, no final XOR
+ *       (CRC-16/CCITT-FALSE when started with CRC16_INIT), check value 0x29b1
+ *
+ *  Both are computed with a lookup table in program memory, selected with
+ *  CRC_TABLE:
+ *     - CRC_TABLE_NIBBLE: 16 entries per CRC, 16 + 32 bytes of flash, two
+ *       lookups per byte
+ *     - CRC_TABLE_FULL: 256 entries per CRC, 256 + 512 bytes of flash, one
+ *       lookup per byte
+ *
+ *  Running a CRC over a message followed by its own CRC (high byte first for
+ *  CRC-16) gives 0, which receivers use to check a frame in one pass.
+ *
+ *  With CRC_ALL_TABLES defined both flavours are built under their own names,
+ *  for host/crcbench.c.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Table flavours.
+ */
+#define CRC_TABLE_NIBBLE 0
+#define CRC_TABLE_FULL   1
+
+#ifndef CRC_TABLE
+# define CRC_TABLE CRC_TABLE_NIBBLE
+#endif
+
+/**
+ *  @brief Start values.
+ */
+#define CRC8_INIT  0x00
+#define CRC16_INIT 0xffff
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Add one byte to a CRC-8.
+ *  @param crc - CRC so far, CRC8_INIT for the first byte
+ *  @param data - Next byte
+ *  @return Updated CRC
+ */
+uint8_t crc8_update(uint8_t crc, uint8_t data);
+
+/**
+ *  @brief Add a block of bytes to a CRC-8.
+ */
+uint8_t crc8_block(uint8_t crc, const void *data, uint16_t length);
+
+/**
+ *  @brief Add one byte to a CRC-16.
+ *  @param crc - CRC so far, CRC16_INIT for the first byte
+ *  @param data - Next byte
+ *  @return Updated CRC
+ */
+uint16_t crc16_update(uint16_t crc, uint8_t data);
+
+/**
+ *  @brief Add a block of bytes to a CRC-16.
+ */
+uint16_t crc16_block(uint16_t crc, const void *data, uint16_t length);
+
+/**
+ *  @brief Single flavours, only built for the selected CRC_TABLE or for all
+ *         with CRC_ALL_TABLES.
+ */
+uint8_t crc8_update_nibble(uint8_t crc, uint8_t data);
+uint8_t crc8_update_full(uint8_t crc, uint8_t data);
+uint16_t crc16_update_nibble(uint16_t crc, uint8_t data);
+uint16_t crc16_update_full(uint16_t crc, uint8_t data);
+
+#endif /* CRC_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
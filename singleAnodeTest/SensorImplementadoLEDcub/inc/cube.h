@@ -0,0 +1,197 @@
+#ifndef CUBE_H_INCLUDED
+#define CUBE_H_INCLUDED
+
+/**
+ *  @file cube.h
+ *  @code #include <cube.h> @endcode
+ *
+ *  @brief Double buffered framebuffer of the 3x3x3 LED cube with a
+ *         multiplexing refresh on Timer/Counter2.
+ *
+ *  The front buffer is shown by the refresh interrupt one layer per
+ *  millisecond (333 Hz frame rate), the back buffer is drawn by the
+ *  application, the animation player, a TWI master or the UART stream and
+ *  becomes visible with cube_swap(). The compare B interrupt blanks the layer
+ *  early to dim the whole cube.
+ *
+ *  A buffer holds either a binary frame (cube_back()) or CUBE_BAM_BITS bit
+ *  planes with 16 brightness levels per LED (cube_back_planes()). Planes are
+ *  shown with bit angle modulation: plane n stays on for CUBE_BAM_UNIT << n
+ *  timer ticks of each layer slot. The global brightness only applies to
+ *  binary frames.
+ *
+ *  Two output stages are supported, selected with CUBE_DRIVER:
+ *     - CUBE_DRIVER_DIRECT: single colour cube of this project, columns on
+ *       PB0..PB5 and PD5..PD7, layers on PD4, PD3, PD2 (active low). Both
+ *       colour planes are shown together.
+ *     - CUBE_DRIVER_SR595: red/green cube behind three 74HC595 as wired in
+ *       WithShiftRegister74hc595 (DATA PB0, CLK PD7, LATCH PD4).
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Output stages.
+ */
+#define CUBE_DRIVER_DIRECT 0
+#define CUBE_DRIVER_SR595  1
+
+#ifndef CUBE_DRIVER
+# define CUBE_DRIVER CUBE_DRIVER_DIRECT
+#endif
+
+/**
+ *  @brief Cube dimensions. Column n of a layer is bit n of its mask,
+ *         column = 3 * row + position in the row.
+ */
+#define CUBE_LAYERS  3
+#define CUBE_COLUMNS 9
+#define CUBE_COLOURS 2
+
+/**
+ *  @brief Colour planes.
+ */
+#define CUBE_RED   0
+#define CUBE_GREEN 1
+
+/**
+ *  @brief Mask with every column of a layer on.
+ */
+#define CUBE_ALL_COLUMNS 0x01ff
+
+/**
+ *  @brief Size of one frame in bytes, e.g. for the TWI register map.
+ */
+#define CUBE_FRAME_SIZE (CUBE_LAYERS * CUBE_COLOURS * 2)
+
+/**
+ *  @brief Default brightness, 255 = layer on for the whole slot.
+ */
+#define CUBE_BRIGHTNESS_MAX 255
+
+/**
+ *  @brief Refresh rates of binary frames in Hz, see cube_set_rate(). The
+ *         default is one layer per millisecond, the maximum leaves 150 us per
+ *         layer for the output stage. Grey scale frames always use the
+ *         default slot.
+ */
+#define CUBE_RATE_DEFAULT 333
+#define CUBE_RATE_MIN     326
+#define CUBE_RATE_MAX     2000
+
+/**
+ *  @brief Number of bit planes of a grey scale frame, 16 levels.
+ */
+#define CUBE_BAM_BITS 4
+
+/**
+ *  @brief Display time of the least significant plane in timer ticks (4 us),
+ *         the four planes fill 240 of the 250 ticks of a layer slot.
+ */
+#define CUBE_BAM_UNIT 16
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief One frame: a column mask per layer and colour.
+ *  @note Byte n of the frame in memory (little endian) is register n of the
+ *        TWI register map.
+ */
+typedef struct {
+    uint16_t column[CUBE_LAYERS][CUBE_COLOURS];
+} cube_frame_t;
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Configure the output pins, clear both buffers and start the
+ *         refresh on Timer/Counter2.
+ *  @note Interrupts must be enabled globally by the caller (sei).
+ */
+void cube_init(void);
+
+/**
+ *  @brief Binary frame being drawn, not visible until cube_swap().
+ *  @note After a swap the back buffer holds a copy of the new front buffer,
+ *        so partial updates can be drawn on top of it. Marks the back buffer
+ *        as binary frame.
+ */
+cube_frame_t *cube_back(void);
+
+/**
+ *  @brief Bit planes of the grey scale frame being drawn, plane 0 is the
+ *         least significant one.
+ *  @return Array of CUBE_BAM_BITS frames
+ *  @note Marks the back buffer as grey scale frame.
+ */
+cube_frame_t *cube_back_planes(void);
+
+/**
+ *  @brief Show the back buffer.
+ *  @note Safe to call from an interrupt.
+ */
+void cube_swap(void);
+
+/**
+ *  @brief Copy of the frame being shown, grey scale frames reduced to LEDs
+ *         on or off.
+ *  @param frame - Destination
+ */
+void cube_get_front(cube_frame_t *frame);
+
+/**
+ *  @brief Clear the back buffer.
+ */
+void cube_clear(void);
+
+/**
+ *  @brief Set the global brightness.
+ *  @param brightness - 0 (off) .. CUBE_BRIGHTNESS_MAX
+ */
+void cube_set_brightness(uint8_t brightness);
+
+/**
+ *  @brief Current global brightness.
+ */
+uint8_t cube_get_brightness(void);
+
+/**
+ *  @brief Set the refresh rate of binary frames, the nearest one the layer
+ *         slot can make within CUBE_RATE_MIN .. CUBE_RATE_MAX, e.g. 1984 Hz
+ *         for 2000 Hz.
+ *  @param rate - Frames per second, CUBE_RATE_MIN .. CUBE_RATE_MAX
+ *  @retval 0 - Success
+ *  @retval 1 - Rate out of range, nothing changed
+ */
+uint8_t cube_set_rate(uint16_t rate);
+
+/**
+ *  @brief Refresh rate of binary frames in Hz, rounded to the nearest.
+ *         Always within CUBE_RATE_MIN .. CUBE_RATE_MAX, cube_set_rate() of
+ *         it keeps the slot.
+ */
+uint16_t cube_get_rate(void);
+
+/**
+ *  @brief Rate last accepted by cube_set_rate(), as requested, e.g. to
+ *         store it. CUBE_RATE_DEFAULT before the first call.
+ */
+uint16_t cube_get_rate_setting(void);
+
+/**
+ *  @brief Number of swaps since cube_init(), wraps at 256.
+ */
+uint8_t cube_frame_count(void);
+
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+/**
+ *  @brief Shift the word on the 74HC595 outputs into the shift registers
+ *         again, without latching it.
+ *  @note For the pin arbiter (bus.h) only, call with interrupts disabled.
+ */
+void cube_reload(void);
+#endif
+
+#endif /* CUBE_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,105 @@
+#ifndef DISPLAY_H_INCLUDED
+#define DISPLAY_H_INCLUDED
+
+/**
+ *  @file display.h
+ *  @code #include <display.h> @endcode
+ *
+ *  @brief Shadow buffer for the HD44780 character LCD.
+ *
+ *  Text is written into a RAM copy of the LCD_LINES x LCD_DISP_LENGTH
+ *  display, which costs no LCD access. display_task() compares it with
+ *  what the LCD shows and queues only the cells that differ; lcd_tick()
+ *  sends one byte per millisecond from the Timer/Counter0 interrupt, so
+ *  the controller always had time to execute the previous one and nothing
+ *  waits for it. Consecutive changed cells need no address command as the
+ *  LCD moves its cursor by itself.
+ *
+ *  Redrawing a whole screen every refresh is therefore cheap: clearing the
+ *  shadow and printing the same text again sends nothing, a temperature
+ *  that changes in its last digit sends one or two bytes.
+ *
+ *  @note The LCD Keypad Shield uses PD4..PD7, PB0 and PB1, see
+ *        lcd_definitions.h. It runs together with CUBE_DRIVER_SR595, which
+ *        shares PD4, PD7 and PB0 through the arbiter in bus.h.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "lcd.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Show a live readout and the layer preview (preview.h) on the LCD,
+ *         e.g. make CDEFS="-DDISPLAY_ENABLE=1 -DCUBE_DRIVER=1".
+ */
+#ifndef DISPLAY_ENABLE
+# define DISPLAY_ENABLE 0
+#endif
+
+/**
+ *  @brief User glyphs in the CGRAM, shown by the characters 0 .. 7, and
+ *         their rows of 5 pixels.
+ */
+#define DISPLAY_GLYPHS     8
+#define DISPLAY_GLYPH_ROWS 8
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Queue the LCD initialization and clear the shadow.
+ *  @note Returns at once, the LCD is ready about 30 ms after timer_init().
+ */
+void display_init(void);
+
+/**
+ *  @brief Fill the shadow with spaces and move its cursor home.
+ */
+void display_clear(void);
+
+/**
+ *  @brief Move the cursor of the shadow.
+ *  @param x - Column, 0 .. LCD_DISP_LENGTH - 1
+ *  @param y - Line, 0 .. LCD_LINES - 1
+ */
+void display_gotoxy(uint8_t x, uint8_t y);
+
+/**
+ *  @brief Write a character at the cursor of the shadow.
+ *  @param c - Character, '\n' continues on the next line
+ *  @note Characters beyond the end of a line are dropped.
+ */
+void display_putc(char c);
+
+/**
+ *  @brief Write a string at the cursor of the shadow.
+ */
+void display_puts(const char *s);
+
+/**
+ *  @brief Write a string from program memory at the cursor of the shadow.
+ */
+void display_puts_p(const char *progmem_s);
+
+/**
+ *  @brief Define a user glyph. The CGRAM is only rewritten if the glyph
+ *         differs from its last definition.
+ *  @param index - Glyph, 0 .. DISPLAY_GLYPHS - 1
+ *  @param rows - DISPLAY_GLYPH_ROWS rows, top first, bit 4 is the leftmost
+ *                pixel
+ */
+void display_glyph(uint8_t index, const uint8_t *rows);
+
+/**
+ *  @brief Number of changed cells not queued yet.
+ */
+uint8_t display_pending(void);
+
+/**
+ *  @brief Queue changed glyphs and cells while the LCD queue has room.
+ *  @note Call from the main loop.
+ */
+void display_task(void);
+
+#endif /* DISPLAY_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
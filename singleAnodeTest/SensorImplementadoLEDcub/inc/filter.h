@@ -0,0 +1,83 @@
+#ifndef FILTER_H_INCLUDED
+#define FILTER_H_INCLUDED
+
+/**
+ *  @file filter.h
+ *  @code #include <filter.h> @endcode
+ *
+ *  @brief Integer-only filtering of DHT12 readings (median + EMA).
+ *
+ *  Each reading is converted to Q8.8 fixed point, passed through a short
+ *  median filter that rejects single-sample spikes and then through an
+ *  exponential moving average with alpha = 1/2^FILTER_EMA_SHIFT. The result
+ *  is returned in hundredths (centi-degrees or centi-percent) as int16_t.
+ *  No division and no floating point is used.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Length of the median window, 3 or 5 samples.
+ */
+#ifndef FILTER_MEDIAN_LEN
+# define FILTER_MEDIAN_LEN 3
+#endif
+
+#if (FILTER_MEDIAN_LEN != 3) && (FILTER_MEDIAN_LEN != 5)
+# error "FILTER_MEDIAN_LEN must be 3 or 5"
+#endif
+
+/**
+ *  @brief EMA smoothing factor, alpha = 1 / 2^FILTER_EMA_SHIFT.
+ */
+#ifndef FILTER_EMA_SHIFT
+# define FILTER_EMA_SHIFT 2
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief State of one filter channel. All values are Q8.8.
+ */
+typedef struct {
+    int16_t window[FILTER_MEDIAN_LEN];  /**< Last raw samples */
+    uint8_t index;                      /**< Next slot of window */
+    uint8_t primed;                     /**< 0 until the first sample */
+    int16_t ema;                        /**< Filter output */
+} filter_t;
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Reset a filter channel.
+ *  @param f - Filter channel
+ */
+void filter_init(filter_t *f);
+
+/**
+ *  @brief Convert a DHT12 integer/decimal register pair to Q8.8.
+ *  @param integer - Integer part register
+ *  @param decimal - Decimal part register, tenths in bits 6..0, sign in bit 7
+ *  @return Value in Q8.8 fixed point
+ */
+int16_t filter_dht12_to_q8(uint8_t integer, uint8_t decimal);
+
+/**
+ *  @brief Feed one raw sample through median and EMA.
+ *  @param f - Filter channel
+ *  @param sample - New sample in Q8.8
+ *  @return Filtered value in hundredths
+ *  @note The first sample primes the whole median window and the EMA.
+ */
+int16_t filter_update(filter_t *f, int16_t sample);
+
+/**
+ *  @brief Convert a Q8.8 value to hundredths, rounded.
+ *  @param q8 - Value in Q8.8
+ *  @return Value in hundredths, e.g. 2740 for 27.4
+ */
+int16_t filter_q8_to_centi(int16_t q8);
+
+#endif /* FILTER_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,72 @@
+#ifndef FMT_H_INCLUDED
+#define FMT_H_INCLUDED
+
+/**
+ *  @file fmt.h
+ *  @code #include <fmt.h> @endcode
+ *
+ *  @brief Integer formatting straight into the UART transmit ringbuffer.
+ *
+ *  Replaces itoa()/ltoa() and stdio for console output. Digits are found
+ *  most significant first by subtracting powers of ten taken from program
+ *  memory, so no string buffer and no 32 bit division routine is needed.
+ *  make size compares the flash of this module with the same conversions
+ *  done by ltoa()/ultoa().
+ *
+ *  @code
+ *      fmt_fixed(274, 1);      // 27.4
+ *      fmt_fixed(-5, 2);       // -0.05
+ *      fmt_hex(0x5c, 2);       // 5c
+ *  @endcode
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Most decimals fmt_fixed() can print.
+ */
+#define FMT_DECIMALS_MAX 9
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief Character output of fmt_fixed_to().
+ */
+typedef void (*fmt_putc_t)(char c);
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Print an unsigned decimal number.
+ */
+void fmt_udec(uint32_t value);
+
+/**
+ *  @brief Print a signed decimal number.
+ */
+void fmt_dec(int32_t value);
+
+/**
+ *  @brief Print a fixed-point number.
+ *  @param value - Number in units of 10^-decimals, e.g. 2345 centi-degrees
+ *  @param decimals - Digits after the point, 0 .. FMT_DECIMALS_MAX
+ */
+void fmt_fixed(int32_t value, uint8_t decimals);
+
+/**
+ *  @brief Print a fixed-point number through another output than the UART,
+ *         e.g. fmt_fixed_to(display_putc, 274, 1).
+ */
+void fmt_fixed_to(fmt_putc_t put, int32_t value, uint8_t decimals);
+
+/**
+ *  @brief Print the low digits of a number in lower case hexadecimal,
+ *         without prefix.
+ *  @param value - Number
+ *  @param digits - Digits to print, 1 .. 8, leading zeros included
+ */
+void fmt_hex(uint32_t value, uint8_t digits);
+
+#endif /* FMT_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
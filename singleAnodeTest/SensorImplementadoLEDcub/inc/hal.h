@@ -0,0 +1,302 @@
+#ifndef HAL_H_INCLUDED
+#define HAL_H_INCLUDED
+
+/**
+ *  @file hal.h
+ *  @code #include <hal.h> @endcode
+ *
+ *  @brief Register access of the drivers, on the ATmega328P and in the host
+ *         simulator (host/sim.c).
+ *
+ *  Drivers access I/O registers through HAL_READ(), HAL_WRITE(), HAL_SET()
+ *  and HAL_CLEAR() only:
+ *     - avr-gcc: the macros expand to the plain register expressions, e.g.
+ *       HAL_SET(PORTD, _BV(PD7)) is PORTD |= _BV(PD7), so the code in
+ *       build/DEMO.lss is the same as without the HAL.
+ *     - Host gcc: register names are data space addresses and every access
+ *       calls the simulator through hal_host, which advances the virtual
+ *       clock and runs the interrupts that became due.
+ *
+ *  The host part also maps the avr-libc interfaces the application uses:
+ *  ISR(), sei()/cli(), ATOMIC_BLOCK(), _delay_us()/_delay_ms(), program
+ *  memory and EEPROM access.
+ *
+ *  @note A busy wait on a variable an interrupt changes must call
+ *        HAL_WAIT(), on the host the interrupt cannot run otherwise.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include <stdint.h>
+
+#ifdef __AVR__
+# include <avr/io.h>
+# include <avr/interrupt.h>
+# include <avr/pgmspace.h>
+# include <avr/eeprom.h>
+# include <util/atomic.h>
+# include <util/delay.h>
+#else
+# include <string.h>
+#endif
+
+/* Constants and macros ------------------------------------------------------*/
+#ifdef __AVR__
+/**
+ *  @brief Read an I/O register.
+ */
+# define HAL_READ(reg) (reg)
+
+/**
+ *  @brief Write an I/O register.
+ */
+# define HAL_WRITE(reg, value) ((reg) = (value))
+
+/**
+ *  @brief Set bits of an I/O register, sbi for the lower I/O space.
+ */
+# define HAL_SET(reg, mask) ((reg) |= (mask))
+
+/**
+ *  @brief Clear bits of an I/O register, cbi for the lower I/O space.
+ */
+# define HAL_CLEAR(reg, mask) ((reg) &= ~(mask))
+
+/**
+ *  @brief Data direction and input register of a port register.
+ */
+# define HAL_DDR(port) (*(&(port) - 1))
+# define HAL_PIN(port) (*(&(port) - 2))
+
+/**
+ *  @brief 1 if both names are the same register.
+ */
+# define HAL_SAME(reg1, reg2) (&(reg1) == &(reg2))
+
+/**
+ *  @brief Body of a busy wait on an interrupt.
+ */
+# define HAL_WAIT()
+
+#else /* Host */
+/* Data space addresses of the ATmega328P registers */
+# define PINB   0x23
+# define DDRB   0x24
+# define PORTB  0x25
+# define PINC   0x26
+# define DDRC   0x27
+# define PORTC  0x28
+# define PIND   0x29
+# define DDRD   0x2a
+# define PORTD  0x2b
+# define TIFR0  0x35
+# define TIFR2  0x37
+# define TCCR0A 0x44
+# define TCCR0B 0x45
+# define TCNT0  0x46
+# define OCR0A  0x47
+# define OCR0B  0x48
+# define SREG   0x5f
+# define TIMSK0 0x6e
+# define TIMSK2 0x70
+# define TCCR2A 0xb0
+# define TCCR2B 0xb1
+# define TCNT2  0xb2
+# define OCR2A  0xb3
+# define OCR2B  0xb4
+# define TWBR   0xb8
+# define TWSR   0xb9
+# define TWAR   0xba
+# define TWDR   0xbb
+# define TWCR   0xbc
+# define UCSR0A 0xc0
+# define UCSR0B 0xc1
+# define UCSR0C 0xc2
+# define UBRR0L 0xc4
+# define UBRR0H 0xc5
+# define UDR0   0xc6
+# define RAMEND 0x8ff
+
+/* Register bits */
+# define PB0 0
+# define PB1 1
+# define PB2 2
+# define PB3 3
+# define PB4 4
+# define PB5 5
+# define PB6 6
+# define PB7 7
+# define PC0 0
+# define PC1 1
+# define PC2 2
+# define PC3 3
+# define PC4 4
+# define PC5 5
+# define PC6 6
+# define PD0 0
+# define PD1 1
+# define PD2 2
+# define PD3 3
+# define PD4 4
+# define PD5 5
+# define PD6 6
+# define PD7 7
+# define SREG_I 7
+# define TOV0   0
+# define OCF0A  1
+# define OCF0B  2
+# define TOV2   0
+# define OCF2A  1
+# define OCF2B  2
+# define WGM00  0
+# define WGM01  1
+# define WGM02  3
+# define CS00   0
+# define CS01   1
+# define CS02   2
+# define WGM20  0
+# define WGM21  1
+# define WGM22  3
+# define CS20   0
+# define CS21   1
+# define CS22   2
+# define TOIE0  0
+# define OCIE0A 1
+# define OCIE0B 2
+# define TOIE2  0
+# define OCIE2A 1
+# define OCIE2B 2
+# define TWPS0  0
+# define TWPS1  1
+# define TWIE   0
+# define TWEN   2
+# define TWWC   3
+# define TWSTO  4
+# define TWSTA  5
+# define TWEA   6
+# define TWINT  7
+# define MPCM0  0
+# define U2X0   1
+# define UPE0   2
+# define DOR0   3
+# define FE0    4
+# define UDRE0  5
+# define TXC0   6
+# define RXC0   7
+# define UCSZ02 2
+# define TXEN0  3
+# define RXEN0  4
+# define UDRIE0 5
+# define TXCIE0 6
+# define RXCIE0 7
+# define UCSZ00 1
+# define UCSZ01 2
+
+# define _BV(bit) (1 << (bit))
+
+/* (hal_host->delay)() and so on, lcd.c has a delay() macro */
+# define HAL_READ(reg)         (hal_host->read)(reg)
+# define HAL_WRITE(reg, value) (hal_host->write)((reg), (value))
+# define HAL_SET(reg, mask)    (hal_host->modify)((reg), 0, (mask))
+# define HAL_CLEAR(reg, mask)  (hal_host->modify)((reg), (mask), 0)
+# define HAL_DDR(port)         ((port) - 1)
+# define HAL_PIN(port)         ((port) - 2)
+# define HAL_SAME(reg1, reg2)  ((reg1) == (reg2))
+# define HAL_WAIT()            (hal_host->delay)(HAL_WAIT_CYCLES)
+
+/**
+ *  @brief CPU cycles of one turn of a busy wait.
+ */
+# define HAL_WAIT_CYCLES 4
+
+/* Interrupts: the vector name is the name of the handler */
+# define ISR(vector, ...) void vector(void)
+# define sei() HAL_SET(SREG, _BV(SREG_I))
+# define cli() HAL_CLEAR(SREG, _BV(SREG_I))
+
+/* util/atomic.h */
+# define ATOMIC_BLOCK(type) \
+    for (type, hal_atomic_once = hal_atomic_enter(); hal_atomic_once; \
+         hal_atomic_once = 0)
+# define ATOMIC_RESTORESTATE \
+    uint8_t hal_atomic_sreg __attribute__((__cleanup__(hal_atomic_restore))) = \
+        HAL_READ(SREG)
+# define ATOMIC_FORCEON \
+    uint8_t hal_atomic_sreg __attribute__((__cleanup__(hal_atomic_restore))) = \
+        _BV(SREG_I)
+
+/* util/delay.h */
+# define _delay_us(us) (hal_host->delay)((uint32_t)((us) * (F_CPU / 1e6)))
+# define _delay_ms(ms) (hal_host->delay)((uint32_t)((ms) * (F_CPU / 1e3)))
+
+/* avr/pgmspace.h, program memory is ordinary memory */
+# define PROGMEM
+# define PGM_P const char *
+# define PSTR(s) (s)
+# define pgm_read_byte(p)  (*(const uint8_t *)(p))
+# define pgm_read_word(p)  (*(const uint16_t *)(p))
+# define pgm_read_dword(p) (*(const uint32_t *)(p))
+# define pgm_read_ptr(p)   hal_pgm_read_ptr(p)
+# define memcpy_P memcpy
+# define strcmp_P strcmp
+# define strlen_P strlen
+
+/* avr/eeprom.h, the EEPROM lasts as long as the simulator runs */
+# define EEMEM
+# define eeprom_read_block(dst, src, n)   memcpy((dst), (src), (n))
+# define eeprom_update_block(src, dst, n) memcpy((dst), (src), (n))
+#endif /* __AVR__ */
+
+/* Types ---------------------------------------------------------------------*/
+#ifndef __AVR__
+/**
+ *  @brief Register access of the host build, installed by the simulator.
+ */
+typedef struct {
+    /** Value of register reg */
+    uint8_t (*read)(uint8_t reg);
+    /** Write value to register reg */
+    void (*write)(uint8_t reg, uint8_t value);
+    /** Clear, then set bits of register reg in one access */
+    void (*modify)(uint8_t reg, uint8_t clear, uint8_t set);
+    /** Let cycles CPU cycles pass, interrupts included */
+    void (*delay)(uint32_t cycles);
+} hal_host_t;
+
+/* Global variables ----------------------------------------------------------*/
+extern const hal_host_t *hal_host;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+ *  @brief Start of ATOMIC_BLOCK(): disable the interrupts.
+ *  @return 1, the block runs once
+ */
+static inline uint8_t hal_atomic_enter(void)
+{
+    cli();
+    return 1;
+}
+
+/**
+ *  @brief End of ATOMIC_BLOCK(): restore SREG.
+ */
+static inline void hal_atomic_restore(const uint8_t *sreg)
+{
+    HAL_WRITE(SREG, *sreg);
+}
+
+/**
+ *  @brief pgm_read_ptr() for any pointer type in the table.
+ */
+static inline void *hal_pgm_read_ptr(const void *p)
+{
+    void *value;
+
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+#endif /* __AVR__ */
+
+#endif /* HAL_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,120 @@
+#ifndef HISTORY_H_INCLUDED
+#define HISTORY_H_INCLUDED
+
+/**
+ *  @file history.h
+ *  @code #include <history.h> @endcode
+ *
+ *  @brief Ring buffer of the last filtered samples with rolling statistics.
+ *
+ *  history_push() keeps the window minimum and maximum in two monotonic
+ *  queues and the sums needed for the mean and the least-squares slope, so
+ *  every statistic is updated in constant (amortised for min/max) time and
+ *  read without any division. Memory use is 4 * HISTORY_SIZE + 14 bytes.
+ *
+ *  @note The first pushed sample fills the whole window, statistics are
+ *        valid from the first sample on and the trend starts flat.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Window length as a power of two, HISTORY_SIZE = 2^HISTORY_SHIFT.
+ *  @note Limited to 32 samples so the slope sums fit in 32 bits for
+ *        samples up to +/-8000 hundredths.
+ */
+#ifndef HISTORY_SHIFT
+# define HISTORY_SHIFT 5
+#endif
+
+#if (HISTORY_SHIFT < 2) || (HISTORY_SHIFT > 5)
+# error "HISTORY_SHIFT must be between 2 and 5"
+#endif
+
+/**
+ *  @brief Number of samples in the window.
+ */
+#define HISTORY_SIZE (1 << HISTORY_SHIFT)
+
+/**
+ *  @brief Slope denominator: N * sum(x^2) - sum(x)^2 = N^2 (N^2 - 1) / 12.
+ */
+#define HISTORY_SLOPE_DIV ((int32_t)HISTORY_SIZE * HISTORY_SIZE * \
+                           ((int32_t)HISTORY_SIZE * HISTORY_SIZE - 1) / 12)
+
+/**
+ *  @brief Largest deadband of history_trend() whose limit fits into the
+ *         slope arithmetic, above any slope of int16_t samples.
+ */
+#define HISTORY_DEADBAND_MAX ((int16_t)(INT32_MAX / HISTORY_SLOPE_DIV < \
+                                        INT16_MAX ? \
+                                        INT32_MAX / HISTORY_SLOPE_DIV : \
+                                        INT16_MAX))
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief Sample window and running statistics.
+ */
+typedef struct {
+    int16_t sample[HISTORY_SIZE];   /**< Ring of samples, indexed by seq */
+    uint8_t min_queue[HISTORY_SIZE];/**< Seq numbers, increasing values */
+    uint8_t max_queue[HISTORY_SIZE];/**< Seq numbers, decreasing values */
+    uint8_t min_first, min_count;
+    uint8_t max_first, max_count;
+    uint8_t seq;                    /**< Seq number of the next sample */
+    uint8_t primed;                 /**< 0 until the first sample */
+    int32_t sum;                    /**< sum(y) over the window */
+    int32_t weighted;               /**< sum(x * y), x = 0 for the oldest */
+} history_t;
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Clear the window.
+ *  @param h - History instance
+ */
+void history_init(history_t *h);
+
+/**
+ *  @brief Append one sample, dropping the oldest one.
+ *  @param h - History instance
+ *  @param value - New sample, e.g. filtered temperature in hundredths
+ */
+void history_push(history_t *h, int16_t value);
+
+/**
+ *  @brief Smallest sample in the window.
+ */
+int16_t history_min(const history_t *h);
+
+/**
+ *  @brief Largest sample in the window.
+ */
+int16_t history_max(const history_t *h);
+
+/**
+ *  @brief Rounded mean of the window, computed with a shift.
+ */
+int16_t history_mean(const history_t *h);
+
+/**
+ *  @brief Least-squares slope numerator.
+ *  @return Slope per sample multiplied by HISTORY_SLOPE_DIV
+ */
+int32_t history_slope(const history_t *h);
+
+/**
+ *  @brief Direction of the trend.
+ *  @param h - History instance
+ *  @param deadband - Minimum slope counted as a trend, in units per sample,
+ *                   limited to 0 .. HISTORY_DEADBAND_MAX
+ *  @retval 1 - Rising (e.g. warming)
+ *  @retval 0 - Flat within the deadband
+ *  @retval -1 - Falling (e.g. cooling)
+ */
+int8_t history_trend(const history_t *h, int16_t deadband);
+
+#endif /* HISTORY_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
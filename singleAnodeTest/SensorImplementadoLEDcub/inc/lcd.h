@@ -44,7 +44,7 @@
  */
 
 #include <inttypes.h>
-#include <avr/pgmspace.h>
+#include "hal.h"
 
 #if (__GNUC__ * 100 + __GNUC_MINOR__) < 405
 # error "This library requires AVR-GCC 4.5 or later, update to newer AVR-GCC compiler !"
@@ -357,6 +357,59 @@ extern void lcd_command(uint8_t cmd);
 extern void lcd_data(uint8_t data);
 
 
+/**
+ * @name  Asynchronous queue
+ *
+ * lcd_init_async(), lcd_queue_command() and lcd_queue_data() only queue
+ * nibbles, lcd_tick() sends them from a 1 ms tick with the spacing the
+ * controller needs, so nothing waits for the LCD. Do not mix with the
+ * blocking functions above while the queue is not empty.
+ */
+#ifndef LCD_QUEUE_SIZE
+# define LCD_QUEUE_SIZE 64 /**< queue entries, power of 2, two per byte */
+#endif
+
+
+/**
+ * @brief    Initialize display without waiting, see lcd_init()
+ * @param    dispAttr as for lcd_init()
+ * @return   none
+ */
+extern void lcd_init_async(uint8_t dispAttr);
+
+
+/**
+ * @brief    Queue LCD controller instruction command
+ * @param    cmd instruction to send to LCD controller, see HD44780 data sheet
+ * @return   1 if queued, 0 if the queue is full
+ */
+extern uint8_t lcd_queue_command(uint8_t cmd);
+
+
+/**
+ * @brief    Queue data byte for LCD controller
+ * @param    data byte to send to LCD controller, see HD44780 data sheet
+ * @return   1 if queued, 0 if the queue is full
+ */
+extern uint8_t lcd_queue_data(uint8_t data);
+
+
+/**
+ * @brief    Free queue entries, a byte takes two, clear and home three
+ * @return   number of free entries
+ */
+extern uint8_t lcd_queue_free(void);
+
+
+/**
+ * @brief    Send the queued nibbles that are due, at most one byte
+ *
+ * Call every millisecond, e.g. from a timer interrupt.
+ * @return   none
+ */
+extern void lcd_tick(void);
+
+
 /**
  * @brief macros for automatically storing string constant in program memory
  */
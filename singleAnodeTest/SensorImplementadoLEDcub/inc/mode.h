@@ -0,0 +1,77 @@
+#ifndef MODE_H_INCLUDED
+#define MODE_H_INCLUDED
+
+/**
+ *  @file mode.h
+ *  @code #include <mode.h> @endcode
+ *
+ *  @brief Choice of the animation shown in TWI master mode.
+ *
+ *  By default the animation follows the filtered temperature and its trend.
+ *  The threshold can be changed and an animation can be fixed at run time,
+ *  e.g. from the command shell.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "sensor.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Default filtered temperature from which the second animation is
+ *         shown, in centi-degrees (former rule: temperature_integer <= 28).
+ */
+#ifndef ANIMATION_THRESHOLD
+# define ANIMATION_THRESHOLD 2900
+#endif
+
+/**
+ *  @brief Threshold shift in centi-degrees while warming up or cooling down,
+ *         so the animation follows the trend before the threshold is crossed.
+ */
+#define ANIMATION_TREND_LEAD 50
+
+/**
+ *  @brief Minimum slope counted as a trend, centi-degrees per sample.
+ */
+#define ANIMATION_TREND_DEADBAND 1
+
+/**
+ *  @brief mode_set_fixed() argument to return to the automatic choice.
+ */
+#define MODE_AUTO 0xff
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Choose the animation from the filtered temperature and its trend,
+ *         unless one is fixed.
+ *  @return ANIM_LAYERS (cold), ANIM_SLICES (warm) or the fixed ANIM_x
+ */
+uint8_t mode_animation(const sensor_sample_t *sample);
+
+/**
+ *  @brief Set the threshold of the automatic choice.
+ *  @param threshold - Centi-degrees
+ */
+void mode_set_threshold(int16_t threshold);
+
+/**
+ *  @brief Threshold of the automatic choice in centi-degrees.
+ */
+int16_t mode_threshold(void);
+
+/**
+ *  @brief Always show one animation.
+ *  @param id - ANIM_x, or MODE_AUTO for the automatic choice
+ */
+void mode_set_fixed(uint8_t id);
+
+/**
+ *  @brief Fixed animation.
+ *  @return ANIM_x, or MODE_AUTO
+ */
+uint8_t mode_fixed(void);
+
+#endif /* MODE_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,46 @@
+#ifndef PREVIEW_H_INCLUDED
+#define PREVIEW_H_INCLUDED
+
+/**
+ *  @file preview.h
+ *  @code #include <preview.h> @endcode
+ *
+ *  @brief Mini-map of the cube layers in LCD user glyphs.
+ *
+ *  Every layer and colour of the frame being shown becomes a 3x3 dot
+ *  pattern in one CGRAM glyph, layer 0 on the left. The glyphs are built
+ *  from cube_get_front(), so they show what the refresh outputs, not what
+ *  an animation is drawing. display.h only rewrites a glyph when its layer
+ *  changed.
+ *
+ *     - CUBE_DRIVER_DIRECT: both colours are shown together, one glyph per
+ *       layer at the end of the first line
+ *     - CUBE_DRIVER_SR595: red layers at the end of the first line, green
+ *       layers at the end of the second
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Period of the glyph update in milliseconds.
+ */
+#define PREVIEW_MS 100
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Put the glyph characters into the display shadow.
+ *  @note Call after display_clear().
+ */
+void preview_draw(void);
+
+/**
+ *  @brief Rebuild the glyphs from the front buffer every PREVIEW_MS.
+ *  @note Call from the main loop after display_init().
+ */
+void preview_task(void);
+
+#endif /* PREVIEW_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,63 @@
+#ifndef REGMAP_H_INCLUDED
+#define REGMAP_H_INCLUDED
+
+/**
+ *  @file regmap.h
+ *  @code #include <regmap.h> @endcode
+ *
+ *  @brief Register map of the cube in TWI slave mode.
+ *
+ *  Built only with TWI_SLAVE_ADDRESS defined. A master writes the register
+ *  number followed by any number of data bytes, the register number is
+ *  incremented after each byte. Framebuffer writes go straight into the
+ *  cube back buffer from TWI_vect and the buffers are swapped at the stop
+ *  condition, so one write transfer updates the whole cube at once.
+ *
+ *  | Register    | Access | Content                                      |
+ *  |-------------|--------|----------------------------------------------|
+ *  | 0x00..0x0b  | R/W    | Back buffer, cube_frame_t in memory order    |
+ *  | 0x0c        | R/W    | Brightness 0..255                            |
+ *  | 0x0d        | R/W    | Animation id ANIM_x, 0 stops the player      |
+ *  | 0x0e        | R      | Status, see REGMAP_STATUS_x                  |
+ *
+ *  @note Writing the framebuffer stops the animation player, however it was
+ *        started. Until the main loop has stopped it the player owns the back
+ *        buffer: framebuffer bytes are dropped, the transfer is not shown
+ *        and sets REGMAP_STATUS_INVALID, so the master writes it again.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "cube.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Register numbers.
+ */
+#define REGMAP_FRAME      0x00
+#define REGMAP_BRIGHTNESS (REGMAP_FRAME + CUBE_FRAME_SIZE)
+#define REGMAP_ANIMATION  (REGMAP_BRIGHTNESS + 1)
+#define REGMAP_STATUS     (REGMAP_ANIMATION + 1)
+#define REGMAP_SIZE       (REGMAP_STATUS + 1)
+
+/**
+ *  @brief Status register bits.
+ *     - REGMAP_STATUS_ANIMATION: animation player running
+ *     - REGMAP_STATUS_INVALID: write outside the map, invalid animation id
+ *       or framebuffer write dropped since the last status read
+ *     - REGMAP_STATUS_FRAMES: low nibble of the swap counter, bits 7..4
+ */
+#define REGMAP_STATUS_ANIMATION 0x01
+#define REGMAP_STATUS_INVALID   0x02
+#define REGMAP_STATUS_FRAMES    0xf0
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Apply animation changes requested by the master.
+ *  @note Call from the main loop, the animation player is not interrupt safe.
+ */
+void regmap_task(void);
+
+#endif /* REGMAP_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
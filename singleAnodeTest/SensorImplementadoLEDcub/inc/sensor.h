@@ -0,0 +1,197 @@
+#ifndef SENSOR_H_INCLUDED
+#define SENSOR_H_INCLUDED
+
+/**
+ *  @file sensor.h
+ *  @code #include <sensor.h> @endcode
+ *
+ *  @brief TWI sensor manager: boot-time bus scan, device table and
+ *         round-robin polling with cached samples.
+ *
+ *  At boot the state machine probes every TWI address once with the
+ *  interrupt driven transfers of twi.c and registers each responding device
+ *  with a known driver (DHT12, LM75). Afterwards the registered devices are
+ *  read in turn, each one no faster than its own period, and every good
+ *  reading is cached with its timestamp. sensor_task() advances the state
+ *  machine by one step and never waits for the bus, consumers read the cache
+ *  with sensor_get() or sensor_device_get() and never touch the bus.
+ *
+ *  The first DHT12 found is the main sensor: its temperature and humidity are
+ *  passed through filter.h, downstream code should use the filtered
+ *  centi-unit fields rather than the raw registers. The filtered temperature
+ *  is appended to a history window for trends. Every device carries a region
+ *  index so that additional sensors can drive different parts of the cube.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "history.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief TWI address of the DHT12 temperature and humidity sensor.
+ */
+#define DHT12 0x5c
+
+/**
+ *  @brief Default sampling period of the DHT12 in milliseconds.
+ *  @note The DHT12 does not update its registers faster than about 2 s.
+ */
+#ifndef SENSOR_PERIOD_MS
+# define SENSOR_PERIOD_MS 2000
+#endif
+
+/**
+ *  @brief Default sampling period of an LM75 in milliseconds.
+ */
+#ifndef SENSOR_LM75_PERIOD_MS
+# define SENSOR_LM75_PERIOD_MS 1000
+#endif
+
+/**
+ *  @brief Size of the device table.
+ */
+#ifndef SENSOR_MAX_DEVICES
+# define SENSOR_MAX_DEVICES 4
+#endif
+
+/**
+ *  @brief Delay before a failed read is retried, in milliseconds.
+ */
+#ifndef SENSOR_RETRY_MS
+# define SENSOR_RETRY_MS 100
+#endif
+
+/**
+ *  @brief Retries of a failed read before waiting for the next period.
+ */
+#ifndef SENSOR_RETRIES
+# define SENSOR_RETRIES 2
+#endif
+
+/**
+ *  @brief Longest time a single transfer may take before it is aborted.
+ */
+#ifndef SENSOR_TWI_TIMEOUT_MS
+# define SENSOR_TWI_TIMEOUT_MS 10
+#endif
+
+/**
+ *  @brief Time after which the bus is scanned again while no device is known.
+ */
+#ifndef SENSOR_RESCAN_MS
+# define SENSOR_RESCAN_MS 10000
+#endif
+
+/**
+ *  @brief First and last address probed by the bus scan (reserved excluded).
+ */
+#define SENSOR_SCAN_FIRST 0x08
+#define SENSOR_SCAN_LAST  0x77
+
+/**
+ *  @brief Kinds of devices with a driver.
+ */
+#define SENSOR_KIND_DHT12 1
+#define SENSOR_KIND_LM75  2
+
+/**
+ *  @brief Age returned by sensor_age() while no sample has been read yet.
+ */
+#define SENSOR_AGE_NONE 0xffffffffUL
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief Raw register values as read from the DHT12.
+ */
+struct values{
+    uint8_t humidity_integer;
+    uint8_t humidity_decimal;
+    uint8_t temperature_integer;
+    uint8_t temperature_decimal;
+};
+
+/**
+ *  @brief Cached reading of the main DHT12.
+ */
+typedef struct {
+    struct values values;   /**< Last good register values */
+    int16_t temperature;    /**< Filtered temperature in centi-degrees */
+    int16_t humidity;       /**< Filtered relative humidity in centi-percent */
+    uint32_t timestamp;     /**< timer_millis() when the values were read */
+    uint8_t valid;          /**< 0 until the first complete reading */
+} sensor_sample_t;
+
+/**
+ *  @brief Entry of the device table.
+ */
+typedef struct {
+    uint8_t address;        /**< 7-bit TWI address */
+    uint8_t kind;           /**< SENSOR_KIND_x */
+    uint8_t region;         /**< Cube region driven by this device */
+    uint8_t retries;        /**< Failed reads since the last good one */
+    uint16_t period;        /**< Polling period in milliseconds */
+    uint16_t errors;        /**< Failed reads since boot */
+    uint32_t last_poll;     /**< timer_millis() of the last read attempt */
+    uint32_t timestamp;     /**< timer_millis() of the last good read */
+    int16_t value;          /**< Last temperature in centi-degrees, unfiltered */
+    uint8_t valid;          /**< 0 until the first good read */
+} sensor_device_t;
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Advance the scan/poll state machine by one step.
+ *  @note Call from the main loop as often as possible, it never blocks.
+ */
+void sensor_task(void);
+
+/**
+ *  @brief Change the sampling period of every device, also of those the
+ *         boot scan has not found yet.
+ *  @param period_ms - Time between two polls in milliseconds
+ */
+void sensor_set_period(uint16_t period_ms);
+
+/**
+ *  @brief Copy the last good sample of the main DHT12.
+ *  @param sample - Destination of the cached sample
+ *  @retval 0 - No sample has been read yet, sample holds zeros
+ *  @retval 1 - sample holds the last good reading
+ */
+uint8_t sensor_get(sensor_sample_t *sample);
+
+/**
+ *  @brief Age of the cached sample of the main DHT12.
+ *  @return Milliseconds since the last good reading, or SENSOR_AGE_NONE
+ */
+uint32_t sensor_age(void);
+
+/**
+ *  @brief Window of the last filtered temperatures.
+ *  @return History fed by the DHT12 path, see history.h for the queries
+ */
+const history_t *sensor_history(void);
+
+/**
+ *  @brief Number of devices registered by the bus scan.
+ */
+uint8_t sensor_device_count(void);
+
+/**
+ *  @brief Copy one entry of the device table.
+ *  @param index - 0 .. sensor_device_count() - 1
+ *  @param device - Destination
+ *  @retval 0 - No such device
+ *  @retval 1 - device holds the entry
+ */
+uint8_t sensor_device_get(uint8_t index, sensor_device_t *device);
+
+/**
+ *  @brief TWI Finite State Machine scanning the bus and polling the devices.
+ *  @note Advances one state per call. Used by sensor_task().
+ */
+void fsm_twi_scanner(void);
+
+#endif /* SENSOR_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
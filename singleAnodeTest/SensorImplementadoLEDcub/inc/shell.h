@@ -0,0 +1,89 @@
+#ifndef SHELL_H_INCLUDED
+#define SHELL_H_INCLUDED
+
+/**
+ *  @file shell.h
+ *  @code #include <shell.h> @endcode
+ *
+ *  @brief Line oriented command shell on the UART.
+ *
+ *  Characters are taken from the UART receive ringbuffer as they arrive
+ *  and collected into a line, a carriage return or line feed executes it.
+ *  Output of more than one line is written one line per shell_task() call
+ *  and only while the transmit buffer has room for it, so the shell never
+ *  waits for the UART and the sensor and refresh tasks keep running.
+ *
+ *  | Command            | Action                                         |
+ *  |--------------------|------------------------------------------------|
+ *  | help               | List the commands                              |
+ *  | bright [0..255]    | Show or set the global brightness              |
+ *  | anim [id|name]     | Show or fix the animation                      |
+ *  | anim list|auto     | List the animations, return to automatic choice|
+ *  | thresh [centi-C]   | Show or set the animation threshold            |
+ *  | sensor             | Dump the main sample and the device table      |
+ *  | stats              | Uptime, telemetry, cube and stream counters    |
+ *  | rate [Hz]          | Show or set the refresh rate of binary frames  |
+ *  | stream             | Hand the receiver to the frame stream          |
+ *  | telemetry [on|off] | Show, start or stop the telemetry frames       |
+ *  | save               | Store the settings in EEPROM (config.h)        |
+ *
+ *  Names, usage and help texts are kept in program memory.
+ *
+ *  Binary telemetry frames (telemetry.h) share the transmitter. They are
+ *  held back while shell_busy(), so they never split a line or an answer,
+ *  and "telemetry off" stops them while a terminal is attached. A line left
+ *  unfinished for SHELL_IDLE_MS, e.g. a stray byte on the wire, is dropped
+ *  with a new prompt and releases the transmitter.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Longest command line without the terminating character.
+ */
+#ifndef SHELL_LINE_MAX
+# define SHELL_LINE_MAX 32
+#endif
+
+/**
+ *  @brief Time without a character after which a partly typed line is
+ *         dropped, ms.
+ */
+#ifndef SHELL_IDLE_MS
+# define SHELL_IDLE_MS 10000
+#endif
+
+/**
+ *  @brief Longest output line including CR LF, an output line is only
+ *         written when the transmit buffer has room for it.
+ */
+#define SHELL_OUTPUT_MAX 56
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Print the prompt.
+ *  @note Call after uart_init().
+ */
+void shell_init(void);
+
+/**
+ *  @brief Read the received characters, execute complete lines and write
+ *         the next line of pending output.
+ *  @note Call from the main loop. Does nothing while the frame stream owns
+ *        the receiver.
+ */
+void shell_task(void);
+
+/**
+ *  @brief Whether a line is being typed or its answer is being written.
+ *  @retval 1 - From the first character of a line until the prompt, at
+ *              most SHELL_IDLE_MS after the last character of the line
+ *  @retval 0 - Otherwise, the transmitter is free for other output
+ */
+uint8_t shell_busy(void);
+
+#endif /* SHELL_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,141 @@
+#ifndef STREAM_H_INCLUDED
+#define STREAM_H_INCLUDED
+
+/**
+ *  @file stream.h
+ *  @code #include <stream.h> @endcode
+ *
+ *  @brief Real-time frames from a host renderer over the UART.
+ *
+ *  Each packet is COBS encoded and terminated by a 0x00 byte, so a receiver
+ *  that lost bytes resynchronises at the next delimiter. Decoded packet:
+ *
+ *  | Byte | Content                                                      |
+ *  |------|--------------------------------------------------------------|
+ *  | 0    | Sequence number, incremented by the host for every frame     |
+ *  | 1    | Type, STREAM_BINARY or STREAM_GREY                           |
+ *  | 2..  | Frame                                                        |
+ *  | last | CRC-8 (crc.h) of all bytes before                            |
+ *
+ *  LED n = (layer * CUBE_COLOURS + colour) * CUBE_COLUMNS + column is
+ *     - STREAM_BINARY: bit n of 7 bytes, LSB of byte 0 first
+ *     - STREAM_GREY: nibble n of 27 bytes, low nibble of byte 0 first,
+ *       16 levels shown with bit angle modulation
+ *
+ *  Payload bytes are decoded straight into the cube back buffer as they
+ *  arrive, without a packet buffer, and the buffers are swapped when the
+ *  delimiter ends a complete packet. A broken packet is never shown, the
+ *  next complete one overwrites every LED. Packets with a sequence number
+ *  not newer than the last one are dropped, gaps are counted as lost
+ *  frames. From stream_start() until the timeout the animation player is
+ *  stopped.
+ *
+ *  The UART receiver is shared with the command shell. stream_start(),
+ *  e.g. the shell command "stream", hands it to the decoder until no frame
+ *  has arrived for STREAM_TIMEOUT_MS. Built with UART_RX_HOOK the decoder
+ *  then runs in the UART receive interrupt through uart_rx_hook(),
+ *  otherwise stream_task() polls the receive ringbuffer.
+ *
+ *  At 115200 Bd a binary frame takes 12 bytes and a grey scale frame 32
+ *  bytes including the COBS overhead and the delimiter, well below the
+ *  line rate at 100 frames per second. host/streamer.c sends test patterns
+ *  to a serial port or a pseudo terminal.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "cube.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Packet types.
+ */
+#define STREAM_BINARY 0x01
+#define STREAM_GREY   0x02
+
+/**
+ *  @brief Frame sizes in bytes.
+ */
+#define STREAM_BINARY_SIZE ((CUBE_LAYERS * CUBE_COLOURS * CUBE_COLUMNS + 7) / 8)
+#define STREAM_GREY_SIZE   ((CUBE_LAYERS * CUBE_COLOURS * CUBE_COLUMNS + 1) / 2)
+
+/**
+ *  @brief Header bytes in front of the frame: sequence number and type.
+ */
+#define STREAM_HEADER 2
+
+/**
+ *  @brief Trailer bytes behind the frame: CRC-8.
+ */
+#define STREAM_TRAILER 1
+
+/**
+ *  @brief Time without a frame after which the stream is stopped and the
+ *         receiver returns to the command shell.
+ */
+#ifndef STREAM_TIMEOUT_MS
+# define STREAM_TIMEOUT_MS 1000
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+/**
+ *  @brief Receive counters since reset, wrap at 65536.
+ *     - frames: frames shown
+ *     - lost: frames missing between two sequence numbers
+ *     - stale: duplicate or out of order frames dropped
+ *     - errors: packets dropped for COBS, length, CRC or UART errors
+ */
+typedef struct {
+    uint16_t frames;
+    uint16_t lost;
+    uint16_t stale;
+    uint16_t errors;
+} stream_stats_t;
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Decode one received byte.
+ *  @param data - Byte from the UART, 0x00 ends a packet
+ */
+void stream_feed(uint8_t data);
+
+/**
+ *  @brief Hand the UART receiver to the stream decoder and stop the
+ *         animation player, the sequence number of the first frame is
+ *         accepted as is.
+ *  @note Call from the main loop, anim_start() is not interrupt safe.
+ */
+void stream_start(void);
+
+/**
+ *  @brief Whether the UART receiver belongs to the stream decoder.
+ *  @retval 1 - Between stream_start() and the timeout
+ *  @retval 0 - Otherwise, the command shell reads the receiver
+ */
+uint8_t stream_enabled(void);
+
+/**
+ *  @brief Decode the bytes waiting in the UART receive buffer, unless the
+ *         receive hook does, and keep the animation player stopped while
+ *         stream_enabled().
+ *  @note Call from the main loop, without UART_RX_HOOK often enough that the
+ *        receive buffer does not overflow.
+ */
+void stream_task(void);
+
+/**
+ *  @brief Whether the host has sent a frame within STREAM_TIMEOUT_MS.
+ *  @retval 1 - The framebuffer belongs to the stream
+ *  @retval 0 - Otherwise
+ */
+uint8_t stream_active(void);
+
+/**
+ *  @brief Copy the receive counters.
+ *  @param stats - Destination
+ */
+void stream_get_stats(stream_stats_t *stats);
+
+#endif /* STREAM_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,146 @@
+#ifndef TELEMETRY_H_INCLUDED
+#define TELEMETRY_H_INCLUDED
+
+/**
+ *  @file telemetry.h
+ *  @code #include <telemetry.h> @endcode
+ *
+ *  @brief Binary telemetry frames on the UART.
+ *
+ *  Every frame is built in RAM and queued at once. A frame that does not
+ *  fit into the UART transmit buffer is dropped and counted, sending never
+ *  waits for the UART.
+ *
+ *  The frames share the UART with the command shell, so they are never
+ *  sent into its text: no frame is queued while shell_busy(), i.e. from
+ *  the first character of a line until its answer is complete or the line
+ *  is dropped after SHELL_IDLE_MS without input. Frames are sent from reset
+ *  (TELEMETRY_ENABLE), the shell command "telemetry off" stops them for a
+ *  terminal session and "telemetry on" resumes them.
+ *  Frames held back either way are not counted as dropped.
+ *
+ *  | Byte  | Content                                                   |
+ *  |-------|-----------------------------------------------------------|
+ *  | 0     | TELEMETRY_SYNC                                            |
+ *  | 1     | Type, TELEMETRY_x                                         |
+ *  | 2     | Payload length n                                          |
+ *  | 3..   | Payload, multi-byte values little endian                  |
+ *  | n+3.. | CRC-16/CCITT-FALSE of bytes 1 .. n+2, high byte first     |
+ *
+ *  A receiver searches for TELEMETRY_SYNC, reads the header and drops the
+ *  frame if the CRC does not match, so it resynchronises after lost bytes.
+ *  The CRC-16 of bytes 1 .. n+4, the CRC included, is 0 for a good frame
+ *  (see crc.h).
+ *
+ *  Payloads:
+ *     - TELEMETRY_SAMPLE: int16 temperature [0.01 C], int16 humidity
+ *       [0.01 %] of the main DHT12, both filtered
+ *     - TELEMETRY_DEVICE: uint8 region, uint8 address, int16 temperature
+ *       [0.01 C] of a sensor other than the main DHT12
+ *     - TELEMETRY_SCAN: addresses registered by the bus scan, 1 byte each
+ *     - TELEMETRY_COUNTERS: uint32 uptime [ms], uint16 telemetry frames,
+ *       uint8 cube swaps, uint8 animation id, uint16 dropped frames,
+ *       uint16 bytes dropped by uart_putc()
+ *     - TELEMETRY_ERRORS: per device uint8 address, uint16 failed reads,
+ *       uint8 failed reads since the last good one
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "sensor.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief First byte of every frame.
+ */
+#define TELEMETRY_SYNC 0xa5
+
+/**
+ *  @brief Frame types.
+ */
+#define TELEMETRY_SAMPLE   0x01
+#define TELEMETRY_DEVICE   0x02
+#define TELEMETRY_SCAN     0x03
+#define TELEMETRY_COUNTERS 0x04
+#define TELEMETRY_ERRORS   0x05
+
+/**
+ *  @brief Longest payload.
+ */
+#define TELEMETRY_PAYLOAD_MAX 16
+
+/**
+ *  @brief Frame overhead: sync, type, length and CRC.
+ */
+#define TELEMETRY_OVERHEAD 5
+
+/**
+ *  @brief Whether frames are sent from reset, 0 for a shell-only build,
+ *         e.g. make CDEFS=-DTELEMETRY_ENABLE=0.
+ */
+#ifndef TELEMETRY_ENABLE
+# define TELEMETRY_ENABLE 1
+#endif
+
+/**
+ *  @brief Period of the counter and error frames in milliseconds.
+ */
+#ifndef TELEMETRY_STATS_MS
+# define TELEMETRY_STATS_MS 10000
+#endif
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Queue one frame for transmission, or drop it if the UART transmit
+ *         buffer is too full. Nothing is sent while telemetry is off or the
+ *         shell is busy.
+ *  @param type - TELEMETRY_x
+ *  @param payload - Payload bytes
+ *  @param length - 0 .. TELEMETRY_PAYLOAD_MAX, longer payloads are cut
+ */
+void telemetry_send(uint8_t type, const void *payload, uint8_t length);
+
+/**
+ *  @brief Queue a TELEMETRY_SAMPLE frame.
+ *  @param sample - Reading of the main DHT12
+ */
+void telemetry_sample(const sensor_sample_t *sample);
+
+/**
+ *  @brief Queue a TELEMETRY_DEVICE frame.
+ *  @param device - Device that has just been read
+ */
+void telemetry_device(const sensor_device_t *device);
+
+/**
+ *  @brief Queue a TELEMETRY_SCAN frame with the registered addresses.
+ */
+void telemetry_scan(void);
+
+/**
+ *  @brief Send the counter and error frames every TELEMETRY_STATS_MS.
+ *  @note Call from the main loop.
+ */
+void telemetry_task(void);
+
+/**
+ *  @brief Number of frames queued since reset.
+ */
+uint16_t telemetry_frames(void);
+
+/**
+ *  @brief Start or stop sending frames.
+ *  @param enable - 1 to send, 0 to stop
+ */
+void telemetry_set_enabled(uint8_t enable);
+
+/**
+ *  @brief Whether frames are sent.
+ *  @retval 1 - Sent, unless the shell is busy
+ *  @retval 0 - Stopped
+ */
+uint8_t telemetry_enabled(void);
+
+#endif /* TELEMETRY_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
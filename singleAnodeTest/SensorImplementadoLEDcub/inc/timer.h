@@ -0,0 +1,53 @@
+#ifndef TIMER_H_INCLUDED
+#define TIMER_H_INCLUDED
+
+/**
+ *  @file timer.h
+ *  @code #include <timer.h> @endcode
+ *
+ *  @brief Millisecond time base for the cooperative tasks of the main loop.
+ *
+ *  Timer/Counter0 runs in CTC mode and its compare match interrupt increments
+ *  a 32-bit millisecond counter. Tasks compare timer_millis() against their
+ *  own deadlines instead of blocking in _delay_ms().
+ *
+ *  @note Timer/Counter0 was previously set up with a 16 ms overflow interrupt
+ *        that was never used.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/**
+ *  @brief Tick frequency of the time base in Hz.
+ */
+#define TIMER_TICK_HZ 1000
+
+/**
+ *  @brief Compare value for Timer/Counter0 with clock prescaler 64.
+ */
+#define TIMER_OCR0A_VALUE ((F_CPU / 64 / TIMER_TICK_HZ) - 1)
+
+#if (TIMER_OCR0A_VALUE > 255)
+# error "TIMER_TICK_HZ too low for 8-bit Timer/Counter0 with prescaler 64"
+#endif
+
+/* Function prototypes -------------------------------------------------------*/
+/**
+ *  @brief Start Timer/Counter0 in CTC mode with a 1 ms compare interrupt.
+ *  @note Interrupts must be enabled globally by the caller (sei).
+ */
+void timer_init(void);
+
+/**
+ *  @brief Milliseconds elapsed since timer_init().
+ *  @return Millisecond counter, wraps after about 49 days
+ *  @note Compare times with unsigned subtraction so the wrap is harmless.
+ */
+uint32_t timer_millis(void);
+
+#endif /* TIMER_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
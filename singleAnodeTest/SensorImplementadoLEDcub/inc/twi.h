@@ -1,11 +1,11 @@
-#ifndef TWI_H_INCLUDED
-#define TWI_H_INCLUDED
+#ifndef TWI_H_INCLUDED
+#define TWI_H_INCLUDED
 
 /*******************************************************************************
  * Title: TWI library
  * Author: Tomas Fryza, Brno University of Technology, Czechia
- * Software: avr-gcc, tested with avr-gcc 4.9.2
- * Hardware: Any AVR with built-in TWI unit
+ * Software: avr-gcc, tested with avr-gcc 4.9.2
+ * Hardware: Any AVR with built-in TWI unit
  *
  * MIT License
  *
@@ -32,52 +32,52 @@
  ******************************************************************************/
 
 /**
- *  @file twi.h
- *  @code #include <twi.h> @endcode
- *
+ *  @file twi.h
+ *  @code #include <twi.h> @endcode
+ *
  *  @brief TWI library for AVR-GCC.
  *
  *  The library defines functions for the TWI (I2C) communication between AVR
  *  and slave device(s). The functions control built-in TWI hardware unit of
  *  AVR.
  *
- *  @note Based on Atmel ATmega16, ATmega328P manuals
- *  @author Tomas Fryza, Brno University of Technology, Czechia
- *  @version 2.1
- *  @date Oct 27, 2018
- *  @copyright (c) 2018 Tomas Fryza, MIT License
- */
-
-/* Includes ------------------------------------------------------------------*/
- #include "settings.h"
- #include <avr/io.h>
-
-/* Constants and macros ------------------------------------------------------*/
+ *  @note Based on Atmel ATmega16, ATmega328P manuals
+ *  @author Tomas Fryza, Brno University of Technology, Czechia
+ *  @version 2.1
+ *  @date Oct 27, 2018
+ *  @copyright (c) 2018 Tomas Fryza, MIT License
+ */
+
+/* Includes ------------------------------------------------------------------*/
+ #include "settings.h"
+ #include "hal.h"
+
+/* Constants and macros ------------------------------------------------------*/
 /**
  *  @brief Port of TWI hardware unit.
  */
-#define TWI_PORT PORTC
+#define TWI_PORT PORTC
 
-/**
- *  @brief SDA pin of TWI hardware unit.
- */
-#define TWI_SDA_PIN 4
-
-/**
- *  @brief SCL pin of TWI hardware unit.
- */
-#define TWI_SCL_PIN 5
+/**
+ *  @brief SDA pin of TWI hardware unit.
+ */
+#define TWI_SDA_PIN 4
 
-/**
+/**
+ *  @brief SCL pin of TWI hardware unit.
+ */
+#define TWI_SCL_PIN 5
+
+/**
  *  @brief TWI bit rate.
- *  @warning Must be greater than 31000 kbps
- */
-#define F_SCL 50000
+ *  @warning Must be greater than 31000 kbps
+ */
+#define F_SCL 50000
 
-/**
- *  @brief TWI bit rate register value.
- */
-#define TWI_BIT_RATE_REG ((F_CPU/F_SCL - 16) / 2)
+/**
+ *  @brief TWI bit rate register value.
+ */
+#define TWI_BIT_RATE_REG ((F_CPU/F_SCL - 16) / 2)
 
 /**
  *  @brief Data direction for reading from TWI device.
@@ -89,50 +89,141 @@
  */
 #define TWI_WRITE 0
 
+/**
+ *  @brief Asynchronous transfer finished, slave acknowledged everything.
+ */
+#define TWI_ASYNC_OK 0
+
+/**
+ *  @brief Asynchronous transfer failed, slave did not acknowledge.
+ */
+#define TWI_ASYNC_NACK 1
+
+/**
+ *  @brief Asynchronous transfer failed, bus error or arbitration lost.
+ */
+#define TWI_ASYNC_ERROR 2
+
+/**
+ *  @brief Asynchronous transfer still in progress.
+ */
+#define TWI_ASYNC_BUSY 0xff
+
+/**
+ *  @brief Slave mode. When TWI_SLAVE_ADDRESS is defined at build time, e.g.
+ *         make CDEFS=-DTWI_SLAVE_ADDRESS=0x30, TWI_vect serves the slave mode
+ *         and the asynchronous master transfers never finish.
+ */
+#ifdef TWI_SLAVE_ADDRESS
+# if (TWI_SLAVE_ADDRESS < 0x08) || (TWI_SLAVE_ADDRESS > 0x77)
+#  error "TWI_SLAVE_ADDRESS must be between 0x08 and 0x77"
+# endif
+#endif
+
 /* Function prototypes -------------------------------------------------------*/
 /**
  *  @brief Initialize TWI, enable pull-up resistors, and set SCL frequency.
  *  @par Implementation notes:
  *     - AVR internal pull-up resistors at pins TWI_SDA_PIN and TWI_SCL_PIN
  *       are enabled
- *     - TWI bit rate register value is calculated by fscl = fcpu/(16 + 2*TWBR)
- */
-void twi_init(void);
+ *     - TWI bit rate register value is calculated by fscl = fcpu/(16 + 2*TWBR)
+ */
+void twi_init(void);
 
 /**
  *  @brief Start communication on TWI bus and send address of TWI slave device.
  *  @param slave_address - Address and transfer direction of TWI slave device
- *  @retval 0 - Slave device accessible
- *  @retval 1 - Failed to access slave device
- *  @Note Function returns 0 only if 0x18 or 0x40 status code is detected.
- *        0x18: SLA+W has been transmitted and ACK has been received
- *        0x40: SLA+R has been transmitted and ACK has been received
- */
-uint8_t twi_start(uint8_t slave_address);
+ *  @retval 0 - Slave device accessible
+ *  @retval 1 - Failed to access slave device
+ *  @Note Function returns 0 only if 0x18 or 0x40 status code is detected.
+ *        0x18: SLA+W has been transmitted and ACK has been received
+ *        0x40: SLA+R has been transmitted and ACK has been received
+ */
+uint8_t twi_start(uint8_t slave_address);
 
 /**
- *  @brief Send one byte to TWI slave device.
+ *  @brief Send one byte to TWI slave device.
  *  @param data - Byte to be transmitted
- */
-void twi_write(uint8_t data);
+ */
+void twi_write(uint8_t data);
 
 /**
- *  @brief Read one byte from TWI slave device, followed by ACK.
+ *  @brief Read one byte from TWI slave device, followed by ACK.
  *  @return Received data
- */
-uint8_t twi_read_ack(void);
+ */
+uint8_t twi_read_ack(void);
 
 /**
- *  @brief Read one byte from TWI slave device, followed by NACK.
+ *  @brief Read one byte from TWI slave device, followed by NACK.
  *  @return Received data
- */
-uint8_t twi_read_nack(void);
+ */
+uint8_t twi_read_nack(void);
 
 /**
  *  @brief Generates stop condition on TWI bus.
- */
-void twi_stop(void);
-
-#endif /* TWI_H_INCLUDED */
-
-/* END OF FILE ****************************************************************/
+ */
+void twi_stop(void);
+
+/**
+ *  @brief Start an interrupt driven transfer: optional write phase, then an
+ *         optional read phase after a repeated start.
+ *  @param address - 7-bit address of TWI slave device (not shifted)
+ *  @param tx - Bytes to write, e.g. register address
+ *  @param tx_len - Number of bytes to write
+ *  @param rx - Buffer for the received bytes
+ *  @param rx_len - Number of bytes to read, the last one is NACKed
+ *  @retval 0 - Transfer started, poll twi_async_status()
+ *  @retval 1 - Previous transfer still running
+ *  @note Waits for the STOP of the previous transfer to complete.
+ *        With tx_len and rx_len both 0 the slave is only addressed (probe).
+ *        Buffers must stay valid until the transfer has finished.
+ */
+uint8_t twi_async_transfer(uint8_t address, const uint8_t *tx, uint8_t tx_len,
+                           uint8_t *rx, uint8_t rx_len);
+
+/**
+ *  @brief Result of the last asynchronous transfer.
+ *  @return TWI_ASYNC_BUSY, TWI_ASYNC_OK, TWI_ASYNC_NACK or TWI_ASYNC_ERROR
+ */
+uint8_t twi_async_status(void);
+
+/**
+ *  @brief Abort a hanging asynchronous transfer and release the TWI unit.
+ *  @note The status becomes TWI_ASYNC_ERROR.
+ */
+void twi_async_abort(void);
+
+#ifdef TWI_SLAVE_ADDRESS
+/**
+ *  @brief Initialize TWI as slave device with address TWI_SLAVE_ADDRESS.
+ *  @note Used instead of twi_init().
+ */
+void twi_slave_init(void);
+
+/**
+ *  @brief Byte written by the master, implemented by the application.
+ *  @param reg - Register, incremented after every byte
+ *  @param data - Received byte
+ *  @note Called from TWI_vect.
+ */
+void twi_slave_receive(uint8_t reg, uint8_t data);
+
+/**
+ *  @brief Byte read by the master, implemented by the application.
+ *  @param reg - Register, incremented after every byte
+ *  @return Byte to transmit
+ *  @note Called from TWI_vect.
+ */
+uint8_t twi_slave_transmit(uint8_t reg);
+
+/**
+ *  @brief Stop or repeated start after a write, implemented by the
+ *         application.
+ *  @note Called from TWI_vect.
+ */
+void twi_slave_stop(void);
+#endif
+
+#endif /* TWI_H_INCLUDED */
+
+/* END OF FILE ****************************************************************/
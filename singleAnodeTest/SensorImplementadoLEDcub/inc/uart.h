@@ -48,7 +48,7 @@
  */
 
 
-#include <avr/pgmspace.h>
+#include "hal.h"
 
 #if (__GNUC__ * 100 + __GNUC_MINOR__) < 405
 # error "This library requires AVR-GCC 4.5 or later, update to newer AVR-GCC compiler !"
@@ -75,6 +75,36 @@
  */
 #define UART_BAUD_SELECT_DOUBLE_SPEED(baudRate, xtalCpu) ( ((((xtalCpu) + 4UL * (baudRate)) / (8UL * (baudRate)) - 1UL)) | 0x8000)
 
+/** @brief  UBRR value for a clock divider of 16 (normal) or 8 (double speed) */
+#define UART_UBRR(baudRate, xtalCpu, div) (((xtalCpu) + (div) / 2UL * (baudRate)) / ((div) * (baudRate)) - 1UL)
+
+/** @brief  Baud rate error in per mille for a clock divider of 16 or 8 */
+#define UART_BAUD_ERROR(baudRate, xtalCpu, div) \
+    ((((xtalCpu) / ((div) * (UART_UBRR(baudRate, xtalCpu, div) + 1UL)) > (baudRate)) ? \
+      ((xtalCpu) / ((div) * (UART_UBRR(baudRate, xtalCpu, div) + 1UL)) - (baudRate)) : \
+      ((baudRate) - (xtalCpu) / ((div) * (UART_UBRR(baudRate, xtalCpu, div) + 1UL)))) * 1000UL / (baudRate))
+
+/** @brief  UART Baudrate Expression selecting double speed mode only if it
+ *          gives a smaller baud rate error, e.g. 115200 at 16 MHz
+ *  @param  xtalCpu  system clock in Mhz, e.g. 4000000UL for 4Mhz
+ *  @param  baudRate baudrate in bps, e.g. 115200, 250000, 500000, 1000000
+ */
+#define UART_BAUD_SELECT_AUTO(baudRate, xtalCpu) \
+    ((UART_BAUD_ERROR(baudRate, xtalCpu, 8UL) < UART_BAUD_ERROR(baudRate, xtalCpu, 16UL)) ? \
+     UART_BAUD_SELECT_DOUBLE_SPEED(baudRate, xtalCpu) : UART_BAUD_SELECT(baudRate, xtalCpu))
+
+/** @brief  Baud rate error in per mille of UART_BAUD_SELECT_AUTO() */
+#define UART_BAUD_ERROR_AUTO(baudRate, xtalCpu) \
+    ((UART_BAUD_ERROR(baudRate, xtalCpu, 8UL) < UART_BAUD_ERROR(baudRate, xtalCpu, 16UL)) ? \
+     UART_BAUD_ERROR(baudRate, xtalCpu, 8UL) : UART_BAUD_ERROR(baudRate, xtalCpu, 16UL))
+
+/** @brief  Largest baud rate error in per mille accepted by the compile-time
+ *          check of the application, 115200 baud at 16 MHz is 21 per mille
+ */
+#ifndef UART_BAUD_ERROR_MAX
+# define UART_BAUD_ERROR_MAX 25
+#endif
+
 /** @brief  Size of the circular receive buffer, must be power of 2
  *
  *  You may need to adapt this constant to your target and your application by adding
@@ -98,6 +128,15 @@
 # error "size of UART_RX_BUFFER_SIZE + UART_TX_BUFFER_SIZE larger than size of SRAM"
 #endif
 
+/** @brief  Optional receive hook
+ *
+ *  With UART_RX_HOOK defined, e.g. make CDEFS=-DUART_RX_HOOK, the receive
+ *  interrupt of UART0 passes every byte to uart_rx_hook() first. The
+ *  application provides the hook. Bytes it consumes are not stored in the
+ *  receive ringbuffer, so a protocol decoder runs inside the interrupt
+ *  without a copy and without polling uart_getc().
+ */
+
 /*
 ** high byte error return code of uart_getc()
 */
@@ -107,6 +146,14 @@
 #define UART_BUFFER_OVERFLOW 0x0200 /**< @brief receive ringbuffer overflow */
 #define UART_NO_DATA         0x0100 /**< @brief no receive data available   */
 
+/*
+** behaviour of uart_putc() when the transmit ringbuffer is full
+*/
+#define UART_TX_BLOCK        0 /**< @brief wait for free space (default)      */
+#define UART_TX_DROP_NEWEST  1 /**< @brief discard the new byte               */
+#define UART_TX_DROP_OLDEST  2 /**< @brief discard the oldest queued byte     */
+#define UART_TX_TIMEOUT      3 /**< @brief wait, discard after a timeout      */
+
 
 /*
 ** function prototypes
@@ -120,6 +167,19 @@
 extern void uart_init(unsigned int baudrate);
 
 
+#ifdef UART_RX_HOOK
+/**
+ * @brief   Receive hook of UART0, provided by the application
+ *
+ * Called from the receive interrupt, keep it short.
+ * @param   data  received byte
+ * @param   error UART_FRAME_ERROR, UART_OVERRUN_ERROR and UART_PARITY_ERROR
+ *                bits shifted right by 8, 0 if the byte was received well
+ * @return  non-zero if the byte was consumed, 0 to store it in the ringbuffer
+ */
+extern unsigned char uart_rx_hook(unsigned char data, unsigned char error);
+#endif
+
 /**
  *  @brief   Get received byte from ringbuffer
  *
@@ -187,6 +247,51 @@ extern void uart_puts_p(const char *s);
 #define uart_puts_P(__s) uart_puts_p(PSTR(__s))
 
 
+/**
+ *  @brief   Put a block of bytes to ringbuffer for transmitting via UART
+ *
+ *  The block is copied into the circular buffer in at most two contiguous
+ *  chunks, the buffer head is updated and the UDRE interrupt enabled only
+ *  once. Never blocks: bytes that do not fit are not copied.
+ *
+ *  @param   buf bytes to be transmitted
+ *  @param   len number of bytes
+ *  @return  number of bytes accepted, 0 .. len
+ */
+extern unsigned int uart_write(const void *buf, unsigned int len);
+
+
+/**
+ *  @brief   Free space in the transmit ringbuffer
+ *  @return  number of bytes that can be written without waiting
+ */
+extern unsigned int uart_tx_free(void);
+
+
+/**
+ *  @brief   Select what uart_putc(), uart_puts() and uart_puts_p() do when
+ *           the transmit ringbuffer is full
+ *
+ *  With UART_TX_DROP_NEWEST and UART_TX_DROP_OLDEST they return at once,
+ *  with UART_TX_TIMEOUT they wait at most timeout_us per byte. Discarded
+ *  bytes are counted, see uart_tx_dropped(). uart_write() never waits and
+ *  is not affected.
+ *
+ *  @param   policy UART_TX_BLOCK, UART_TX_DROP_NEWEST, UART_TX_DROP_OLDEST
+ *           or UART_TX_TIMEOUT
+ *  @param   timeout_us longest wait per byte for UART_TX_TIMEOUT
+ *  @return  none
+ */
+extern void uart_tx_policy(unsigned char policy, unsigned int timeout_us);
+
+
+/**
+ *  @brief   Number of bytes discarded because the ringbuffer was full
+ *  @return  byte count since reset, saturates at 0xFFFF
+ */
+extern unsigned int uart_tx_dropped(void);
+
+
 /** @brief  Initialize USART1 (only available on selected ATmegas) @see uart_init */
 extern void uart1_init(unsigned int baudrate);
 /** @brief  Get received byte of USART1 from ringbuffer. (only available on selected ATmega) @see uart_getc */
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    fmtsize.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Size probe for make size: the console conversions of the firmware
+  *          done once with src/fmt.c and, with FMT_PROBE_ITOA defined, with
+  *          ltoa()/ultoa() and a string buffer as before. Both are linked
+  *          with src/uart.c only, the difference of the two images is the
+  *          flash the formatter saves.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "uart.h"
+#ifdef FMT_PROBE_ITOA
+# include <stdlib.h>
+#else
+# include "fmt.h"
+#endif
+
+/* Global variables ----------------------------------------------------------*/
+/* Volatile so the calls are not folded into constants */
+volatile int32_t probe_signed = -2345;
+volatile uint32_t probe_unsigned = 4000000000UL;
+volatile uint8_t probe_byte = 0x5c;
+
+/* Functions -----------------------------------------------------------------*/
+/**
+  * @brief Main function.
+  */
+int main(void)
+{
+#ifdef FMT_PROBE_ITOA
+    char buffer[12];
+    int32_t centi = probe_signed;
+#endif
+
+    uart_init(UART_BAUD_SELECT_AUTO(115200, F_CPU));
+    sei();
+
+#ifdef FMT_PROBE_ITOA
+    uart_puts(ltoa(probe_signed, buffer, 10));
+    uart_puts(ultoa(probe_unsigned, buffer, 10));
+    if (probe_byte < 0x10) {
+        uart_putc('0');
+    }
+    uart_puts(utoa(probe_byte, buffer, 16));
+    if (centi < 0) {
+        uart_putc('-');
+        centi = -centi;
+    }
+    uart_puts(ltoa(centi / 100, buffer, 10));
+    uart_putc('.');
+    if (centi % 100 < 10) {
+        uart_putc('0');
+    }
+    uart_puts(ltoa(centi % 100, buffer, 10));
+#else
+    fmt_dec(probe_signed);
+    fmt_udec(probe_unsigned);
+    fmt_hex(probe_byte, 2);
+    fmt_fixed(probe_signed, 2);
+#endif
+
+    for (;;) {
+    }
+    return 0;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @file    anim.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Frame table animations played into the cube back buffer.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hal.h"
+#include "cube.h"
+#include "timer.h"
+#include "anim.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Columns with column % 3 == 0 (PB3, PB0, PD5 in TestAnimation2) */
+#define ANIM_SLICE 0x0049
+
+/* Frame with the given red column masks of layers 0, 1, 2 */
+#define ANIM_FRAME(l0, l1, l2, ms) {{{{l0, 0}, {l1, 0}, {l2, 0}}}, ms}
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    cube_frame_t frame;
+    uint16_t duration;      /* Display time in milliseconds */
+} anim_frame_t;
+
+typedef struct {
+    uint8_t first;          /* Index in anim_frames */
+    uint8_t count;
+    PGM_P name;             /* Name in flash */
+} anim_sequence_t;
+
+/* Global variables ----------------------------------------------------------*/
+static const anim_frame_t anim_frames[] PROGMEM = {
+    /* ANIM_LAYERS: layer turned on shifting up */
+    ANIM_FRAME(CUBE_ALL_COLUMNS, 0, 0, 200),
+    ANIM_FRAME(0, CUBE_ALL_COLUMNS, 0, 200),
+    ANIM_FRAME(0, 0, CUBE_ALL_COLUMNS, 200),
+    /* ANIM_SLICES: slice turned on shifting to the side */
+    ANIM_FRAME(ANIM_SLICE, ANIM_SLICE, ANIM_SLICE, 400),
+    ANIM_FRAME(ANIM_SLICE << 1, ANIM_SLICE << 1, ANIM_SLICE << 1, 400),
+    ANIM_FRAME(ANIM_SLICE << 2, ANIM_SLICE << 2, ANIM_SLICE << 2, 400),
+};
+
+static const char anim_name_none[] PROGMEM = "none";
+static const char anim_name_layers[] PROGMEM = "layers";
+static const char anim_name_slices[] PROGMEM = "slices";
+
+/* Frames of each id, ANIM_NONE has none */
+static const anim_sequence_t anim_sequences[ANIM_COUNT] PROGMEM = {
+    {0, 0, anim_name_none},
+    {0, 3, anim_name_layers},
+    {3, 3, anim_name_slices},
+};
+
+static uint8_t anim_id = ANIM_NONE;
+static uint8_t anim_index;
+static uint8_t anim_shown;
+static uint16_t anim_duration;
+static uint32_t anim_time;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: anim_start()
+ * Purpose:  Select an animation, its first frame is shown by the next
+ *           anim_task().
+ * Input:    id - ANIM_x
+ * Returns:  None
+ ******************************************************************************/
+void anim_start(uint8_t id)
+{
+    anim_id = (id < ANIM_COUNT) ? id : ANIM_NONE;
+    anim_index = 0;
+    anim_shown = 0;
+}
+
+/*******************************************************************************
+ * Function: anim_current()
+ * Purpose:  Animation being played.
+ * Input:    None
+ * Returns:  ANIM_x
+ ******************************************************************************/
+uint8_t anim_current(void)
+{
+    return anim_id;
+}
+
+/*******************************************************************************
+ * Function: anim_name()
+ * Purpose:  Name of an animation.
+ * Input:    id - ANIM_x
+ * Returns:  String in program memory, NULL for invalid ids
+ ******************************************************************************/
+PGM_P anim_name(uint8_t id)
+{
+    if (id >= ANIM_COUNT) {
+        return NULL;
+    }
+    return (PGM_P)pgm_read_ptr(&anim_sequences[id].name);
+}
+
+/*******************************************************************************
+ * Function: anim_task()
+ * Purpose:  Draw and show the next frame when it is due.
+ * Input:    None
+ * Returns:  1 - Last frame ended
+ *           0 - Otherwise
+ ******************************************************************************/
+uint8_t anim_task(void)
+{
+    const anim_frame_t *frame;
+    uint32_t now;
+    uint8_t first, count;
+
+    if (anim_id == ANIM_NONE) {
+        return 0;
+    }
+    now = timer_millis();
+    if (anim_shown && (now - anim_time) < anim_duration) {
+        return 0;
+    }
+
+    first = pgm_read_byte(&anim_sequences[anim_id].first);
+    count = pgm_read_byte(&anim_sequences[anim_id].count);
+    if (anim_index >= count) {
+        anim_index = 0;
+        anim_shown = 0;
+        return 1;
+    }
+
+    frame = &anim_frames[first + anim_index];
+    memcpy_P(cube_back(), &frame->frame, sizeof(cube_frame_t));
+    anim_duration = pgm_read_word(&frame->duration);
+    cube_swap();
+    anim_time = now;
+    anim_shown = 1;
+    anim_index++;
+    return 0;
+}
+
+/* END OF FILE ****************************************************************/
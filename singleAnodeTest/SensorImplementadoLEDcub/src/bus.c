@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file    bus.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Time multiplexing of the pins shared by the LCD and the 74HC595
+  *          chain.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hal.h"
+#include "lcd.h"
+#include "bus.h"
+
+#if BUS_SHARED
+/* Global variables ----------------------------------------------------------*/
+/* D7 clocked the shift registers since they were last refilled */
+static uint8_t bus_dirty = 0;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: bus_lcd_nibble()
+ * Purpose:  Set D4..D7 and RS, refilling the shift registers before D4
+ *           rises if D7 has clocked them.
+ * Input:    nibble - D7..D4 in bits 3..0
+ *           rs - Register select
+ * Returns:  None
+ ******************************************************************************/
+void bus_lcd_nibble(uint8_t nibble, uint8_t rs)
+{
+    /* D4 is LATCH_SHIFT */
+    if (nibble & 0x01) {
+        if (!(HAL_READ(LCD_DATA0_PORT) & _BV(LCD_DATA0_PIN)) && bus_dirty) {
+            /* CLK low first, or the first of the 24 clocks is lost */
+            HAL_CLEAR(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+            cube_reload();
+            bus_dirty = 0;
+        }
+        HAL_SET(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+    }
+    else {
+        HAL_CLEAR(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+    }
+
+    if (nibble & 0x02) HAL_SET(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+    else HAL_CLEAR(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+    if (nibble & 0x04) HAL_SET(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+    else HAL_CLEAR(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+
+    /* RS is DATA_SHIFT, set after a refill which drives it too */
+    if (rs) HAL_SET(LCD_RS_PORT, _BV(LCD_RS_PIN));
+    else HAL_CLEAR(LCD_RS_PORT, _BV(LCD_RS_PIN));
+
+    /* D7 is CLK_SHIFT, set last so its edge follows the latch edge */
+    if (nibble & 0x08) {
+        if (!(HAL_READ(LCD_DATA3_PORT) & _BV(LCD_DATA3_PIN))) {
+            bus_dirty = 1;
+        }
+        HAL_SET(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+    }
+    else {
+        HAL_CLEAR(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+    }
+}
+
+/*******************************************************************************
+ * Function: bus_lcd_release()
+ * Purpose:  Leave CLK_SHIFT and LATCH_SHIFT low, falling edges are ignored by
+ *           the 74HC595.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void bus_lcd_release(void)
+{
+    HAL_CLEAR(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+    HAL_CLEAR(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+}
+#endif /* BUS_SHARED */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,85 @@
+/**
+  ******************************************************************************
+  * @file    config.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Run-time settings in EEPROM, protected by a CRC-16.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include "crc.h"
+#include "cube.h"
+#include "mode.h"
+#include "config.h"
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint8_t version;
+    uint8_t brightness;
+    uint16_t rate;
+    int16_t threshold;
+    uint8_t animation;      /* mode_fixed() */
+} config_t;
+
+typedef struct {
+    config_t data;
+    uint16_t crc;           /* CRC-16 of data */
+} config_record_t;
+
+/* Global variables ----------------------------------------------------------*/
+static config_record_t config_eeprom EEMEM;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: config_load()
+ * Purpose:  Read the record and apply it if it is valid.
+ * Input:    None
+ * Returns:  CONFIG_APPLIED - Settings applied
+ *           CONFIG_RATE_BAD - Applied except the rate, default kept
+ *           CONFIG_DEFAULTS - Invalid record
+ ******************************************************************************/
+uint8_t config_load(void)
+{
+    config_record_t record;
+
+    eeprom_read_block(&record, &config_eeprom, sizeof(record));
+    if (crc16_block(CRC16_INIT, &record.data, sizeof(record.data)) != record.crc ||
+        record.data.version != CONFIG_VERSION) {
+        return CONFIG_DEFAULTS;
+    }
+
+    cube_set_brightness(record.data.brightness);
+    mode_set_threshold(record.data.threshold);
+    mode_set_fixed(record.data.animation);
+    /* E.g. a rate saved by an older firmware, rejected without a change */
+    if (cube_set_rate(record.data.rate)) {
+        return CONFIG_RATE_BAD;
+    }
+    return CONFIG_APPLIED;
+}
+
+/*******************************************************************************
+ * Function: config_save()
+ * Purpose:  Write the current settings.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void config_save(void)
+{
+    config_record_t record;
+
+    record.data.version = CONFIG_VERSION;
+    record.data.brightness = cube_get_brightness();
+    record.data.rate = cube_get_rate_setting();
+    record.data.threshold = mode_threshold();
+    record.data.animation = mode_fixed();
+    record.crc = crc16_block(CRC16_INIT, &record.data, sizeof(record.data));
+
+    /* Unchanged bytes are not rewritten, saving wear and time */
+    eeprom_update_block(&record, &config_eeprom, sizeof(record));
+}
+
+/* END OF FILE ****************************************************************/
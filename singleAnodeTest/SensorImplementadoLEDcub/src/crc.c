@@ -0,0 +1,232 @@
+/**
+  ******************************************************************************
+  * @file    crc.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   CRC-8 (0x07) and CRC-16/CCITT (0x1021) with nibble or full lookup
+  *          tables in program memory.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hal.h"
+#include "crc.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#if defined(CRC_ALL_TABLES)
+# define CRC_NIBBLE 1
+# define CRC_FULL   1
+#elif CRC_TABLE == CRC_TABLE_NIBBLE
+# define CRC_NIBBLE 1
+# define CRC_FULL   0
+#elif CRC_TABLE == CRC_TABLE_FULL
+# define CRC_NIBBLE 0
+# define CRC_FULL   1
+#else
+# error "Unknown CRC_TABLE"
+#endif
+
+/* Global variables ----------------------------------------------------------*/
+#if CRC_NIBBLE
+/* CRC of each high nibble shifted through 4 bits */
+static const uint8_t crc8_nibble[16] PROGMEM = {
+    0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15,
+    0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d,
+};
+
+static const uint16_t crc16_nibble[16] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+#endif
+
+#if CRC_FULL
+/* CRC of each byte shifted through 8 bits */
+static const uint8_t crc8_table[256] PROGMEM = {
+    0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31,
+    0x24, 0x23, 0x2a, 0x2d, 0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65,
+    0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d, 0xe0, 0xe7, 0xee, 0xe9,
+    0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd,
+    0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1,
+    0xb4, 0xb3, 0xba, 0xbd, 0xc7, 0xc0, 0xc9, 0xce, 0xdb, 0xdc, 0xd5, 0xd2,
+    0xff, 0xf8, 0xf1, 0xf6, 0xe3, 0xe4, 0xed, 0xea, 0xb7, 0xb0, 0xb9, 0xbe,
+    0xab, 0xac, 0xa5, 0xa2, 0x8f, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9d, 0x9a,
+    0x27, 0x20, 0x29, 0x2e, 0x3b, 0x3c, 0x35, 0x32, 0x1f, 0x18, 0x11, 0x16,
+    0x03, 0x04, 0x0d, 0x0a, 0x57, 0x50, 0x59, 0x5e, 0x4b, 0x4c, 0x45, 0x42,
+    0x6f, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7d, 0x7a, 0x89, 0x8e, 0x87, 0x80,
+    0x95, 0x92, 0x9b, 0x9c, 0xb1, 0xb6, 0xbf, 0xb8, 0xad, 0xaa, 0xa3, 0xa4,
+    0xf9, 0xfe, 0xf7, 0xf0, 0xe5, 0xe2, 0xeb, 0xec, 0xc1, 0xc6, 0xcf, 0xc8,
+    0xdd, 0xda, 0xd3, 0xd4, 0x69, 0x6e, 0x67, 0x60, 0x75, 0x72, 0x7b, 0x7c,
+    0x51, 0x56, 0x5f, 0x58, 0x4d, 0x4a, 0x43, 0x44, 0x19, 0x1e, 0x17, 0x10,
+    0x05, 0x02, 0x0b, 0x0c, 0x21, 0x26, 0x2f, 0x28, 0x3d, 0x3a, 0x33, 0x34,
+    0x4e, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5c, 0x5b, 0x76, 0x71, 0x78, 0x7f,
+    0x6a, 0x6d, 0x64, 0x63, 0x3e, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2c, 0x2b,
+    0x06, 0x01, 0x08, 0x0f, 0x1a, 0x1d, 0x14, 0x13, 0xae, 0xa9, 0xa0, 0xa7,
+    0xb2, 0xb5, 0xbc, 0xbb, 0x96, 0x91, 0x98, 0x9f, 0x8a, 0x8d, 0x84, 0x83,
+    0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef,
+    0xfa, 0xfd, 0xf4, 0xf3,
+};
+
+static const uint16_t crc16_table[256] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+    0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+    0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+    0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+    0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+    0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+    0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+    0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+    0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+    0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+    0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+    0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+    0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+    0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+    0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+    0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+    0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+    0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+    0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+    0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+    0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+    0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,
+};
+#endif
+
+/* Functions -----------------------------------------------------------------*/
+#if CRC_NIBBLE
+/*******************************************************************************
+ * Function: crc8_update_nibble()
+ * Purpose:  CRC-8 of one more byte, one nibble per table lookup.
+ * Input:    crc - CRC so far
+ *           data - Next byte
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint8_t crc8_update_nibble(uint8_t crc, uint8_t data)
+{
+    crc ^= data;
+    crc = (uint8_t)(crc << 4) ^ pgm_read_byte(&crc8_nibble[crc >> 4]);
+    crc = (uint8_t)(crc << 4) ^ pgm_read_byte(&crc8_nibble[crc >> 4]);
+    return crc;
+}
+
+/*******************************************************************************
+ * Function: crc16_update_nibble()
+ * Purpose:  CRC-16 of one more byte, one nibble per table lookup.
+ * Input:    crc - CRC so far
+ *           data - Next byte
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint16_t crc16_update_nibble(uint16_t crc, uint8_t data)
+{
+    crc = (crc << 4) ^ pgm_read_word(&crc16_nibble[(crc >> 12) ^ (data >> 4)]);
+    crc = (crc << 4) ^ pgm_read_word(&crc16_nibble[(crc >> 12) ^ (data & 0x0f)]);
+    return crc;
+}
+#endif
+
+#if CRC_FULL
+/*******************************************************************************
+ * Function: crc8_update_full()
+ * Purpose:  CRC-8 of one more byte, one table lookup.
+ * Input:    crc - CRC so far
+ *           data - Next byte
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint8_t crc8_update_full(uint8_t crc, uint8_t data)
+{
+    return pgm_read_byte(&crc8_table[crc ^ data]);
+}
+
+/*******************************************************************************
+ * Function: crc16_update_full()
+ * Purpose:  CRC-16 of one more byte, one table lookup.
+ * Input:    crc - CRC so far
+ *           data - Next byte
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint16_t crc16_update_full(uint16_t crc, uint8_t data)
+{
+    return (crc << 8) ^ pgm_read_word(&crc16_table[(uint8_t)(crc >> 8) ^ data]);
+}
+#endif
+
+/*******************************************************************************
+ * Function: crc8_update()
+ * Purpose:  CRC-8 of one more byte with the CRC_TABLE flavour.
+ * Input:    crc - CRC so far
+ *           data - Next byte
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint8_t crc8_update(uint8_t crc, uint8_t data)
+{
+#if CRC_TABLE == CRC_TABLE_FULL
+    return crc8_update_full(crc, data);
+#else
+    return crc8_update_nibble(crc, data);
+#endif
+}
+
+/*******************************************************************************
+ * Function: crc8_block()
+ * Purpose:  CRC-8 of a block of bytes.
+ * Input:    crc - CRC so far
+ *           data - Bytes
+ *           length - Number of bytes
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint8_t crc8_block(uint8_t crc, const void *data, uint16_t length)
+{
+    const uint8_t *p = data;
+
+    while (length--) {
+        crc = crc8_update(crc, *p++);
+    }
+    return crc;
+}
+
+/*******************************************************************************
+ * Function: crc16_update()
+ * Purpose:  CRC-16 of one more byte with the CRC_TABLE flavour.
+ * Input:    crc - CRC so far
+ *           data - Next byte
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint16_t crc16_update(uint16_t crc, uint8_t data)
+{
+#if CRC_TABLE == CRC_TABLE_FULL
+    return crc16_update_full(crc, data);
+#else
+    return crc16_update_nibble(crc, data);
+#endif
+}
+
+/*******************************************************************************
+ * Function: crc16_block()
+ * Purpose:  CRC-16 of a block of bytes.
+ * Input:    crc - CRC so far
+ *           data - Bytes
+ *           length - Number of bytes
+ * Returns:  Updated CRC
+ ******************************************************************************/
+uint16_t crc16_block(uint16_t crc, const void *data, uint16_t length)
+{
+    const uint8_t *p = data;
+
+    while (length--) {
+        crc = crc16_update(crc, *p++);
+    }
+    return crc;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,476 @@
+/**
+  ******************************************************************************
+  * @file    cube.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Double buffered cube framebuffer and layer multiplexing on
+  *          Timer/Counter2 (CTC, 1 ms per layer), binary or with bit angle
+  *          modulated grey scale.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include <string.h>
+#include "cube.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Layer slot: prescaler 64, 250 counts = 1 ms at 16 MHz */
+#define CUBE_OCR2A_VALUE ((F_CPU / 64 / 1000) - 1)
+
+/* Timer/Counter2 clock */
+#define CUBE_TIMER_HZ (F_CPU / 64)
+
+/* Layer slot of a rate, timer ticks rounded to the nearest */
+#define CUBE_SLOT_TICKS(rate) \
+    ((CUBE_TIMER_HZ + (uint32_t)(rate) * CUBE_LAYERS / 2) / \
+     ((uint32_t)(rate) * CUBE_LAYERS))
+
+/* OCR2A range whose rates lie within CUBE_RATE_MIN .. CUBE_RATE_MAX */
+#define CUBE_SLOT_MIN \
+    ((CUBE_TIMER_HZ + (uint32_t)CUBE_RATE_MAX * CUBE_LAYERS - 1) / \
+     ((uint32_t)CUBE_RATE_MAX * CUBE_LAYERS) - 1)
+#define CUBE_SLOT_MAX \
+    (CUBE_TIMER_HZ / ((uint32_t)CUBE_RATE_MIN * CUBE_LAYERS) - 1)
+
+#if (CUBE_OCR2A_VALUE > 255)
+# error "F_CPU too high for a 1 ms layer slot on Timer/Counter2"
+#endif
+
+#if ((CUBE_BAM_UNIT << CUBE_BAM_BITS) - CUBE_BAM_UNIT > CUBE_OCR2A_VALUE + 1)
+# error "CUBE_BAM_BITS planes do not fit into a layer slot"
+#endif
+
+#if CUBE_DRIVER == CUBE_DRIVER_DIRECT
+/* Columns 0..5 on PB0..PB5, columns 6..8 on PD5..PD7 */
+# define CUBE_PORTB_COLUMNS 0x3f
+# define CUBE_PORTD_COLUMNS (_BV(PD7) | _BV(PD6) | _BV(PD5))
+/* Layer pins, active low */
+# define CUBE_PORTD_LAYERS  (_BV(PD4) | _BV(PD3) | _BV(PD2))
+#elif CUBE_DRIVER == CUBE_DRIVER_SR595
+# define DATA_SHIFT  PB0
+# define CLK_SHIFT   PD7
+# define LATCH_SHIFT PD4
+/* SR3: GND1..GND3 (active low) on bits 5..7 as in SR3_activation[] of
+ * PruebaSR3, G9 G8 on bits 1..0, unused outputs high */
+# define CUBE_SR3_LAYER_SHIFT 5
+# define CUBE_SR3_IDLE 0xfc
+#else
+# error "Unknown CUBE_DRIVER"
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+/* Binary frames use plane 0 only */
+typedef struct {
+    cube_frame_t plane[CUBE_BAM_BITS];
+    uint8_t grey;
+} cube_image_t;
+
+/* Global variables ----------------------------------------------------------*/
+/* Front buffer is read by the refresh interrupt only */
+static cube_image_t cube_images[2];
+static cube_image_t *volatile cube_front = &cube_images[0];
+static cube_image_t *volatile cube_draw = &cube_images[1];
+
+static uint8_t cube_layer = 0;
+static uint8_t cube_plane = 0;
+static volatile uint8_t cube_brightness = CUBE_BRIGHTNESS_MAX;
+/* OCR2A of binary frames, set by cube_set_rate() */
+static volatile uint8_t cube_slot = CUBE_OCR2A_VALUE;
+/* Rate given to cube_set_rate(), the slot makes the nearest one */
+static uint16_t cube_rate = CUBE_RATE_DEFAULT;
+static volatile uint8_t cube_swaps = 0;
+
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+/* Word on the 74HC595 outputs, written by the refresh interrupt */
+static uint32_t cube_latched;
+#endif
+
+#if CUBE_DRIVER == CUBE_DRIVER_DIRECT
+/* Layer pin of each layer */
+static const uint8_t cube_layer_pin[CUBE_LAYERS] = {
+    _BV(PD4), _BV(PD3), _BV(PD2)};
+#endif
+
+/* Function prototypes -------------------------------------------------------*/
+static void cube_output(const cube_frame_t *frame, uint8_t layer);
+static void cube_blank(void);
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+static void cube_shift(uint8_t sr3, uint8_t sr2, uint8_t sr1);
+static void cube_load(uint32_t bits);
+#endif
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: cube_init()
+ * Purpose:  Configure the output stage and start the layer refresh.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void cube_init(void)
+{
+    memset(cube_images, 0, sizeof(cube_images));
+
+#if CUBE_DRIVER == CUBE_DRIVER_DIRECT
+    HAL_SET(DDRB, CUBE_PORTB_COLUMNS);
+    HAL_SET(DDRD, CUBE_PORTD_COLUMNS | CUBE_PORTD_LAYERS);
+#else
+    HAL_SET(DDRB, _BV(DATA_SHIFT));
+    HAL_SET(DDRD, _BV(CLK_SHIFT) | _BV(LATCH_SHIFT));
+    HAL_CLEAR(PORTB, _BV(DATA_SHIFT));
+    HAL_CLEAR(PORTD, _BV(CLK_SHIFT) | _BV(LATCH_SHIFT));
+#endif
+    cube_blank();
+
+    /* Timer/Counter2: CTC mode, TOP = OCR2A, one layer per compare match A,
+     * compare match B ends the layer for dimming */
+    HAL_WRITE(TCCR2A, _BV(WGM21));
+    HAL_WRITE(OCR2A, CUBE_OCR2A_VALUE);
+    cube_set_brightness(CUBE_BRIGHTNESS_MAX);
+    /* Clock prescaler 64 => 250 kHz timer clock at 16 MHz */
+    HAL_WRITE(TCCR2B, _BV(CS22));
+    HAL_SET(TIMSK2, _BV(OCIE2A) | _BV(OCIE2B));
+}
+
+/*******************************************************************************
+ * Function: cube_back()
+ * Purpose:  Binary frame being drawn.
+ * Input:    None
+ * Returns:  Back buffer
+ ******************************************************************************/
+cube_frame_t *cube_back(void)
+{
+    cube_draw->grey = 0;
+    return &cube_draw->plane[0];
+}
+
+/*******************************************************************************
+ * Function: cube_back_planes()
+ * Purpose:  Grey scale frame being drawn.
+ * Input:    None
+ * Returns:  CUBE_BAM_BITS bit planes of the back buffer, LSB first
+ ******************************************************************************/
+cube_frame_t *cube_back_planes(void)
+{
+    cube_draw->grey = 1;
+    return cube_draw->plane;
+}
+
+/*******************************************************************************
+ * Function: cube_swap()
+ * Purpose:  Exchange front and back buffer and copy the new front buffer into
+ *           the back buffer.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void cube_swap(void)
+{
+    cube_image_t *image;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        image = cube_front;
+        cube_front = cube_draw;
+        cube_draw = image;
+        /* Binary frames only need plane 0 */
+        image->grey = cube_front->grey;
+        memcpy(image->plane, cube_front->plane,
+               image->grey ? sizeof(image->plane) : sizeof(cube_frame_t));
+        cube_swaps++;
+    }
+}
+
+/*******************************************************************************
+ * Function: cube_get_front()
+ * Purpose:  Copy the frame on the LEDs, a grey scale LED counts as on if any
+ *           of its bit planes is set.
+ * Input:    frame - Destination
+ * Returns:  None
+ ******************************************************************************/
+void cube_get_front(cube_frame_t *frame)
+{
+    uint8_t plane, layer, colour;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        *frame = cube_front->plane[0];
+        if (cube_front->grey) {
+            for (plane = 1; plane < CUBE_BAM_BITS; plane++) {
+                for (layer = 0; layer < CUBE_LAYERS; layer++) {
+                    for (colour = 0; colour < CUBE_COLOURS; colour++) {
+                        frame->column[layer][colour] |=
+                            cube_front->plane[plane].column[layer][colour];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function: cube_clear()
+ * Purpose:  Turn every LED of the back buffer off.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void cube_clear(void)
+{
+    memset(cube_draw, 0, sizeof(cube_image_t));
+}
+
+/*******************************************************************************
+ * Function: cube_set_brightness()
+ * Purpose:  Set the part of each layer slot the layer is on.
+ * Input:    brightness - 0 .. CUBE_BRIGHTNESS_MAX
+ * Returns:  None
+ ******************************************************************************/
+void cube_set_brightness(uint8_t brightness)
+{
+    cube_brightness = brightness;
+    /* Scale 0..255 to 0..OCR2A */
+    HAL_WRITE(OCR2B, (uint8_t)(((uint16_t)brightness * cube_slot) >> 8));
+}
+
+/*******************************************************************************
+ * Function: cube_get_brightness()
+ * Purpose:  Current global brightness.
+ * Input:    None
+ * Returns:  0 .. CUBE_BRIGHTNESS_MAX
+ ******************************************************************************/
+uint8_t cube_get_brightness(void)
+{
+    return cube_brightness;
+}
+
+/*******************************************************************************
+ * Function: cube_set_rate()
+ * Purpose:  Set the layer slot of binary frames from a frame rate.
+ * Input:    rate - Frames per second
+ * Returns:  0 on success, 1 if the rate is out of range
+ ******************************************************************************/
+uint8_t cube_set_rate(uint16_t rate)
+{
+    uint32_t ticks;
+
+    if (rate < CUBE_RATE_MIN || rate > CUBE_RATE_MAX) {
+        return 1;
+    }
+    /* The nearest slot, but none whose rate is out of range, so that
+     * cube_get_rate() is always accepted again */
+    ticks = CUBE_SLOT_TICKS(rate);
+    if (ticks < CUBE_SLOT_MIN + 1) {
+        ticks = CUBE_SLOT_MIN + 1;
+    }
+    else if (ticks > CUBE_SLOT_MAX + 1) {
+        ticks = CUBE_SLOT_MAX + 1;
+    }
+    cube_slot = (uint8_t)(ticks - 1);
+    cube_rate = rate;
+    /* Keep the dimming ratio */
+    cube_set_brightness(cube_brightness);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: cube_get_rate()
+ * Purpose:  Refresh rate of binary frames.
+ * Input:    None
+ * Returns:  Frames per second, rounded to the nearest
+ ******************************************************************************/
+uint16_t cube_get_rate(void)
+{
+    uint32_t ticks = (uint32_t)(cube_slot + 1) * CUBE_LAYERS;
+
+    return (uint16_t)((CUBE_TIMER_HZ + ticks / 2) / ticks);
+}
+
+/*******************************************************************************
+ * Function: cube_get_rate_setting()
+ * Purpose:  Rate last accepted by cube_set_rate().
+ * Input:    None
+ * Returns:  Frames per second, CUBE_RATE_DEFAULT before the first call
+ ******************************************************************************/
+uint16_t cube_get_rate_setting(void)
+{
+    return cube_rate;
+}
+
+/*******************************************************************************
+ * Function: cube_frame_count()
+ * Purpose:  Number of swaps since cube_init().
+ * Input:    None
+ * Returns:  Swap counter, wraps at 256
+ ******************************************************************************/
+uint8_t cube_frame_count(void)
+{
+    return cube_swaps;
+}
+
+#if CUBE_DRIVER == CUBE_DRIVER_DIRECT
+/*******************************************************************************
+ * Function: cube_output()
+ * Purpose:  Drive the columns of one layer and connect the layer to GND.
+ * Input:    frame - Frame or bit plane to show
+ *           layer - Layer to show
+ * Returns:  None
+ ******************************************************************************/
+static void cube_output(const cube_frame_t *frame, uint8_t layer)
+{
+    uint16_t mask = frame->column[layer][CUBE_RED] |
+                    frame->column[layer][CUBE_GREEN];
+
+    /* Columns 6..8 (mask bits 6..8) go to PD5..PD7 */
+    HAL_WRITE(PORTB, (HAL_READ(PORTB) & ~CUBE_PORTB_COLUMNS) |
+                     (mask & CUBE_PORTB_COLUMNS));
+    HAL_WRITE(PORTD, (HAL_READ(PORTD) & ~CUBE_PORTD_COLUMNS) |
+                     ((uint8_t)(mask >> 1) & CUBE_PORTD_COLUMNS));
+    HAL_CLEAR(PORTD, cube_layer_pin[layer]);
+}
+
+/*******************************************************************************
+ * Function: cube_blank()
+ * Purpose:  Disconnect every layer.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+static void cube_blank(void)
+{
+    HAL_SET(PORTD, CUBE_PORTD_LAYERS);
+}
+#else
+/*******************************************************************************
+ * Function: cube_output()
+ * Purpose:  Shift the columns of one layer and its GND bit into the chain.
+ * Input:    frame - Frame or bit plane to show
+ *           layer - Layer to show
+ * Returns:  None
+ * Note:     SR1: R8..R1, SR2: G7..G1 R9, SR3: GND3..GND1 x x x G9 G8
+ ******************************************************************************/
+static void cube_output(const cube_frame_t *frame, uint8_t layer)
+{
+    uint16_t red = frame->column[layer][CUBE_RED];
+    uint16_t green = frame->column[layer][CUBE_GREEN];
+    uint8_t sr3;
+
+    sr3 = (CUBE_SR3_IDLE & ~_BV(CUBE_SR3_LAYER_SHIFT + layer)) |
+          ((uint8_t)(green >> 7) & 0x03);
+    cube_shift(sr3,
+               (uint8_t)(green << 1) | ((uint8_t)(red >> 8) & 0x01),
+               (uint8_t)red);
+}
+
+/*******************************************************************************
+ * Function: cube_blank()
+ * Purpose:  Disconnect every layer.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+static void cube_blank(void)
+{
+    cube_shift(CUBE_SR3_IDLE, 0x00, 0x00);
+}
+
+/*******************************************************************************
+ * Function: cube_shift()
+ * Purpose:  Shift three bytes into the 74HC595 chain, SR3 first, MSB first,
+ *           and latch them.
+ * Input:    sr3, sr2, sr1 - Register contents
+ * Returns:  None
+ ******************************************************************************/
+static void cube_shift(uint8_t sr3, uint8_t sr2, uint8_t sr1)
+{
+    cube_latched = ((uint32_t)sr3 << 16) | ((uint16_t)sr2 << 8) | sr1;
+    cube_load(cube_latched);
+    HAL_SET(PORTD, _BV(LATCH_SHIFT));
+    HAL_CLEAR(PORTD, _BV(LATCH_SHIFT));
+}
+
+/*******************************************************************************
+ * Function: cube_load()
+ * Purpose:  Shift 24 bits into the 74HC595 chain without latching them.
+ * Input:    bits - SR3 in bits 23..16, SR2 in 15..8, SR1 in 7..0
+ * Returns:  None
+ * Note:     The pulses are several CPU cycles long, far above the minimum
+ *           pulse width of the 74HC595, no delays needed.
+ ******************************************************************************/
+static void cube_load(uint32_t bits)
+{
+    uint8_t i;
+
+    for (i = 0; i < 24; i++) {
+        if (bits & 0x800000UL) {
+            HAL_SET(PORTB, _BV(DATA_SHIFT));
+        }
+        else {
+            HAL_CLEAR(PORTB, _BV(DATA_SHIFT));
+        }
+        HAL_SET(PORTD, _BV(CLK_SHIFT));
+        HAL_CLEAR(PORTD, _BV(CLK_SHIFT));
+        bits <<= 1;
+    }
+}
+
+/*******************************************************************************
+ * Function: cube_reload()
+ * Purpose:  Refill the shift registers with the latched outputs, so a latch
+ *           edge from another device on LATCH_SHIFT changes nothing.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void cube_reload(void)
+{
+    cube_load(cube_latched);
+}
+#endif
+
+/**
+  * @brief Start of a layer slot, or of the next bit plane of a grey scale
+  *        frame: show it and set the length of the slot.
+  */
+ISR(TIMER2_COMPA_vect)
+{
+    const cube_image_t *image = cube_front;
+    uint8_t lag = 0;
+
+    /* The planes of a layer replace each other with one latch, anything
+     * else is blanked first */
+    if (cube_plane == 0 || !image->grey) {
+        lag = HAL_READ(TCNT2);
+        cube_blank();
+        lag = HAL_READ(TCNT2) - lag;
+    }
+    /* Planes of a layer from the most significant one down, then next layer */
+    if (cube_plane == 0) {
+        if (++cube_layer >= CUBE_LAYERS) {
+            cube_layer = 0;
+        }
+        cube_plane = image->grey ? CUBE_BAM_BITS : 1;
+    }
+    cube_plane--;
+
+    if (image->grey) {
+        /* Every plane ends with the latch of the next one, one output after
+         * the compare match. The first plane of a layer is latched the
+         * blank later, so it gets the blank time on top to keep the
+         * 1:2:4:8 ratio. */
+        HAL_WRITE(OCR2A, (CUBE_BAM_UNIT << cube_plane) - 1 + lag);
+        cube_output(&image->plane[cube_plane], cube_layer);
+    }
+    else {
+        HAL_WRITE(OCR2A, cube_slot);
+        if (cube_brightness) {
+            cube_output(&image->plane[0], cube_layer);
+        }
+    }
+}
+
+/**
+  * @brief Dimming: end the layer before the slot is over.
+  */
+ISR(TIMER2_COMPB_vect)
+{
+    if (!cube_front->grey && cube_brightness < CUBE_BRIGHTNESS_MAX) {
+        cube_blank();
+    }
+}
+
+/* END OF FILE ****************************************************************/
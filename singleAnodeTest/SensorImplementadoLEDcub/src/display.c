@@ -0,0 +1,273 @@
+/**
+  ******************************************************************************
+  * @file    display.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   HD44780 shadow buffer, changed cells go to the LCD queue.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include <string.h>
+#include "lcd.h"
+#include "display.h"
+
+#if DISPLAY_ENABLE
+/* Constants and macros ------------------------------------------------------*/
+#define DISPLAY_CELLS (LCD_LINES * LCD_DISP_LENGTH)
+
+/* Address counter of the LCD is not known, the next write sets it */
+#define DISPLAY_UNKNOWN 0xff
+
+/* Queue entries of a cell with address command */
+#define DISPLAY_CELL_ENTRIES 4
+
+/* Queue entries of a glyph: CGRAM address and its rows */
+#define DISPLAY_GLYPH_ENTRIES (2 * (1 + DISPLAY_GLYPH_ROWS))
+
+#if (DISPLAY_CELLS >= DISPLAY_UNKNOWN)
+# error "LCD too large for 8-bit cell indices"
+#endif
+
+/* Function prototypes -------------------------------------------------------*/
+static uint8_t display_address(uint8_t cell);
+
+/* Global variables ----------------------------------------------------------*/
+/* Text to show and text the LCD shows, indexed line * LCD_DISP_LENGTH + x */
+static char display_shadow[DISPLAY_CELLS];
+static char display_shown[DISPLAY_CELLS];
+
+/* Cursor of the shadow */
+static uint8_t display_cursor = 0;
+
+/* Glyphs of the CGRAM and glyphs changed since they were queued */
+static uint8_t display_glyphs[DISPLAY_GLYPHS][DISPLAY_GLYPH_ROWS];
+static uint8_t display_glyphs_changed = 0;
+
+/* Cell the LCD writes next */
+static uint8_t display_lcd_cell = DISPLAY_UNKNOWN;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: display_init()
+ * Purpose:  Queue the LCD initialization, which clears it, and clear both
+ *           buffers.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void display_init(void)
+{
+    lcd_init_async(LCD_DISP_ON);
+    memset(display_shown, ' ', DISPLAY_CELLS);
+    display_clear();
+    /* Clear leaves the address counter at the first cell */
+    display_lcd_cell = 0;
+    /* CGRAM content is undefined after power-on */
+    memset(display_glyphs, 0, sizeof(display_glyphs));
+    display_glyphs_changed = 0xff;
+}
+
+/*******************************************************************************
+ * Function: display_clear()
+ * Purpose:  Blank the shadow.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void display_clear(void)
+{
+    memset(display_shadow, ' ', DISPLAY_CELLS);
+    display_cursor = 0;
+}
+
+/*******************************************************************************
+ * Function: display_gotoxy()
+ * Purpose:  Move the cursor of the shadow.
+ * Input:    x - Column
+ *           y - Line
+ * Returns:  None
+ ******************************************************************************/
+void display_gotoxy(uint8_t x, uint8_t y)
+{
+    if (x >= LCD_DISP_LENGTH || y >= LCD_LINES) {
+        return;
+    }
+    display_cursor = y * LCD_DISP_LENGTH + x;
+}
+
+/*******************************************************************************
+ * Function: display_putc()
+ * Purpose:  Write a character into the shadow.
+ * Input:    c - Character
+ * Returns:  None
+ ******************************************************************************/
+void display_putc(char c)
+{
+    uint8_t line = display_cursor / LCD_DISP_LENGTH;
+
+    if (c == '\n') {
+        display_cursor = (line + 1 < LCD_LINES) ? (line + 1) * LCD_DISP_LENGTH
+                                                : DISPLAY_CELLS;
+        return;
+    }
+    if (display_cursor >= DISPLAY_CELLS) {
+        return;
+    }
+    display_shadow[display_cursor] = c;
+    /* Stay behind the last column until a newline or gotoxy */
+    if ((display_cursor + 1) % LCD_DISP_LENGTH) {
+        display_cursor++;
+    }
+    else {
+        display_cursor = DISPLAY_CELLS;
+    }
+}
+
+/*******************************************************************************
+ * Function: display_puts()
+ * Purpose:  Write a string into the shadow.
+ * Input:    s - String
+ * Returns:  None
+ ******************************************************************************/
+void display_puts(const char *s)
+{
+    while (*s) {
+        display_putc(*s++);
+    }
+}
+
+/*******************************************************************************
+ * Function: display_puts_p()
+ * Purpose:  Write a string from program memory into the shadow.
+ * Input:    progmem_s - String in program memory
+ * Returns:  None
+ ******************************************************************************/
+void display_puts_p(const char *progmem_s)
+{
+    char c;
+
+    while ((c = pgm_read_byte(progmem_s++))) {
+        display_putc(c);
+    }
+}
+
+/*******************************************************************************
+ * Function: display_glyph()
+ * Purpose:  Define a user glyph, it is queued only if it changed.
+ * Input:    index - Glyph
+ *           rows - DISPLAY_GLYPH_ROWS rows, bit 4 is the leftmost pixel
+ * Returns:  None
+ ******************************************************************************/
+void display_glyph(uint8_t index, const uint8_t *rows)
+{
+    if (index >= DISPLAY_GLYPHS ||
+        memcmp(display_glyphs[index], rows, DISPLAY_GLYPH_ROWS) == 0) {
+        return;
+    }
+    memcpy(display_glyphs[index], rows, DISPLAY_GLYPH_ROWS);
+    display_glyphs_changed |= _BV(index);
+}
+
+/*******************************************************************************
+ * Function: display_pending()
+ * Purpose:  Count the cells that differ from the LCD.
+ * Input:    None
+ * Returns:  Number of changed cells
+ ******************************************************************************/
+uint8_t display_pending(void)
+{
+    uint8_t cell, count = 0;
+
+    for (cell = 0; cell < DISPLAY_CELLS; cell++) {
+        count += display_shadow[cell] != display_shown[cell];
+    }
+    return count;
+}
+
+/*******************************************************************************
+ * Function: display_task()
+ * Purpose:  Queue changed glyphs, then changed cells with the address
+ *           commands to reach them, while the LCD queue has room.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void display_task(void)
+{
+    uint8_t cell, i;
+
+    /* Changed glyphs first, cells showing them change with them */
+    for (i = 0; i < DISPLAY_GLYPHS; i++) {
+        if (!(display_glyphs_changed & _BV(i))) {
+            continue;
+        }
+        if (lcd_queue_free() < DISPLAY_GLYPH_ENTRIES) {
+            return;
+        }
+        lcd_queue_command(_BV(LCD_CGRAM) | (i * DISPLAY_GLYPH_ROWS));
+        for (cell = 0; cell < DISPLAY_GLYPH_ROWS; cell++) {
+            lcd_queue_data(display_glyphs[i][cell]);
+        }
+        display_glyphs_changed &= ~_BV(i);
+        /* The address counter now points into the CGRAM */
+        display_lcd_cell = DISPLAY_UNKNOWN;
+    }
+
+    while (lcd_queue_free() >= DISPLAY_CELL_ENTRIES) {
+        /* Search from the address counter on, so runs of changed cells are
+         * sent without address commands */
+        cell = (display_lcd_cell < DISPLAY_CELLS) ? display_lcd_cell : 0;
+        for (i = 0; i < DISPLAY_CELLS; i++) {
+            if (display_shadow[cell] != display_shown[cell]) {
+                break;
+            }
+            if (++cell == DISPLAY_CELLS) {
+                cell = 0;
+            }
+        }
+        if (i == DISPLAY_CELLS) {
+            return;
+        }
+
+        if (cell != display_lcd_cell) {
+            lcd_queue_command(_BV(LCD_DDRAM) | display_address(cell));
+        }
+        display_shown[cell] = display_shadow[cell];
+        lcd_queue_data(display_shown[cell]);
+        /* The address counter does not wrap to the next line */
+        cell++;
+        display_lcd_cell = (cell % LCD_DISP_LENGTH) ? cell : DISPLAY_UNKNOWN;
+    }
+}
+
+/*******************************************************************************
+ * Function: display_address()
+ * Purpose:  DDRAM address of a cell.
+ * Input:    cell - Cell index
+ * Returns:  Address
+ ******************************************************************************/
+static uint8_t display_address(uint8_t cell)
+{
+    uint8_t x = cell % LCD_DISP_LENGTH;
+
+#if LCD_LINES == 1
+    return LCD_START_LINE1 + x;
+#elif LCD_LINES == 2
+    return ((cell < LCD_DISP_LENGTH) ? LCD_START_LINE1 : LCD_START_LINE2) + x;
+#else
+    switch (cell / LCD_DISP_LENGTH) {
+    case 0:
+        return LCD_START_LINE1 + x;
+    case 1:
+        return LCD_START_LINE2 + x;
+    case 2:
+        return LCD_START_LINE3 + x;
+    default:
+        return LCD_START_LINE4 + x;
+    }
+#endif
+}
+
+#endif /* DISPLAY_ENABLE */
+
+/* END OF FILE ****************************************************************/
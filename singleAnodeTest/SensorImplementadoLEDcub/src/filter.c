@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file    filter.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Median + exponential moving average filter in Q8.8 fixed point.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hal.h"
+#include "filter.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* DHT12 sign flag in the decimal register */
+#define DHT12_NEGATIVE 0x80
+
+/* Global variables ----------------------------------------------------------*/
+/* Tenths 0..9 expressed in 1/256, rounded: round(n * 25.6) */
+static const uint8_t tenths_to_q8[10] PROGMEM = {
+    0, 26, 51, 77, 102, 128, 154, 179, 205, 230};
+
+/* Function prototypes -------------------------------------------------------*/
+static int16_t filter_median(const filter_t *f);
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: filter_init()
+ * Purpose:  Reset a filter channel.
+ * Input:    f - Filter channel
+ * Returns:  None
+ ******************************************************************************/
+void filter_init(filter_t *f)
+{
+    f->index = 0;
+    f->primed = 0;
+    f->ema = 0;
+}
+
+/*******************************************************************************
+ * Function: filter_dht12_to_q8()
+ * Purpose:  Convert a DHT12 integer/decimal register pair to Q8.8.
+ * Input:    integer - Integer part register
+ *           decimal - Tenths in bits 6..0, sign in bit 7
+ * Returns:  Value in Q8.8
+ ******************************************************************************/
+int16_t filter_dht12_to_q8(uint8_t integer, uint8_t decimal)
+{
+    uint8_t tenths = decimal & ~DHT12_NEGATIVE;
+    int16_t value;
+
+    if (tenths > 9) {
+        tenths = 9;
+    }
+    value = ((int16_t)integer << 8) + pgm_read_byte(&tenths_to_q8[tenths]);
+    if (decimal & DHT12_NEGATIVE) {
+        value = -value;
+    }
+    return value;
+}
+
+/*******************************************************************************
+ * Function: filter_update()
+ * Purpose:  Feed one raw sample through the median window and the EMA.
+ * Input:    f - Filter channel
+ *           sample - New sample in Q8.8
+ * Returns:  Filtered value in hundredths
+ ******************************************************************************/
+int16_t filter_update(filter_t *f, int16_t sample)
+{
+    uint8_t i;
+    int16_t median;
+
+    if (!f->primed) {
+        /* Start from the first reading instead of ramping up from zero */
+        for (i = 0; i < FILTER_MEDIAN_LEN; i++) {
+            f->window[i] = sample;
+        }
+        f->ema = sample;
+        f->primed = 1;
+    }
+
+    f->window[f->index] = sample;
+    if (++f->index >= FILTER_MEDIAN_LEN) {
+        f->index = 0;
+    }
+
+    /* ema += (median - ema) / 2^FILTER_EMA_SHIFT */
+    median = filter_median(f);
+    f->ema += (int16_t)(((int32_t)median - f->ema) >> FILTER_EMA_SHIFT);
+
+    return filter_q8_to_centi(f->ema);
+}
+
+/*******************************************************************************
+ * Function: filter_q8_to_centi()
+ * Purpose:  Convert Q8.8 to hundredths with rounding.
+ * Input:    q8 - Value in Q8.8
+ * Returns:  Value in hundredths
+ ******************************************************************************/
+int16_t filter_q8_to_centi(int16_t q8)
+{
+    return (int16_t)(((int32_t)q8 * 100 + 128) >> 8);
+}
+
+/*******************************************************************************
+ * Function: filter_median()
+ * Purpose:  Median of the samples in the window.
+ * Input:    f - Filter channel
+ * Returns:  Median value in Q8.8
+ ******************************************************************************/
+static int16_t filter_median(const filter_t *f)
+{
+#if FILTER_MEDIAN_LEN == 3
+    int16_t a = f->window[0];
+    int16_t b = f->window[1];
+    int16_t c = f->window[2];
+
+    if (a > b) {
+        int16_t t = a;
+        a = b;
+        b = t;
+    }
+    /* a <= b, median is b clamped to [a, c] */
+    if (b > c) {
+        b = (a > c) ? a : c;
+    }
+    return b;
+#else
+    int16_t sorted[FILTER_MEDIAN_LEN];
+    int16_t v;
+    uint8_t i, j;
+
+    /* Insertion sort of a copy, at most 10 compares for 5 samples */
+    for (i = 0; i < FILTER_MEDIAN_LEN; i++) {
+        v = f->window[i];
+        for (j = i; j > 0 && sorted[j - 1] > v; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+    return sorted[FILTER_MEDIAN_LEN / 2];
+#endif
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,149 @@
+/**
+  ******************************************************************************
+  * @file    fmt.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Decimal, fixed-point and hexadecimal output without buffers.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include "uart.h"
+#include "fmt.h"
+
+/* Function prototypes -------------------------------------------------------*/
+static void fmt_uart(char c);
+static void fmt_digits(fmt_putc_t put, uint32_t value, uint8_t decimals);
+
+/* Global variables ----------------------------------------------------------*/
+static const uint32_t fmt_powers[] PROGMEM = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+    1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+#define FMT_PLACES ((uint8_t)(sizeof(fmt_powers) / sizeof(fmt_powers[0])))
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: fmt_udec()
+ * Purpose:  Print an unsigned decimal number.
+ * Input:    value - Number
+ * Returns:  None
+ ******************************************************************************/
+void fmt_udec(uint32_t value)
+{
+    fmt_digits(fmt_uart, value, 0);
+}
+
+/*******************************************************************************
+ * Function: fmt_dec()
+ * Purpose:  Print a signed decimal number.
+ * Input:    value - Number
+ * Returns:  None
+ ******************************************************************************/
+void fmt_dec(int32_t value)
+{
+    fmt_fixed(value, 0);
+}
+
+/*******************************************************************************
+ * Function: fmt_fixed()
+ * Purpose:  Print a fixed-point number, e.g. 274 with 1 decimal as 27.4.
+ * Input:    value - Number in units of 10^-decimals
+ *           decimals - Digits after the point
+ * Returns:  None
+ ******************************************************************************/
+void fmt_fixed(int32_t value, uint8_t decimals)
+{
+    fmt_fixed_to(fmt_uart, value, decimals);
+}
+
+/*******************************************************************************
+ * Function: fmt_fixed_to()
+ * Purpose:  Print a fixed-point number through another output.
+ * Input:    put - Character output, e.g. display_putc
+ *           value - Number in units of 10^-decimals
+ *           decimals - Digits after the point
+ * Returns:  None
+ ******************************************************************************/
+void fmt_fixed_to(fmt_putc_t put, int32_t value, uint8_t decimals)
+{
+    uint32_t u = value;
+
+    if (value < 0) {
+        put('-');
+        u = -(uint32_t)value;
+    }
+    fmt_digits(put, u, decimals);
+}
+
+/*******************************************************************************
+ * Function: fmt_hex()
+ * Purpose:  Print hexadecimal digits, most significant first.
+ * Input:    value - Number
+ *           digits - Digits to print
+ * Returns:  None
+ ******************************************************************************/
+void fmt_hex(uint32_t value, uint8_t digits)
+{
+    uint8_t nibble;
+
+    while (digits--) {
+        nibble = (value >> (4 * digits)) & 0x0f;
+        uart_putc(nibble < 10 ? '0' + nibble : 'a' - 10 + nibble);
+    }
+}
+
+/*******************************************************************************
+ * Function: fmt_uart()
+ * Purpose:  Default output, the UART transmit ringbuffer.
+ * Input:    c - Character
+ * Returns:  None
+ ******************************************************************************/
+static void fmt_uart(char c)
+{
+    uart_putc(c);
+}
+
+/*******************************************************************************
+ * Function: fmt_digits()
+ * Purpose:  Print a number digit by digit, suppressing leading zeros but
+ *           keeping one digit before the point.
+ * Input:    put - Character output
+ *           value - Number
+ *           decimals - Digits after the point
+ * Returns:  None
+ ******************************************************************************/
+static void fmt_digits(fmt_putc_t put, uint32_t value, uint8_t decimals)
+{
+    uint8_t place = FMT_PLACES;
+    uint8_t started = 0;
+    uint32_t power;
+    char digit;
+
+    if (decimals > FMT_DECIMALS_MAX) {
+        decimals = FMT_DECIMALS_MAX;
+    }
+    while (place--) {
+        /* At most 9 subtractions per digit, cheaper than a 32 bit division */
+        power = pgm_read_dword(&fmt_powers[place]);
+        digit = '0';
+        while (value >= power) {
+            value -= power;
+            digit++;
+        }
+        if (digit != '0' || place <= decimals) {
+            started = 1;
+        }
+        if (started) {
+            put(digit);
+            if (place == decimals && decimals) {
+                put('.');
+            }
+        }
+    }
+}
+
+/* END OF FILE ****************************************************************/
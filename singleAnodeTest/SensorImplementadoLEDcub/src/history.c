@@ -0,0 +1,202 @@
+/**
+  ******************************************************************************
+  * @file    history.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Sample window with rolling min/max (monotonic queues), mean and
+  *          least-squares slope (running sums).
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "history.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define HISTORY_MASK (HISTORY_SIZE - 1)
+
+/* sum(x) for x = 0 .. N-1 */
+#define HISTORY_SUM_X ((int32_t)HISTORY_SIZE * (HISTORY_SIZE - 1) / 2)
+
+/* Sample stored under a sequence number */
+#define history_value(h, s) ((h)->sample[(s) & HISTORY_MASK])
+
+/* Function prototypes -------------------------------------------------------*/
+static void history_insert(history_t *h, int16_t value);
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: history_init()
+ * Purpose:  Clear the window.
+ * Input:    h - History instance
+ * Returns:  None
+ ******************************************************************************/
+void history_init(history_t *h)
+{
+    h->min_first = 0;
+    h->min_count = 0;
+    h->max_first = 0;
+    h->max_count = 0;
+    h->seq = 0;
+    h->primed = 0;
+    h->sum = 0;
+    h->weighted = 0;
+}
+
+/*******************************************************************************
+ * Function: history_push()
+ * Purpose:  Append one sample and update all running statistics.
+ * Input:    h - History instance
+ *           value - New sample
+ * Returns:  None
+ ******************************************************************************/
+void history_push(history_t *h, int16_t value)
+{
+    uint8_t i;
+
+    if (!h->primed) {
+        /* Fill the window with the first sample, the trend starts flat.
+         * The sums are set afterwards, the inserts only build the queues. */
+        h->primed = 1;
+        for (i = 0; i < HISTORY_SIZE; i++) {
+            h->sample[i] = value;
+            history_insert(h, value);
+        }
+        h->sum = (int32_t)value * HISTORY_SIZE;
+        h->weighted = (int32_t)value * HISTORY_SUM_X;
+        return;
+    }
+    history_insert(h, value);
+}
+
+/*******************************************************************************
+ * Function: history_insert()
+ * Purpose:  Replace the oldest sample with a new one.
+ * Input:    h - History instance
+ *           value - New sample
+ * Returns:  None
+ ******************************************************************************/
+static void history_insert(history_t *h, int16_t value)
+{
+    uint8_t seq = h->seq;
+    uint8_t expired = (uint8_t)(seq - HISTORY_SIZE);
+    int16_t oldest = history_value(h, seq);
+    uint8_t back;
+
+    /* Drop the queue heads that leave the window with this sample */
+    if (h->min_count && h->min_queue[h->min_first] == expired) {
+        h->min_first = (h->min_first + 1) & HISTORY_MASK;
+        h->min_count--;
+    }
+    if (h->max_count && h->max_queue[h->max_first] == expired) {
+        h->max_first = (h->max_first + 1) & HISTORY_MASK;
+        h->max_count--;
+    }
+
+    /* Slide the window: x of every remaining sample decreases by one.
+     * weighted' = weighted - (sum - oldest) + (N - 1) * value */
+    h->sum -= oldest;
+    h->weighted -= h->sum;
+    h->sum += value;
+    h->weighted += (int32_t)value * (HISTORY_SIZE - 1);
+    history_value(h, seq) = value;
+
+    /* Minimum queue keeps increasing values: pop larger ones from the back */
+    while (h->min_count) {
+        back = (h->min_first + h->min_count - 1) & HISTORY_MASK;
+        if (history_value(h, h->min_queue[back]) < value) {
+            break;
+        }
+        h->min_count--;
+    }
+    h->min_queue[(h->min_first + h->min_count) & HISTORY_MASK] = seq;
+    h->min_count++;
+
+    /* Maximum queue keeps decreasing values */
+    while (h->max_count) {
+        back = (h->max_first + h->max_count - 1) & HISTORY_MASK;
+        if (history_value(h, h->max_queue[back]) > value) {
+            break;
+        }
+        h->max_count--;
+    }
+    h->max_queue[(h->max_first + h->max_count) & HISTORY_MASK] = seq;
+    h->max_count++;
+
+    h->seq = seq + 1;
+}
+
+/*******************************************************************************
+ * Function: history_min()
+ * Purpose:  Smallest sample in the window, head of the minimum queue.
+ * Input:    h - History instance
+ * Returns:  Minimum
+ ******************************************************************************/
+int16_t history_min(const history_t *h)
+{
+    return history_value(h, h->min_queue[h->min_first]);
+}
+
+/*******************************************************************************
+ * Function: history_max()
+ * Purpose:  Largest sample in the window, head of the maximum queue.
+ * Input:    h - History instance
+ * Returns:  Maximum
+ ******************************************************************************/
+int16_t history_max(const history_t *h)
+{
+    return history_value(h, h->max_queue[h->max_first]);
+}
+
+/*******************************************************************************
+ * Function: history_mean()
+ * Purpose:  Rounded mean of the window.
+ * Input:    h - History instance
+ * Returns:  Mean
+ ******************************************************************************/
+int16_t history_mean(const history_t *h)
+{
+    return (int16_t)((h->sum + HISTORY_SIZE / 2) >> HISTORY_SHIFT);
+}
+
+/*******************************************************************************
+ * Function: history_slope()
+ * Purpose:  Least-squares slope numerator N * sum(xy) - sum(x) * sum(y).
+ * Input:    h - History instance
+ * Returns:  Slope per sample multiplied by HISTORY_SLOPE_DIV
+ ******************************************************************************/
+int32_t history_slope(const history_t *h)
+{
+    return h->weighted * HISTORY_SIZE - HISTORY_SUM_X * h->sum;
+}
+
+/*******************************************************************************
+ * Function: history_trend()
+ * Purpose:  Compare the slope with a deadband without dividing.
+ * Input:    h - History instance
+ *           deadband - Minimum slope in units per sample, clamped so that
+ *                      the limit does not overflow
+ * Returns:  1 rising, 0 flat, -1 falling
+ ******************************************************************************/
+int8_t history_trend(const history_t *h, int16_t deadband)
+{
+    int32_t slope = history_slope(h);
+    int32_t limit;
+
+    if (deadband < 0) {
+        deadband = 0;
+    }
+    else if (deadband > HISTORY_DEADBAND_MAX) {
+        deadband = HISTORY_DEADBAND_MAX;
+    }
+    limit = (int32_t)deadband * HISTORY_SLOPE_DIV;
+
+    if (slope > limit) {
+        return 1;
+    }
+    if (slope < -limit) {
+        return -1;
+    }
+    return 0;
+}
+
+/* END OF FILE ****************************************************************/
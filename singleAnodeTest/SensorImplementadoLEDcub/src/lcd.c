@@ -26,33 +26,32 @@
 #include "settings.h"
 
 #include <inttypes.h>
-#include <avr/io.h>
-#include <avr/pgmspace.h>
-#include <util/delay.h>
+#include "hal.h"
 #include "lcd.h"
+#include "bus.h"
 
 
 /*
 ** constants/macros
 */
-#define DDR(x) (*(&x - 1)) /* address of data direction register of port x */
+#define DDR(x) HAL_DDR(x) /* address of data direction register of port x */
 #if defined(__AVR_ATmega64__) || defined(__AVR_ATmega128__)
 /* on ATmega64/128 PINF is on port 0x00 and not 0x60 */
 # define PIN(x) ( &PORTF == &(x) ? _SFR_IO8(0x00) : (*(&x - 2)) )
 #else
-# define PIN(x) (*(&x - 2)) /* address of input register of port x          */
+# define PIN(x) HAL_PIN(x) /* address of input register of port x          */
 #endif
 
 
 #if LCD_IO_MODE
 # define lcd_e_delay()  _delay_us(LCD_DELAY_ENABLE_PULSE)
-# define lcd_e_high()   LCD_E_PORT |= _BV(LCD_E_PIN);
-# define lcd_e_low()    LCD_E_PORT &= ~_BV(LCD_E_PIN);
+# define lcd_e_high()   HAL_SET(LCD_E_PORT, _BV(LCD_E_PIN));
+# define lcd_e_low()    HAL_CLEAR(LCD_E_PORT, _BV(LCD_E_PIN));
 # define lcd_e_toggle() toggle_e()
-# define lcd_rw_high()  LCD_RW_PORT |= _BV(LCD_RW_PIN)
-# define lcd_rw_low()   LCD_RW_PORT &= ~_BV(LCD_RW_PIN)
-# define lcd_rs_high()  LCD_RS_PORT |= _BV(LCD_RS_PIN)
-# define lcd_rs_low()   LCD_RS_PORT &= ~_BV(LCD_RS_PIN)
+# define lcd_rw_high()  HAL_SET(LCD_RW_PORT, _BV(LCD_RW_PIN))
+# define lcd_rw_low()   HAL_CLEAR(LCD_RW_PORT, _BV(LCD_RW_PIN))
+# define lcd_rs_high()  HAL_SET(LCD_RS_PORT, _BV(LCD_RS_PIN))
+# define lcd_rs_low()   HAL_CLEAR(LCD_RS_PORT, _BV(LCD_RS_PIN))
 #endif
 
 #if LCD_IO_MODE
@@ -135,59 +134,59 @@ static void lcd_write(uint8_t data, uint8_t rs)
     /* FRYZA: RW PIN NOT IMPLEMENTED */
     /*lcd_rw_low();*/    /* RW=0  write mode      */
 
-    if ( ( &LCD_DATA0_PORT == &LCD_DATA1_PORT) && ( &LCD_DATA1_PORT == &LCD_DATA2_PORT ) && ( &LCD_DATA2_PORT == &LCD_DATA3_PORT ) &&
+    if ( ( HAL_SAME(LCD_DATA0_PORT, LCD_DATA1_PORT)) && ( HAL_SAME(LCD_DATA1_PORT, LCD_DATA2_PORT) ) && ( HAL_SAME(LCD_DATA2_PORT, LCD_DATA3_PORT) ) &&
       (LCD_DATA0_PIN == 0) && (LCD_DATA1_PIN == 1) && (LCD_DATA2_PIN == 2) && (LCD_DATA3_PIN == 3) )
     {
         /* configure data pins as output */
-        DDR(LCD_DATA0_PORT) |= 0x0F;
+        HAL_SET(DDR(LCD_DATA0_PORT), 0x0F);
 
         /* output high nibble first */
-        dataBits       = LCD_DATA0_PORT & 0xF0;
-        LCD_DATA0_PORT = dataBits | ((data >> 4) & 0x0F);
+        dataBits       = HAL_READ(LCD_DATA0_PORT) & 0xF0;
+        HAL_WRITE(LCD_DATA0_PORT, dataBits | ((data >> 4) & 0x0F));
         lcd_e_toggle();
 
         /* output low nibble */
-        LCD_DATA0_PORT = dataBits | (data & 0x0F);
+        HAL_WRITE(LCD_DATA0_PORT, dataBits | (data & 0x0F));
         lcd_e_toggle();
 
         /* all data pins high (inactive) */
-        LCD_DATA0_PORT = dataBits | 0x0F;
+        HAL_WRITE(LCD_DATA0_PORT, dataBits | 0x0F);
     }
     else
     {
         /* configure data pins as output */
-        DDR(LCD_DATA0_PORT) |= _BV(LCD_DATA0_PIN);
-        DDR(LCD_DATA1_PORT) |= _BV(LCD_DATA1_PIN);
-        DDR(LCD_DATA2_PORT) |= _BV(LCD_DATA2_PIN);
-        DDR(LCD_DATA3_PORT) |= _BV(LCD_DATA3_PIN);
+        HAL_SET(DDR(LCD_DATA0_PORT), _BV(LCD_DATA0_PIN));
+        HAL_SET(DDR(LCD_DATA1_PORT), _BV(LCD_DATA1_PIN));
+        HAL_SET(DDR(LCD_DATA2_PORT), _BV(LCD_DATA2_PIN));
+        HAL_SET(DDR(LCD_DATA3_PORT), _BV(LCD_DATA3_PIN));
 
         /* output high nibble first */
-        LCD_DATA3_PORT &= ~_BV(LCD_DATA3_PIN);
-        LCD_DATA2_PORT &= ~_BV(LCD_DATA2_PIN);
-        LCD_DATA1_PORT &= ~_BV(LCD_DATA1_PIN);
-        LCD_DATA0_PORT &= ~_BV(LCD_DATA0_PIN);
-        if (data & 0x80) LCD_DATA3_PORT |= _BV(LCD_DATA3_PIN);
-        if (data & 0x40) LCD_DATA2_PORT |= _BV(LCD_DATA2_PIN);
-        if (data & 0x20) LCD_DATA1_PORT |= _BV(LCD_DATA1_PIN);
-        if (data & 0x10) LCD_DATA0_PORT |= _BV(LCD_DATA0_PIN);
+        HAL_CLEAR(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+        HAL_CLEAR(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+        HAL_CLEAR(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+        HAL_CLEAR(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+        if (data & 0x80) HAL_SET(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+        if (data & 0x40) HAL_SET(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+        if (data & 0x20) HAL_SET(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+        if (data & 0x10) HAL_SET(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
         lcd_e_toggle();
 
         /* output low nibble */
-        LCD_DATA3_PORT &= ~_BV(LCD_DATA3_PIN);
-        LCD_DATA2_PORT &= ~_BV(LCD_DATA2_PIN);
-        LCD_DATA1_PORT &= ~_BV(LCD_DATA1_PIN);
-        LCD_DATA0_PORT &= ~_BV(LCD_DATA0_PIN);
-        if (data & 0x08) LCD_DATA3_PORT |= _BV(LCD_DATA3_PIN);
-        if (data & 0x04) LCD_DATA2_PORT |= _BV(LCD_DATA2_PIN);
-        if (data & 0x02) LCD_DATA1_PORT |= _BV(LCD_DATA1_PIN);
-        if (data & 0x01) LCD_DATA0_PORT |= _BV(LCD_DATA0_PIN);
+        HAL_CLEAR(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+        HAL_CLEAR(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+        HAL_CLEAR(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+        HAL_CLEAR(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+        if (data & 0x08) HAL_SET(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+        if (data & 0x04) HAL_SET(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+        if (data & 0x02) HAL_SET(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+        if (data & 0x01) HAL_SET(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
         lcd_e_toggle();
 
         /* all data pins high (inactive) */
-        LCD_DATA0_PORT |= _BV(LCD_DATA0_PIN);
-        LCD_DATA1_PORT |= _BV(LCD_DATA1_PIN);
-        LCD_DATA2_PORT |= _BV(LCD_DATA2_PIN);
-        LCD_DATA3_PORT |= _BV(LCD_DATA3_PIN);
+        HAL_SET(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+        HAL_SET(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+        HAL_SET(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+        HAL_SET(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
 
         /* FRYZA: EXPERIMENTALLY ADDED FOR ARDUINO UNO */
         _delay_ms(2);
@@ -219,39 +218,39 @@ static uint8_t lcd_read(uint8_t rs)
         lcd_rs_low();  /* RS=0: read busy flag */
     lcd_rw_high();     /* RW=1  read mode      */
 
-    if ( ( &LCD_DATA0_PORT == &LCD_DATA1_PORT) && ( &LCD_DATA1_PORT == &LCD_DATA2_PORT ) && ( &LCD_DATA2_PORT == &LCD_DATA3_PORT ) &&
+    if ( ( HAL_SAME(LCD_DATA0_PORT, LCD_DATA1_PORT)) && ( HAL_SAME(LCD_DATA1_PORT, LCD_DATA2_PORT) ) && ( HAL_SAME(LCD_DATA2_PORT, LCD_DATA3_PORT) ) &&
       ( LCD_DATA0_PIN == 0 ) && (LCD_DATA1_PIN == 1) && (LCD_DATA2_PIN == 2) && (LCD_DATA3_PIN == 3) )
     {
-        DDR(LCD_DATA0_PORT) &= 0xF0; /* configure data pins as input */
+        HAL_WRITE(DDR(LCD_DATA0_PORT), HAL_READ(DDR(LCD_DATA0_PORT)) & 0xF0); /* configure data pins as input */
 
         lcd_e_high();
         lcd_e_delay();
-        data = PIN(LCD_DATA0_PORT) << 4; /* read high nibble first */
+        data = HAL_READ(PIN(LCD_DATA0_PORT)) << 4; /* read high nibble first */
         lcd_e_low();
 
         lcd_e_delay(); /* Enable 500ns low       */
 
         lcd_e_high();
         lcd_e_delay();
-        data |= PIN(LCD_DATA0_PORT) & 0x0F; /* read low nibble        */
+        data |= HAL_READ(PIN(LCD_DATA0_PORT)) & 0x0F; /* read low nibble        */
         lcd_e_low();
     }
     else
     {
         /* configure data pins as input */
-        DDR(LCD_DATA0_PORT) &= ~_BV(LCD_DATA0_PIN);
-        DDR(LCD_DATA1_PORT) &= ~_BV(LCD_DATA1_PIN);
-        DDR(LCD_DATA2_PORT) &= ~_BV(LCD_DATA2_PIN);
-        DDR(LCD_DATA3_PORT) &= ~_BV(LCD_DATA3_PIN);
+        HAL_CLEAR(DDR(LCD_DATA0_PORT), _BV(LCD_DATA0_PIN));
+        HAL_CLEAR(DDR(LCD_DATA1_PORT), _BV(LCD_DATA1_PIN));
+        HAL_CLEAR(DDR(LCD_DATA2_PORT), _BV(LCD_DATA2_PIN));
+        HAL_CLEAR(DDR(LCD_DATA3_PORT), _BV(LCD_DATA3_PIN));
 
         /* read high nibble first */
         lcd_e_high();
         lcd_e_delay();
         data = 0;
-        if (PIN(LCD_DATA0_PORT) & _BV(LCD_DATA0_PIN) ) data |= 0x10;
-        if (PIN(LCD_DATA1_PORT) & _BV(LCD_DATA1_PIN) ) data |= 0x20;
-        if (PIN(LCD_DATA2_PORT) & _BV(LCD_DATA2_PIN) ) data |= 0x40;
-        if (PIN(LCD_DATA3_PORT) & _BV(LCD_DATA3_PIN) ) data |= 0x80;
+        if (HAL_READ(PIN(LCD_DATA0_PORT)) & _BV(LCD_DATA0_PIN) ) data |= 0x10;
+        if (HAL_READ(PIN(LCD_DATA1_PORT)) & _BV(LCD_DATA1_PIN) ) data |= 0x20;
+        if (HAL_READ(PIN(LCD_DATA2_PORT)) & _BV(LCD_DATA2_PIN) ) data |= 0x40;
+        if (HAL_READ(PIN(LCD_DATA3_PORT)) & _BV(LCD_DATA3_PIN) ) data |= 0x80;
         lcd_e_low();
 
         lcd_e_delay(); /* Enable 500ns low       */
@@ -259,10 +258,10 @@ static uint8_t lcd_read(uint8_t rs)
         /* read low nibble */
         lcd_e_high();
         lcd_e_delay();
-        if (PIN(LCD_DATA0_PORT) & _BV(LCD_DATA0_PIN) ) data |= 0x01;
-        if (PIN(LCD_DATA1_PORT) & _BV(LCD_DATA1_PIN) ) data |= 0x02;
-        if (PIN(LCD_DATA2_PORT) & _BV(LCD_DATA2_PIN) ) data |= 0x04;
-        if (PIN(LCD_DATA3_PORT) & _BV(LCD_DATA3_PIN) ) data |= 0x08;
+        if (HAL_READ(PIN(LCD_DATA0_PORT)) & _BV(LCD_DATA0_PIN) ) data |= 0x01;
+        if (HAL_READ(PIN(LCD_DATA1_PORT)) & _BV(LCD_DATA1_PIN) ) data |= 0x02;
+        if (HAL_READ(PIN(LCD_DATA2_PORT)) & _BV(LCD_DATA2_PIN) ) data |= 0x04;
+        if (HAL_READ(PIN(LCD_DATA3_PORT)) & _BV(LCD_DATA3_PIN) ) data |= 0x08;
         lcd_e_low();
     }
     return data;
@@ -511,39 +510,39 @@ void lcd_init(uint8_t dispAttr)
      *  Initialize LCD to 4 bit I/O mode
      */
 
-    if ( ( &LCD_DATA0_PORT == &LCD_DATA1_PORT) && ( &LCD_DATA1_PORT == &LCD_DATA2_PORT ) && ( &LCD_DATA2_PORT == &LCD_DATA3_PORT ) &&
-      ( &LCD_RS_PORT == &LCD_DATA0_PORT) && ( &LCD_RW_PORT == &LCD_DATA0_PORT) && (&LCD_E_PORT == &LCD_DATA0_PORT) &&
+    if ( ( HAL_SAME(LCD_DATA0_PORT, LCD_DATA1_PORT)) && ( HAL_SAME(LCD_DATA1_PORT, LCD_DATA2_PORT) ) && ( HAL_SAME(LCD_DATA2_PORT, LCD_DATA3_PORT) ) &&
+      ( HAL_SAME(LCD_RS_PORT, LCD_DATA0_PORT)) && ( HAL_SAME(LCD_RW_PORT, LCD_DATA0_PORT)) && (HAL_SAME(LCD_E_PORT, LCD_DATA0_PORT)) &&
       (LCD_DATA0_PIN == 0 ) && (LCD_DATA1_PIN == 1) && (LCD_DATA2_PIN == 2) && (LCD_DATA3_PIN == 3) &&
       (LCD_RS_PIN == 4 ) && (LCD_RW_PIN == 5) && (LCD_E_PIN == 6 ) )
     {
         /* configure all port bits as output (all LCD lines on same port) */
-        DDR(LCD_DATA0_PORT) |= 0x7F;
+        HAL_SET(DDR(LCD_DATA0_PORT), 0x7F);
     }
-    else if ( ( &LCD_DATA0_PORT == &LCD_DATA1_PORT) && ( &LCD_DATA1_PORT == &LCD_DATA2_PORT ) && ( &LCD_DATA2_PORT == &LCD_DATA3_PORT ) &&
+    else if ( ( HAL_SAME(LCD_DATA0_PORT, LCD_DATA1_PORT)) && ( HAL_SAME(LCD_DATA1_PORT, LCD_DATA2_PORT) ) && ( HAL_SAME(LCD_DATA2_PORT, LCD_DATA3_PORT) ) &&
       (LCD_DATA0_PIN == 0 ) && (LCD_DATA1_PIN == 1) && (LCD_DATA2_PIN == 2) && (LCD_DATA3_PIN == 3) )
     {
         /* configure all port bits as output (all LCD data lines on same port, but control lines on different ports) */
-        DDR(LCD_DATA0_PORT) |= 0x0F;
-        DDR(LCD_RS_PORT)    |= _BV(LCD_RS_PIN);
-        DDR(LCD_RW_PORT)    |= _BV(LCD_RW_PIN);
-        DDR(LCD_E_PORT)     |= _BV(LCD_E_PIN);
+        HAL_SET(DDR(LCD_DATA0_PORT), 0x0F);
+        HAL_SET(DDR(LCD_RS_PORT), _BV(LCD_RS_PIN));
+        HAL_SET(DDR(LCD_RW_PORT), _BV(LCD_RW_PIN));
+        HAL_SET(DDR(LCD_E_PORT), _BV(LCD_E_PIN));
     }
     else
     {
         /* configure all port bits as output (LCD data and control lines on different ports */
-        DDR(LCD_RS_PORT)    |= _BV(LCD_RS_PIN);
-        DDR(LCD_RW_PORT)    |= _BV(LCD_RW_PIN);
-        DDR(LCD_E_PORT)     |= _BV(LCD_E_PIN);
-        DDR(LCD_DATA0_PORT) |= _BV(LCD_DATA0_PIN);
-        DDR(LCD_DATA1_PORT) |= _BV(LCD_DATA1_PIN);
-        DDR(LCD_DATA2_PORT) |= _BV(LCD_DATA2_PIN);
-        DDR(LCD_DATA3_PORT) |= _BV(LCD_DATA3_PIN);
+        HAL_SET(DDR(LCD_RS_PORT), _BV(LCD_RS_PIN));
+        HAL_SET(DDR(LCD_RW_PORT), _BV(LCD_RW_PIN));
+        HAL_SET(DDR(LCD_E_PORT), _BV(LCD_E_PIN));
+        HAL_SET(DDR(LCD_DATA0_PORT), _BV(LCD_DATA0_PIN));
+        HAL_SET(DDR(LCD_DATA1_PORT), _BV(LCD_DATA1_PIN));
+        HAL_SET(DDR(LCD_DATA2_PORT), _BV(LCD_DATA2_PIN));
+        HAL_SET(DDR(LCD_DATA3_PORT), _BV(LCD_DATA3_PIN));
     }
     delay(LCD_DELAY_BOOTUP); /* wait 16ms or more after power-on       */
 
     /* initial write to lcd is 8bit */
-    LCD_DATA1_PORT |= _BV(LCD_DATA1_PIN); // LCD_FUNCTION>>4;
-    LCD_DATA0_PORT |= _BV(LCD_DATA0_PIN); // LCD_FUNCTION_8BIT>>4;
+    HAL_SET(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN)); // LCD_FUNCTION>>4;
+    HAL_SET(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN)); // LCD_FUNCTION_8BIT>>4;
     lcd_e_toggle();
     delay(LCD_DELAY_INIT); /* delay, busy flag can't be checked here */
 
@@ -556,7 +555,7 @@ void lcd_init(uint8_t dispAttr)
     delay(LCD_DELAY_INIT_REP); /* delay, busy flag can't be checked here */
 
     /* now configure for 4bit mode */
-    LCD_DATA0_PORT &= ~_BV(LCD_DATA0_PIN); // LCD_FUNCTION_4BIT_1LINE>>4
+    HAL_CLEAR(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN)); // LCD_FUNCTION_4BIT_1LINE>>4
     lcd_e_toggle();
     delay(LCD_DELAY_INIT_4BIT); /* some displays need this additional delay */
 
@@ -593,3 +592,214 @@ void lcd_init(uint8_t dispAttr)
     lcd_command(LCD_MODE_DEFAULT); /* set entry mode               */
     lcd_command(dispAttr);         /* display/cursor control       */
 }/* lcd_init */
+
+
+#if LCD_IO_MODE
+/*
+** asynchronous queue
+**
+** Every entry is one nibble or a pause. lcd_tick() runs once per
+** millisecond and sends nibbles until it has sent the last nibble of a
+** byte, so every byte is followed by at least 1 ms for the controller to
+** execute it. Pauses hold the queue for further ticks where the controller
+** needs longer: power-on, the 8-bit wake-up writes and clear/home.
+*/
+#define LCD_Q_PAUSE   0x80 /* pause entry, bits 0..6: ticks to skip        */
+#define LCD_Q_LAST    0x40 /* last nibble of a byte, end of this tick      */
+#define LCD_Q_RS      0x10 /* nibble goes to the data register             */
+#define LCD_Q_MASK    (LCD_QUEUE_SIZE - 1)
+
+#if (LCD_QUEUE_SIZE & LCD_Q_MASK)
+# error "LCD_QUEUE_SIZE is not a power of 2"
+#endif
+
+/* power-on wait and 8-bit wake-up writes in ticks of 1 ms */
+#define LCD_TICKS_BOOTUP ((LCD_DELAY_BOOTUP + 999) / 1000)
+#define LCD_TICKS_INIT   ((LCD_DELAY_INIT + 999) / 1000)
+
+static volatile uint8_t lcd_q[LCD_QUEUE_SIZE];
+static volatile uint8_t lcd_q_head = 0; /* written by lcd_queue_*() */
+static volatile uint8_t lcd_q_tail = 0; /* written by lcd_tick()    */
+static uint8_t lcd_q_skip = 0;
+
+/*************************************************************************
+*  Put entries into the queue, all or none
+*  Input:    entries  entries in order
+*         count    number of entries
+*  Returns:  1 if queued, 0 if the queue has no room for all
+*************************************************************************/
+static uint8_t lcd_q_put(const uint8_t *entries, uint8_t count)
+{
+    uint8_t head = lcd_q_head;
+
+    if (lcd_queue_free() < count)
+        return 0;
+    while (count--)
+    {
+        lcd_q[head] = *entries++;
+        head = (head + 1) & LCD_Q_MASK;
+    }
+    /* publish after the entries are stored */
+    lcd_q_head = head;
+    return 1;
+}
+
+/*************************************************************************
+*  Queue one byte as two nibbles, optionally followed by a pause
+*  Input:    data   byte
+*         rs     1: data, 0: instruction
+*         pause  extra ticks after the byte
+*  Returns:  1 if queued, 0 if the queue is full
+*************************************************************************/
+static uint8_t lcd_q_byte(uint8_t data, uint8_t rs, uint8_t pause)
+{
+    uint8_t e[3];
+    uint8_t flags = rs ? LCD_Q_RS : 0;
+
+    e[0] = flags | (data >> 4);
+    e[1] = flags | LCD_Q_LAST | (data & 0x0F);
+    e[2] = LCD_Q_PAUSE | pause;
+    return lcd_q_put(e, pause ? 3 : 2);
+}
+
+#if !BUS_SHARED
+/*************************************************************************
+*  Output one nibble on the data pins and latch it with E
+*************************************************************************/
+static void lcd_nibble(uint8_t nibble)
+{
+    HAL_CLEAR(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+    HAL_CLEAR(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+    HAL_CLEAR(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+    HAL_CLEAR(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+    if (nibble & 0x08) HAL_SET(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+    if (nibble & 0x04) HAL_SET(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+    if (nibble & 0x02) HAL_SET(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+    if (nibble & 0x01) HAL_SET(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+    lcd_e_toggle();
+}
+#endif
+
+/*************************************************************************
+*  Initialize display without waiting, the sequence of lcd_init() is
+*  queued and sent by lcd_tick()
+*  Input:    dispAttr as for lcd_init()
+*  Returns:  none
+*************************************************************************/
+void lcd_init_async(uint8_t dispAttr)
+{
+    const uint8_t wakeup[] = {
+        LCD_Q_PAUSE | LCD_TICKS_BOOTUP,       /* wait 16ms or more after power-on */
+        LCD_Q_LAST | (LCD_FUNCTION_8BIT_1LINE >> 4),
+        LCD_Q_PAUSE | LCD_TICKS_INIT,         /* busy flag can't be checked here  */
+        LCD_Q_LAST | (LCD_FUNCTION_8BIT_1LINE >> 4),
+        LCD_Q_LAST | (LCD_FUNCTION_8BIT_1LINE >> 4),
+        LCD_Q_LAST | (LCD_FUNCTION_4BIT_1LINE >> 4) /* now configure for 4bit mode */
+    };
+
+    HAL_SET(DDR(LCD_RS_PORT), _BV(LCD_RS_PIN));
+    HAL_SET(DDR(LCD_E_PORT), _BV(LCD_E_PIN));
+    HAL_SET(DDR(LCD_DATA0_PORT), _BV(LCD_DATA0_PIN));
+    HAL_SET(DDR(LCD_DATA1_PORT), _BV(LCD_DATA1_PIN));
+    HAL_SET(DDR(LCD_DATA2_PORT), _BV(LCD_DATA2_PIN));
+    HAL_SET(DDR(LCD_DATA3_PORT), _BV(LCD_DATA3_PIN));
+
+    lcd_q_put(wakeup, sizeof(wakeup));
+    #if KS0073_4LINES_MODE
+    lcd_q_byte(KS0073_EXTENDED_FUNCTION_REGISTER_ON, 0, 0);
+    lcd_q_byte(KS0073_4LINES_MODE, 0, 0);
+    lcd_q_byte(KS0073_EXTENDED_FUNCTION_REGISTER_OFF, 0, 0);
+    #else
+    lcd_q_byte(LCD_FUNCTION_DEFAULT, 0, 0); /* function set: display lines  */
+    #endif
+    lcd_q_byte(LCD_DISP_OFF, 0, 0);         /* display off                  */
+    lcd_queue_command(1 << LCD_CLR);        /* display clear                */
+    lcd_q_byte(LCD_MODE_DEFAULT, 0, 0);     /* set entry mode               */
+    lcd_q_byte(dispAttr, 0, 0);             /* display/cursor control       */
+}/* lcd_init_async */
+
+/*************************************************************************
+*  Queue an instruction, clear and home get the 1.52 ms they need
+*  Input:    cmd  instruction, see HD44780 data sheet
+*  Returns:  1 if queued, 0 if the queue is full
+*************************************************************************/
+uint8_t lcd_queue_command(uint8_t cmd)
+{
+    /* clear and home are the only instructions below 0x04 */
+    return lcd_q_byte(cmd, 0, (cmd < (1 << LCD_ENTRY_MODE)) ? 1 : 0);
+}
+
+/*************************************************************************
+*  Queue a data byte, e.g. a character at the address counter
+*  Input:    data  byte for the DDRAM or CGRAM
+*  Returns:  1 if queued, 0 if the queue is full
+*************************************************************************/
+uint8_t lcd_queue_data(uint8_t data)
+{
+    return lcd_q_byte(data, 1, 0);
+}
+
+/*************************************************************************
+*  Free entries in the queue, a byte takes two, clear and home three
+*************************************************************************/
+uint8_t lcd_queue_free(void)
+{
+    return (lcd_q_tail - lcd_q_head - 1) & LCD_Q_MASK;
+}
+
+/*************************************************************************
+*  Send the queued nibbles that are due
+*  Call every millisecond, e.g. from a timer interrupt
+*************************************************************************/
+void lcd_tick(void)
+{
+    uint8_t tail = lcd_q_tail;
+    uint8_t e;
+
+    if (lcd_q_skip)
+    {
+        lcd_q_skip--;
+        return;
+    }
+    while (tail != lcd_q_head)
+    {
+        e = lcd_q[tail];
+        tail = (tail + 1) & LCD_Q_MASK;
+        if (e & LCD_Q_PAUSE)
+        {
+            /* this tick is the first one of the pause */
+            lcd_q_skip = e & ~LCD_Q_PAUSE;
+            if (lcd_q_skip)
+                lcd_q_skip--;
+            break;
+        }
+        #if BUS_SHARED
+        /* data pins double as shift register lines, see bus.h */
+        bus_lcd_nibble(e & 0x0F, e & LCD_Q_RS);
+        lcd_e_toggle();
+        if (e & LCD_Q_LAST)
+        {
+            bus_lcd_release();
+            break;
+        }
+        #else
+        if (e & LCD_Q_RS)
+            lcd_rs_high();
+        else
+            lcd_rs_low();
+        lcd_nibble(e);
+        if (e & LCD_Q_LAST)
+        {
+            /* all data pins high (inactive) */
+            HAL_SET(LCD_DATA0_PORT, _BV(LCD_DATA0_PIN));
+            HAL_SET(LCD_DATA1_PORT, _BV(LCD_DATA1_PIN));
+            HAL_SET(LCD_DATA2_PORT, _BV(LCD_DATA2_PIN));
+            HAL_SET(LCD_DATA3_PORT, _BV(LCD_DATA3_PIN));
+            break;
+        }
+        #endif
+    }
+    lcd_q_tail = tail;
+}/* lcd_tick */
+
+#endif /* if LCD_IO_MODE */
@@ -12,53 +12,55 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "settings.h"
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <util/delay.h>
+#include "hal.h"
 #include "twi.h"
 #include "uart.h"
+#include "timer.h"
+#include "sensor.h"
+#include "cube.h"
+#include "anim.h"
+#include "regmap.h"
+#include "telemetry.h"
+#include "stream.h"
+#include "mode.h"
+#include "shell.h"
+#include "config.h"
+#include "display.h"
+#include "preview.h"
+#include "fmt.h"
 
 
 /* Constants and macros ------------------------------------------------------*/
 /**
- *  @brief Define UART buad rate.
+ *  @brief Define UART buad rate, e.g. make CDEFS=-DUART_BAUD_RATE=1000000.
+ *  @note 250000, 500000 and 1000000 are exact at 16 MHz.
  */
-#define UART_BAUD_RATE 9600
-#define DHT12 0x5c
+#ifndef UART_BAUD_RATE
+# define UART_BAUD_RATE 115200
+#endif
 
+#if UART_BAUD_ERROR_AUTO(UART_BAUD_RATE, F_CPU) > UART_BAUD_ERROR_MAX
+# error "UART_BAUD_RATE cannot be generated from F_CPU accurately enough"
+#endif
+
+/**
+ *  @brief Period of the LCD readout in milliseconds.
+ */
+#define READOUT_MS 500
 
-struct values{
-    uint8_t humidity_integer;
-    uint8_t humidity_decimal;
-    uint8_t temperature_integer;
-    uint8_t temperature_decimal;
-};
-struct values Meteo_values;
 /* Function prototypes -------------------------------------------------------*/
 /**
- *  @brief Initialize UART, TWI, and Timer/Counter1.
+ *  @brief Initialize UART, TWI, Timer/Counter0 and the cube refresh.
  */
 void setup(void);
 
+#if DISPLAY_ENABLE
 /**
- *  @brief TWI Finite State Machine transmits all slave addresses.
+ *  @brief Redraw temperature, humidity, animation, frame rate and the
+ *         layer glyphs into the LCD shadow every READOUT_MS.
  */
-void fsm_twi_scanner(void);
-
-/* Global variables ----------------------------------------------------------*/
-typedef enum {
-    IDLE_STATE = 1,
-    SLA_W_STATE,
-    ACK_STATE,
-    HUMIDITY_STATE,
-    TEMPERATURE_STATE,
-    UART_STATE,
-    UART_STATE_TEMP,
-} state_t;
-/* FSM for scanning TWI bus */
-state_t twi_state = IDLE_STATE;
+static void readout_task(void);
+#endif
 
 /* Functions -----------------------------------------------------------------*/
 /**
@@ -66,6 +68,10 @@ state_t twi_state = IDLE_STATE;
   */
 int main(void)
 {
+#ifndef TWI_SLAVE_ADDRESS
+    sensor_sample_t sample;
+#endif
+
     /* Initializations */
     setup();
 
@@ -74,15 +80,35 @@ int main(void)
 
     /* Forever loop */
     while (1) {
-        fsm_twi_scanner();
-        if (Meteo_values.temperature_integer <= 28)
-        {
-            TestAnimation1();
+#ifdef TWI_SLAVE_ADDRESS
+        /* Frames, brightness and animation come from the TWI master */
+        regmap_task();
+        if (!stream_enabled()) {
+            anim_task();
         }
-        else {
-            TestAnimation2();
+#else
+        /* Scans the bus once, then polls every sensor within its period */
+        sensor_task();
+        /* A new animation is chosen each time the current one ends, unless
+         * the receiver belongs to the stream decoder, which then owns the
+         * back buffer even before the first frame */
+        if (!stream_enabled() &&
+            (anim_task() || anim_current() == ANIM_NONE)) {
+            sensor_get(&sample);
+            anim_start(mode_animation(&sample));
         }
-
+#endif
+        /* Commands, or frames from the host renderer after "stream" */
+        shell_task();
+        stream_task();
+        /* Counter and error frames every TELEMETRY_STATS_MS */
+        telemetry_task();
+#if DISPLAY_ENABLE
+        /* Readout and layer glyphs into the shadow, changes to the LCD */
+        readout_task();
+        preview_task();
+        display_task();
+#endif
     }
 
     return 0;
@@ -94,301 +120,82 @@ int main(void)
 void setup(void)
 {
     /* Initialize UART: asynchronous, 8-bit data, no parity, 1-bit stop */
-    uart_init(UART_BAUD_SELECT(UART_BAUD_RATE, F_CPU));
+    uart_init(UART_BAUD_SELECT_AUTO(UART_BAUD_RATE, F_CPU));
 
+#ifdef TWI_SLAVE_ADDRESS
+    /* Initialize TWI as slave of an upstream controller */
+    twi_slave_init();
+#else
     /* Initialize TWI */
     twi_init();
+#endif
 
-    /* Set LEDs as outputs */
-    DDRB |= _BV(PB5);
-    DDRB |= _BV(PB4);
-    DDRB |= _BV(PB3);
-    DDRB |= _BV(PB2);
-    DDRB |= _BV(PB1);
-    DDRB |= _BV(PB0);
-    DDRD |= _BV(PD7);
-    DDRD |= _BV(PD6);
-    DDRD |= _BV(PD5);
-    /* and GND layer pins */
-    DDRD |= _BV(PD4);
-    DDRD |= _BV(PD3);
-    DDRD |= _BV(PD2);
+    /* LED pins and layer refresh on Timer/Counter2 */
+    cube_init();
 
-    /* Turn all LED off */
-    PORTB &= ~_BV(PB5);
-    PORTB &= ~_BV(PB4);
-    PORTB &= ~_BV(PB3);
-    PORTB &= ~_BV(PB2);
-    PORTB &= ~_BV(PB1);
-    PORTB &= ~_BV(PB0);
-    PORTD &= ~_BV(PD7);
-    PORTD &= ~_BV(PD6);
-    PORTD &= ~_BV(PD5);
-    /* and GND layer pins. When cleared, they close the circuit
-	 * connecting the layer to GND and making it possible for
-	 * the LEDs of the specific layer to turn on. */
-    PORTD |=_BV(PD4);
-    PORTD |=_BV(PD3);
-    PORTD |=_BV(PD2);
+    /* Settings saved from the shell, if the EEPROM holds a valid record */
+    if (config_load() == CONFIG_RATE_BAD) {
+        uart_puts_P("\r\nconfig: saved rate out of range, default used");
+    }
 
-    /* Timer/Counter0: select clock and enable overflow */
-	/* Eventually it was not used */
-    /* Clock prescaler 1024 => overflows every 16 ms */
-    TCCR0B |= _BV(CS02) | _BV(CS00);
-    /* Overflow interrupt enable */
-    TIMSK0 |= _BV(TOIE0);
-}
+    /* Timer/Counter0: 1 ms time base for the sensor task */
+    timer_init();
 
+    /* Command prompt */
+    shell_init();
 
-/* LED cube animation of turned on LEDs layer shifting up */
-/**
-  * function animation test 1
-  */
-void TestAnimation1()
-{
-    PORTD &= ~_BV(PD4);
-    PORTD |=_BV(PD3);
-    PORTD |=_BV(PD2);
-    PORTB |=_BV(PB5);
-    PORTB |=_BV(PB4);
-    PORTB |=_BV(PB3);
-    PORTB |=_BV(PB2);
-    PORTB |=_BV(PB1);
-    PORTB |=_BV(PB0);
-    PORTD |=_BV(PD7);
-    PORTD |=_BV(PD6);
-    PORTD |=_BV(PD5);
-    _delay_ms (200);
-    PORTB &= ~_BV(PB5);
-    PORTB &= ~_BV(PB4);
-    PORTB &= ~_BV(PB3);
-    PORTB &= ~_BV(PB2);
-    PORTB &= ~_BV(PB1);
-    PORTB &= ~_BV(PB0);
-    PORTD &= ~_BV(PD7);
-    PORTD &= ~_BV(PD6);
-    PORTD &= ~_BV(PD5);
-    //_delay_ms (400);
-    PORTD &= ~_BV(PD3);
-    PORTD |=_BV(PD4);
-    PORTD |=_BV(PD2);
-    PORTB |=_BV(PB5);
-    PORTB |=_BV(PB4);
-    PORTB |=_BV(PB3);
-    PORTB |=_BV(PB2);
-    PORTB |=_BV(PB1);
-    PORTB |=_BV(PB0);
-    PORTD |=_BV(PD7);
-    PORTD |=_BV(PD6);
-    PORTD |=_BV(PD5);
-    _delay_ms (200);
-    PORTB &= ~_BV(PB5);
-    PORTB &= ~_BV(PB4);
-    PORTB &= ~_BV(PB3);
-    PORTB &= ~_BV(PB2);
-    PORTB &= ~_BV(PB1);
-    PORTB &= ~_BV(PB0);
-    PORTD &= ~_BV(PD7);
-    PORTD &= ~_BV(PD6);
-    PORTD &= ~_BV(PD5);
-    //_delay_ms (400);
-    PORTD &= ~_BV(PD2);
-    PORTD |=_BV(PD4);
-    PORTD |=_BV(PD3);
-    PORTB |=_BV(PB5);
-    PORTB |=_BV(PB4);
-    PORTB |=_BV(PB3);
-    PORTB |=_BV(PB2);
-    PORTB |=_BV(PB1);
-    PORTB |=_BV(PB0);
-    PORTD |=_BV(PD7);
-    PORTD |=_BV(PD6);
-    PORTD |=_BV(PD5);
-    _delay_ms (200);
-    PORTB &= ~_BV(PB5);
-    PORTB &= ~_BV(PB4);
-    PORTB &= ~_BV(PB3);
-    PORTB &= ~_BV(PB2);
-    PORTB &= ~_BV(PB1);
-    PORTB &= ~_BV(PB0);
-    PORTD &= ~_BV(PD7);
-    PORTD &= ~_BV(PD6);
-    PORTD &= ~_BV(PD5);
-    //_delay_ms (400);
+#if DISPLAY_ENABLE
+    /* LCD start-up is queued, the cube does not wait for it */
+    display_init();
+#endif
 }
-/* LED cube animation of turned on LEDs slices shifting to the side */
+
+#if DISPLAY_ENABLE
 /**
-  * function animation test 2
+  * @brief LCD readout, the whole screen is redrawn and only differences
+  *        reach the LCD.
   */
-void TestAnimation2()
-{
-    PORTD &= ~_BV(PD4);
-    PORTD &= ~_BV(PD3);
-    PORTD &= ~_BV(PD2);
-    PORTB |=_BV(PB3);
-    PORTB |=_BV(PB0);
-    PORTD |=_BV(PD5);
-    _delay_ms (400);
-    PORTB &= ~_BV(PB3);
-    PORTB &= ~_BV(PB0);
-    PORTD &= ~_BV(PD5);
-    PORTB |=_BV(PB4);
-    PORTB |=_BV(PB1);
-    PORTD |=_BV(PD6);
-    _delay_ms (400);
-    PORTB &= ~_BV(PB4);
-    PORTB &= ~_BV(PB1);
-    PORTD &= ~_BV(PD6);
-    PORTB |=_BV(PB5);
-    PORTB |=_BV(PB2);
-    PORTD |=_BV(PD7);
-    _delay_ms (400);
-    PORTB &= ~_BV(PB5);
-    PORTB &= ~_BV(PB2);
-    PORTD &= ~_BV(PD7);
-    //_delay_ms (400);
-
-}
-
-
-void fsm_twi_scanner(void)
+static void readout_task(void)
 {
-    /* Static variable inside a function keeps its value between callings */
-    //static uint8_t slave_address = 0;
-    uint8_t twi_status;
-    char uart_string[5];
-    char uart_string2[10];
-    char uart_string3[10];
-    char uart_string4[10];
-
-    switch (twi_state) {
-    case IDLE_STATE:
-        //uart_puts("IIIIDLE\n");
-        twi_state = HUMIDITY_STATE;
-        /*if (slave_address < 128) {
-            twi_state = SLA_W_STATE;
-        }
-        else if (slave_address == 128) {
-            uart_puts("\r\nEnd of scanning...");
-            slave_address = 255;
-        }*/
-        break;
-    case HUMIDITY_STATE:
-        //uart_puts("HUMMM\n");
-        twi_status = twi_start((DHT12<<1) + TWI_WRITE);
-        if (twi_status==0){
-            twi_write (0x00);
-            twi_stop ();
-            twi_start((DHT12<<1) + TWI_READ);
-            Meteo_values.humidity_integer = twi_read_ack();
-            Meteo_values.humidity_decimal = twi_read_nack();
-            twi_stop ();
-            twi_state = TEMPERATURE_STATE;
-            //uart_puts("HUMMMIF\n");
-        }
-        else {
-            uart_puts("Not connected H");
-
-            twi_state = IDLE_STATE;
-        }
-        break;
-
-    /* Transmit address of TWI slave device and check status */
-    //Parte previa a la lectura del sensor, scan de direccion
-    /*case SLA_W_STATE:
-        twi_status = twi_start((slave_address<<1) + TWI_WRITE);
-        twi_stop ();
-        if (twi_status==0){
-            twi_state = ACK_STATE;
-
-        }
-        else {
-            uart_puts(" --");
-            slave_address++;
-            twi_state = IDLE_STATE;
-        }
-
-
-        break;*/
-    case TEMPERATURE_STATE:
-        //uart_puts("TEMMM\n");
-        twi_status = twi_start((DHT12<<1) + TWI_WRITE);
-        if (twi_status==0){
-            twi_write (0x02);
-            twi_stop ();
-            twi_start((DHT12<<1) + TWI_READ);
-            Meteo_values.temperature_integer = twi_read_ack();
-            Meteo_values.temperature_decimal = twi_read_nack();
-            twi_stop ();
-            twi_state = UART_STATE;
-            //uart_puts("TEMMMIF\n");
-        }
-        else {
-            uart_puts("Not connected T");
-
-            twi_state = IDLE_STATE;
-        }
-        break;
-    /* Received ACK from slave */
-    //Parte previa a la lectura del sensor, scan de direccion
-    /*case ACK_STATE:
-
-        itoa (slave_address, uart_string, 16);
-        uart_puts (uart_string);
-        slave_address++;
-        twi_state = IDLE_STATE;
+    static uint32_t last = 0;
+    static uint8_t frames = 0;
+    sensor_sample_t sample;
+    uint8_t count;
 
-        break;*/
-    case UART_STATE:
-        //uart_puts("UART\n");
-        /*uart_puts("\r\n---Humidity values---:\r\n");
-        itoa (Meteo_values.humidity_integer, uart_string, 10);
-        uart_puts(uart_string);
-        uart_puts(".");
-        itoa (Meteo_values.humidity_decimal, uart_string2, 10);
-        uart_puts(uart_string2);*/
-        uart_puts("\r\n---Temperature values---:\r\n");
-        itoa (Meteo_values.temperature_integer, uart_string3, 10);
-        itoa (Meteo_values.temperature_decimal, uart_string4, 10);
-        uart_puts(uart_string3);
-        uart_puts(".");
-        uart_puts(uart_string4);
-
-        /*uart_puts(Meteo_values.humidity_decimal);
-        uart_puts("\r\n---temperature values---\n");
-        uart_puts(Meteo_values.temperature_integer);
-        uart_puts(Meteo_values.temperature_decimal);*/
-        twi_state = IDLE_STATE;
-        break;
-    /*EL problema esta en el buffer size de la transmission, estaba limitado a 32
-	Cambio a 64 y ya funciona
-      case UART_STATE_TEMP:
-        uart_puts("\r\n---Temperature values---:\r\n");
-        itoa (Meteo_values.temperature_integer, uart_string3, 10);
-        itoa (Meteo_values.temperature_decimal, uart_string4, 10);
-        uart_puts(uart_string3);
-        uart_puts(".");
-        uart_puts(uart_string4);
-        twi_state = IDLE_STATE;
-        break;*/
-    default:
-        twi_state = IDLE_STATE;
-    } /* End of switch (twi_state) */
-}
-
-ISR(TIMER0_OVF_vect)
-{
-/* First idea was to make the code run inside the interrupt, as it didn't
- * work correctly, the code was put directly into main while */
-    /*if (Meteo_values.temperature_integer <= 28)
-    {
-        TestAnimation1();
+    if (timer_millis() - last < READOUT_MS) {
+        return;
+    }
+    last += READOUT_MS;
+
+    display_clear();
+    if (sensor_get(&sample)) {
+        /* 23.45C 45.2%, the layer glyphs follow in the last columns */
+        fmt_fixed_to(display_putc, sample.temperature, 2);
+        display_puts_p(PSTR("C "));
+        fmt_fixed_to(display_putc, sample.humidity / 10, 1);
+        display_putc('%');
     }
     else {
-        TestAnimation2();
-    }*/
-    //_delay_ms(1000);
+        display_puts_p(PSTR("no sensor"));
+    }
 
+    /* Buffer swaps per second */
+    count = cube_frame_count();
+    display_gotoxy(0, 1);
+    if (anim_current() < ANIM_COUNT) {
+        display_puts_p(anim_name(anim_current()));
+    }
+    else {
+        display_puts_p(PSTR("host"));
+    }
+    display_putc(' ');
+    fmt_fixed_to(display_putc, (uint8_t)(count - frames) * (1000 / READOUT_MS), 0);
+    display_puts_p(PSTR("fps"));
+    frames = count;
 
+    /* Text longer than its line gives way to the layer glyphs */
+    preview_draw();
 }
+#endif
+
 /* END OF FILE ****************************************************************/
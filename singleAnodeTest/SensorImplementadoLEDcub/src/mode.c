@@ -0,0 +1,98 @@
+/**
+  ******************************************************************************
+  * @file    mode.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Animation choice from the temperature trend, with a run-time
+  *          threshold and a fixed animation override.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "anim.h"
+#include "history.h"
+#include "mode.h"
+
+/* Global variables ----------------------------------------------------------*/
+static int16_t mode_temperature = ANIMATION_THRESHOLD;
+static uint8_t mode_id = MODE_AUTO;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: mode_animation()
+ * Purpose:  Choose the animation from the filtered temperature and its trend.
+ * Input:    sample - Filtered reading of the main DHT12
+ * Returns:  ANIM_x
+ ******************************************************************************/
+uint8_t mode_animation(const sensor_sample_t *sample)
+{
+    int16_t threshold = mode_temperature;
+
+    if (mode_id != MODE_AUTO) {
+        return mode_id;
+    }
+
+    /* Warming up switches to the warm animation a bit earlier, cooling down
+     * switches back a bit earlier */
+    switch (history_trend(sensor_history(), ANIMATION_TREND_DEADBAND)) {
+    case 1:
+        threshold -= ANIMATION_TREND_LEAD;
+        break;
+    case -1:
+        threshold += ANIMATION_TREND_LEAD;
+        break;
+    default:
+        break;
+    }
+
+    if (sample->temperature < threshold) {
+        return ANIM_LAYERS;
+    }
+    return ANIM_SLICES;
+}
+
+/*******************************************************************************
+ * Function: mode_set_threshold()
+ * Purpose:  Set the threshold of the automatic choice.
+ * Input:    threshold - Centi-degrees
+ * Returns:  None
+ ******************************************************************************/
+void mode_set_threshold(int16_t threshold)
+{
+    mode_temperature = threshold;
+}
+
+/*******************************************************************************
+ * Function: mode_threshold()
+ * Purpose:  Threshold of the automatic choice.
+ * Input:    None
+ * Returns:  Centi-degrees
+ ******************************************************************************/
+int16_t mode_threshold(void)
+{
+    return mode_temperature;
+}
+
+/*******************************************************************************
+ * Function: mode_set_fixed()
+ * Purpose:  Fix the animation or return to the automatic choice.
+ * Input:    id - ANIM_x or MODE_AUTO
+ * Returns:  None
+ ******************************************************************************/
+void mode_set_fixed(uint8_t id)
+{
+    mode_id = id;
+}
+
+/*******************************************************************************
+ * Function: mode_fixed()
+ * Purpose:  Fixed animation.
+ * Input:    None
+ * Returns:  ANIM_x or MODE_AUTO
+ ******************************************************************************/
+uint8_t mode_fixed(void)
+{
+    return mode_id;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,102 @@
+/**
+  ******************************************************************************
+  * @file    preview.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Cube layers as 3x3 dot patterns in LCD user glyphs.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include <string.h>
+#include "timer.h"
+#include "cube.h"
+#include "display.h"
+#include "preview.h"
+
+#if DISPLAY_ENABLE
+/* Constants and macros ------------------------------------------------------*/
+#if CUBE_DRIVER == CUBE_DRIVER_SR595
+/* One line of glyphs per colour */
+# define PREVIEW_LINES CUBE_COLOURS
+#else
+# define PREVIEW_LINES 1
+#endif
+
+#if (PREVIEW_LINES * CUBE_LAYERS > DISPLAY_GLYPHS)
+# error "Not enough user glyphs for the preview"
+#endif
+
+#if (PREVIEW_LINES > LCD_LINES)
+# error "Not enough LCD lines for the preview"
+#endif
+
+/* First column of the glyphs */
+#define PREVIEW_X (LCD_DISP_LENGTH - CUBE_LAYERS)
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: preview_draw()
+ * Purpose:  Write the glyph characters into the shadow.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void preview_draw(void)
+{
+    uint8_t line, layer;
+
+    for (line = 0; line < PREVIEW_LINES; line++) {
+        display_gotoxy(PREVIEW_X, line);
+        for (layer = 0; layer < CUBE_LAYERS; layer++) {
+            display_putc(line * CUBE_LAYERS + layer);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function: preview_task()
+ * Purpose:  Turn every layer of the front buffer into a glyph.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void preview_task(void)
+{
+    static uint32_t last = 0;
+    cube_frame_t frame;
+    uint8_t rows[DISPLAY_GLYPH_ROWS];
+    uint8_t line, layer, column;
+    uint16_t mask;
+
+    if (timer_millis() - last < PREVIEW_MS) {
+        return;
+    }
+    last += PREVIEW_MS;
+
+    cube_get_front(&frame);
+    for (line = 0; line < PREVIEW_LINES; line++) {
+        for (layer = 0; layer < CUBE_LAYERS; layer++) {
+#if PREVIEW_LINES == 1
+            mask = frame.column[layer][CUBE_RED] | frame.column[layer][CUBE_GREEN];
+#else
+            mask = frame.column[layer][line];
+#endif
+            /* LED row r on pixel row 2r + 1, position p on pixel 2p, so
+             * neighbouring LEDs stay apart */
+            memset(rows, 0, sizeof(rows));
+            /* Base line, marks the glyph of a dark layer */
+            rows[DISPLAY_GLYPH_ROWS - 1] = 0x1f;
+            for (column = 0; column < CUBE_COLUMNS; column++) {
+                if (mask & _BV(column)) {
+                    rows[2 * (column / 3) + 1] |= 0x10 >> (2 * (column % 3));
+                }
+            }
+            display_glyph(line * CUBE_LAYERS + layer, rows);
+        }
+    }
+}
+
+#endif /* DISPLAY_ENABLE */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file    regmap.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   TWI slave register map: framebuffer, brightness, animation id and
+  *          status of the cube.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "twi.h"
+
+#ifdef TWI_SLAVE_ADDRESS
+#include "anim.h"
+#include "regmap.h"
+
+/* Global variables ----------------------------------------------------------*/
+/* Framebuffer written, or bytes dropped, since the last stop condition */
+static uint8_t regmap_dirty = 0;
+static uint8_t regmap_dropped = 0;
+
+/* Sticky error flag of the status register */
+static uint8_t regmap_invalid = 0;
+
+/* Animation requested by the master, applied by regmap_task() */
+static volatile uint8_t regmap_animation = ANIM_NONE;
+static volatile uint8_t regmap_animation_changed = 0;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: regmap_task()
+ * Purpose:  Start the animation last written by the master.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void regmap_task(void)
+{
+    if (regmap_animation_changed) {
+        regmap_animation_changed = 0;
+        anim_start(regmap_animation);
+    }
+}
+
+/*******************************************************************************
+ * Function: twi_slave_receive()
+ * Purpose:  Store one register written by the master.
+ * Input:    reg - Register number
+ *           data - Value
+ * Returns:  None
+ ******************************************************************************/
+void twi_slave_receive(uint8_t reg, uint8_t data)
+{
+    if (reg < REGMAP_BRIGHTNESS) {
+        /* The player draws into the same back buffer from the main loop, so
+         * the frame is dropped until regmap_task() has stopped it, however
+         * it was started */
+        if (anim_current() != ANIM_NONE) {
+            regmap_dropped = 1;
+            regmap_animation = ANIM_NONE;
+            regmap_animation_changed = 1;
+            return;
+        }
+        ((uint8_t *)cube_back())[reg - REGMAP_FRAME] = data;
+        regmap_dirty = 1;
+    }
+    else if (reg == REGMAP_BRIGHTNESS) {
+        cube_set_brightness(data);
+    }
+    else if (reg == REGMAP_ANIMATION && data < ANIM_COUNT) {
+        regmap_animation = data;
+        regmap_animation_changed = 1;
+    }
+    else {
+        regmap_invalid = 1;
+    }
+}
+
+/*******************************************************************************
+ * Function: twi_slave_transmit()
+ * Purpose:  Read one register.
+ * Input:    reg - Register number
+ * Returns:  Register value, 0 outside the map
+ ******************************************************************************/
+uint8_t twi_slave_transmit(uint8_t reg)
+{
+    uint8_t status;
+
+    if (reg < REGMAP_BRIGHTNESS) {
+        return ((const uint8_t *)cube_back())[reg - REGMAP_FRAME];
+    }
+    switch (reg) {
+    case REGMAP_BRIGHTNESS:
+        return cube_get_brightness();
+    case REGMAP_ANIMATION:
+        return regmap_animation_changed ? regmap_animation : anim_current();
+    case REGMAP_STATUS:
+        status = (uint8_t)(cube_frame_count() << 4) & REGMAP_STATUS_FRAMES;
+        if (anim_current() != ANIM_NONE) {
+            status |= REGMAP_STATUS_ANIMATION;
+        }
+        if (regmap_invalid) {
+            status |= REGMAP_STATUS_INVALID;
+            regmap_invalid = 0;
+        }
+        return status;
+    default:
+        return 0;
+    }
+}
+
+/*******************************************************************************
+ * Function: twi_slave_stop()
+ * Purpose:  Show the frame written by the master, unless part of it was
+ *           dropped for the animation player.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void twi_slave_stop(void)
+{
+    if (regmap_dropped) {
+        regmap_invalid = 1;
+    }
+    else if (regmap_dirty) {
+        cube_swap();
+    }
+    regmap_dirty = 0;
+    regmap_dropped = 0;
+}
+#endif /* TWI_SLAVE_ADDRESS */
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,447 @@
+/**
+  ******************************************************************************
+  * @file    sensor.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   TWI sensor manager. A one-time asynchronous bus scan at boot fills
+  *          the device table, then a round-robin poller reads every device
+  *          within its own period and caches the last good readings.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include <string.h>
+#include "twi.h"
+#include "timer.h"
+#include "filter.h"
+#include "sensor.h"
+#include "telemetry.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Longest register block read from a device */
+#define SENSOR_RX_MAX 5
+
+/* No main DHT12 registered */
+#define SENSOR_NONE 0xff
+
+/* Types ---------------------------------------------------------------------*/
+/* Driver: address range answering to it and register block to read */
+typedef struct {
+    uint8_t kind;
+    uint8_t first_address;
+    uint8_t last_address;
+    uint8_t reg;
+    uint8_t length;
+    uint16_t period;
+} sensor_driver_t;
+
+/* Global variables ----------------------------------------------------------*/
+typedef enum {
+    IDLE_STATE = 1,
+    SLA_W_STATE,
+    ACK_STATE,
+    READ_STATE,
+    WAIT_STATE,
+    UART_STATE,
+} state_t;
+/* FSM for scanning TWI bus */
+static state_t twi_state = IDLE_STATE;
+
+/* Known drivers. DHT12: humidity and temperature registers plus checksum,
+ * LM75: 9-bit temperature register, 0.5 degree resolution */
+static const sensor_driver_t sensor_drivers[] PROGMEM = {
+    {SENSOR_KIND_DHT12, DHT12, DHT12, 0x00, 5, SENSOR_PERIOD_MS},
+    {SENSOR_KIND_LM75,  0x48,  0x4f,  0x00, 2, SENSOR_LM75_PERIOD_MS},
+};
+
+/* Device table filled by the bus scan */
+static sensor_device_t sensor_devices[SENSOR_MAX_DEVICES];
+static uint8_t sensor_device_total = 0;
+static uint8_t sensor_main = SENSOR_NONE;
+
+/* Period of sensor_set_period() for every device, 0 for the driver default */
+static uint16_t sensor_period = 0;
+
+/* Bus scan */
+static uint8_t scan_address;
+static uint8_t scan_done = 0;
+static uint32_t scan_time;
+
+/* Transfer in progress */
+static uint8_t sensor_current;
+static uint8_t sensor_next = 0;
+static uint8_t sensor_reg;
+static uint8_t sensor_rx[SENSOR_RX_MAX];
+static uint32_t sensor_transfer_start;
+
+/* Values of the acquisition in progress */
+static struct values Meteo_values;
+
+/* Last complete reading, only written by the FSM */
+static sensor_sample_t sensor_sample;
+
+/* Median + EMA state of both channels, primed by the first reading */
+static filter_t temperature_filter;
+static filter_t humidity_filter;
+
+/* Filtered temperatures for min/max/mean/trend queries */
+static history_t temperature_history;
+
+/* Function prototypes -------------------------------------------------------*/
+static void sensor_register(uint8_t address);
+static uint8_t sensor_due(uint32_t now);
+static uint8_t sensor_wait(uint32_t now);
+static uint8_t sensor_decode(sensor_device_t *device);
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: sensor_task()
+ * Purpose:  Advance the scan/poll state machine by one step.
+ * Input:    None
+ * Returns:  None
+ * Note:     Never waits for the bus, transfers run in TWI_vect.
+ ******************************************************************************/
+void sensor_task(void)
+{
+    fsm_twi_scanner();
+}
+
+/*******************************************************************************
+ * Function: sensor_set_period()
+ * Purpose:  Change the sampling period of every registered device and of
+ *           the devices the scan finds later.
+ * Input:    period_ms - Time between two polls in milliseconds
+ * Returns:  None
+ ******************************************************************************/
+void sensor_set_period(uint16_t period_ms)
+{
+    uint8_t i;
+
+    sensor_period = period_ms;
+    for (i = 0; i < sensor_device_total; i++) {
+        sensor_devices[i].period = period_ms;
+    }
+}
+
+/*******************************************************************************
+ * Function: sensor_get()
+ * Purpose:  Copy the cached sample without touching the bus.
+ * Input:    sample - Destination of the cached sample
+ * Returns:  0 - No sample has been read yet
+ *           1 - Sample is valid
+ ******************************************************************************/
+uint8_t sensor_get(sensor_sample_t *sample)
+{
+    *sample = sensor_sample;
+    return sensor_sample.valid;
+}
+
+/*******************************************************************************
+ * Function: sensor_age()
+ * Purpose:  Time since the cached sample was read.
+ * Input:    None
+ * Returns:  Age in milliseconds, SENSOR_AGE_NONE if there is no sample yet
+ ******************************************************************************/
+uint32_t sensor_age(void)
+{
+    if (!sensor_sample.valid) {
+        return SENSOR_AGE_NONE;
+    }
+    return timer_millis() - sensor_sample.timestamp;
+}
+
+/*******************************************************************************
+ * Function: sensor_history()
+ * Purpose:  Access the window of filtered temperatures.
+ * Input:    None
+ * Returns:  History instance, read-only
+ ******************************************************************************/
+const history_t *sensor_history(void)
+{
+    return &temperature_history;
+}
+
+/*******************************************************************************
+ * Function: sensor_device_count()
+ * Purpose:  Number of devices registered by the bus scan.
+ * Input:    None
+ * Returns:  0 .. SENSOR_MAX_DEVICES
+ ******************************************************************************/
+uint8_t sensor_device_count(void)
+{
+    return sensor_device_total;
+}
+
+/*******************************************************************************
+ * Function: sensor_device_get()
+ * Purpose:  Copy one entry of the device table.
+ * Input:    index - Entry number
+ *           device - Destination
+ * Returns:  0 - No such device
+ *           1 - Entry copied
+ ******************************************************************************/
+uint8_t sensor_device_get(uint8_t index, sensor_device_t *device)
+{
+    if (index >= sensor_device_total) {
+        return 0;
+    }
+    *device = sensor_devices[index];
+    return 1;
+}
+
+/*******************************************************************************
+ * Function: sensor_register()
+ * Purpose:  Add a device answering the scan to the table if a driver for its
+ *           address is known.
+ * Input:    address - 7-bit TWI address
+ * Returns:  None
+ ******************************************************************************/
+static void sensor_register(uint8_t address)
+{
+    sensor_driver_t driver;
+    sensor_device_t *device;
+    uint8_t i;
+
+    if (sensor_device_total >= SENSOR_MAX_DEVICES) {
+        return;
+    }
+    for (i = 0; i < sizeof(sensor_drivers) / sizeof(sensor_drivers[0]); i++) {
+        memcpy_P(&driver, &sensor_drivers[i], sizeof(driver));
+        if (address < driver.first_address || address > driver.last_address) {
+            continue;
+        }
+        device = &sensor_devices[sensor_device_total];
+        memset(device, 0, sizeof(*device));
+        device->address = address;
+        device->kind = driver.kind;
+        device->region = sensor_device_total;
+        device->period = sensor_period ? sensor_period : driver.period;
+        /* Due at once */
+        device->last_poll = timer_millis() - device->period;
+
+        if (driver.kind == SENSOR_KIND_DHT12 && sensor_main == SENSOR_NONE) {
+            sensor_main = sensor_device_total;
+        }
+        sensor_device_total++;
+        return;
+    }
+}
+
+/*******************************************************************************
+ * Function: sensor_due()
+ * Purpose:  Round-robin search of the next device whose period, or retry
+ *           delay after a failed read, has elapsed.
+ * Input:    now - Current time in milliseconds
+ * Returns:  1 - sensor_current selected
+ *           0 - No device due
+ ******************************************************************************/
+static uint8_t sensor_due(uint32_t now)
+{
+    sensor_device_t *device;
+    uint16_t interval;
+    uint8_t i, index;
+
+    for (i = 0; i < sensor_device_total; i++) {
+        index = sensor_next + i;
+        if (index >= sensor_device_total) {
+            index -= sensor_device_total;
+        }
+        device = &sensor_devices[index];
+        interval = (device->retries && device->retries <= SENSOR_RETRIES) ?
+                   SENSOR_RETRY_MS : device->period;
+        if ((now - device->last_poll) >= interval) {
+            sensor_current = index;
+            /* Start the next search after this device */
+            sensor_next = (index + 1 < sensor_device_total) ? index + 1 : 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: sensor_wait()
+ * Purpose:  Check the transfer in progress, abort it after
+ *           SENSOR_TWI_TIMEOUT_MS.
+ * Input:    now - Current time in milliseconds
+ * Returns:  TWI_ASYNC_BUSY, TWI_ASYNC_OK, TWI_ASYNC_NACK or TWI_ASYNC_ERROR
+ ******************************************************************************/
+static uint8_t sensor_wait(uint32_t now)
+{
+    uint8_t status = twi_async_status();
+
+    if (status == TWI_ASYNC_BUSY &&
+        (now - sensor_transfer_start) >= SENSOR_TWI_TIMEOUT_MS) {
+        twi_async_abort();
+        status = TWI_ASYNC_ERROR;
+    }
+    return status;
+}
+
+/*******************************************************************************
+ * Function: sensor_decode()
+ * Purpose:  Check and convert the received register block of a device.
+ * Input:    device - Device the block was read from
+ * Returns:  1 - Block converted
+ *           0 - Checksum mismatch, nothing changed
+ ******************************************************************************/
+static uint8_t sensor_decode(sensor_device_t *device)
+{
+    switch (device->kind) {
+    case SENSOR_KIND_DHT12:
+        /* Register 4: 8-bit sum of registers 0..3 */
+        if ((uint8_t)(sensor_rx[0] + sensor_rx[1] + sensor_rx[2] +
+                      sensor_rx[3]) != sensor_rx[4]) {
+            return 0;
+        }
+        /* Registers 0..3: humidity integer/decimal, temperature integer/decimal */
+        Meteo_values.humidity_integer = sensor_rx[0];
+        Meteo_values.humidity_decimal = sensor_rx[1];
+        Meteo_values.temperature_integer = sensor_rx[2];
+        Meteo_values.temperature_decimal = sensor_rx[3];
+        device->value = filter_q8_to_centi(filter_dht12_to_q8(
+            Meteo_values.temperature_integer,
+            Meteo_values.temperature_decimal));
+        break;
+    case SENSOR_KIND_LM75:
+        /* Two's complement, 0.5 degree per LSB in bits 15..7 */
+        device->value = (int16_t)(((int16_t)((sensor_rx[0] << 8) | sensor_rx[1])
+                                   >> 7) * 50);
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+/*******************************************************************************
+ * Function: fsm_twi_scanner()
+ * Purpose:  Advance the sensor state machine by one state: probe the
+ *           addresses SENSOR_SCAN_FIRST..SENSOR_SCAN_LAST, then poll the
+ *           devices found round-robin, each within its own period.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void fsm_twi_scanner(void)
+{
+    sensor_driver_t driver;
+    sensor_device_t *device;
+    uint32_t now = timer_millis();
+    uint8_t twi_status;
+    uint8_t i;
+
+    switch (twi_state) {
+    case IDLE_STATE:
+        if (!scan_done) {
+            scan_address = SENSOR_SCAN_FIRST;
+            twi_state = SLA_W_STATE;
+        }
+        else if (sensor_device_total == 0) {
+            /* Nothing found, a sensor may be plugged in later */
+            if ((now - scan_time) >= SENSOR_RESCAN_MS) {
+                scan_done = 0;
+            }
+        }
+        else if (sensor_due(now)) {
+            twi_state = READ_STATE;
+        }
+        break;
+
+    /* Transmit address of TWI slave device and check status */
+    case SLA_W_STATE:
+        if (twi_async_transfer(scan_address, NULL, 0, NULL, 0) == 0) {
+            sensor_transfer_start = now;
+            twi_state = ACK_STATE;
+        }
+        break;
+
+    /* Received ACK from slave, or not */
+    case ACK_STATE:
+        twi_status = sensor_wait(now);
+        if (twi_status == TWI_ASYNC_BUSY) {
+            break;
+        }
+        if (twi_status == TWI_ASYNC_OK) {
+            sensor_register(scan_address);
+        }
+        if (scan_address < SENSOR_SCAN_LAST) {
+            scan_address++;
+            twi_state = SLA_W_STATE;
+        }
+        else {
+            telemetry_scan();
+            scan_done = 1;
+            scan_time = now;
+            twi_state = IDLE_STATE;
+        }
+        break;
+
+    /* Start reading the register block of the selected device */
+    case READ_STATE:
+        device = &sensor_devices[sensor_current];
+        for (i = 0; i < sizeof(sensor_drivers) / sizeof(sensor_drivers[0]); i++) {
+            memcpy_P(&driver, &sensor_drivers[i], sizeof(driver));
+            if (driver.kind == device->kind) {
+                break;
+            }
+        }
+        sensor_reg = driver.reg;
+        if (twi_async_transfer(device->address, &sensor_reg, 1,
+                               sensor_rx, driver.length) == 0) {
+            device->last_poll = now;
+            sensor_transfer_start = now;
+            twi_state = WAIT_STATE;
+        }
+        break;
+
+    case WAIT_STATE:
+        twi_status = sensor_wait(now);
+        if (twi_status == TWI_ASYNC_BUSY) {
+            break;
+        }
+        device = &sensor_devices[sensor_current];
+        if (twi_status != TWI_ASYNC_OK || !sensor_decode(device)) {
+            /* Failed transfer or checksum: retry after SENSOR_RETRY_MS, then
+             * only once per period. Errors are reported by the
+             * TELEMETRY_ERRORS frames */
+            device->errors++;
+            if (device->retries < 0xff) {
+                device->retries++;
+            }
+            twi_state = IDLE_STATE;
+            break;
+        }
+        device->retries = 0;
+        device->timestamp = now;
+        device->valid = 1;
+        if (sensor_current == sensor_main) {
+            twi_state = UART_STATE;
+            break;
+        }
+        telemetry_device(device);
+        twi_state = IDLE_STATE;
+        break;
+
+    case UART_STATE:
+        /* Main DHT12 read successfully, publish the sample */
+        sensor_sample.values = Meteo_values;
+        sensor_sample.temperature = filter_update(&temperature_filter,
+            filter_dht12_to_q8(Meteo_values.temperature_integer,
+                               Meteo_values.temperature_decimal));
+        sensor_sample.humidity = filter_update(&humidity_filter,
+            filter_dht12_to_q8(Meteo_values.humidity_integer,
+                               Meteo_values.humidity_decimal));
+        history_push(&temperature_history, sensor_sample.temperature);
+        sensor_sample.timestamp = sensor_devices[sensor_main].timestamp;
+        sensor_sample.valid = 1;
+        telemetry_sample(&sensor_sample);
+        twi_state = IDLE_STATE;
+        break;
+    default:
+        twi_state = IDLE_STATE;
+    } /* End of switch (twi_state) */
+}
+
+/* END OF FILE ****************************************************************/
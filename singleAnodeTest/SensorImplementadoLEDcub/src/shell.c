@@ -0,0 +1,627 @@
+/**
+  ******************************************************************************
+  * @file    shell.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Command shell on the UART for brightness, animation, threshold,
+  *          refresh rate and diagnostics, parsed incrementally from the
+  *          receive ringbuffer.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include <string.h>
+#include "uart.h"
+#include "timer.h"
+#include "cube.h"
+#include "anim.h"
+#include "mode.h"
+#include "sensor.h"
+#include "stream.h"
+#include "telemetry.h"
+#include "config.h"
+#include "fmt.h"
+#include "shell.h"
+
+/* Constants and macros ------------------------------------------------------*/
+#define SHELL_BACKSPACE 0x08
+#define SHELL_DELETE    0x7f
+
+/* One step of a command: an output line and the prompt after the last */
+#define SHELL_STEP_MAX (SHELL_OUTPUT_MAX + 2)
+
+/* Most a received character writes: the CR LF of a line end and the first
+ * step of its command, more than "\b \b" or the echo of a character */
+#define SHELL_ECHO_MAX (2 + SHELL_STEP_MAX)
+
+#if SHELL_ECHO_MAX > UART_TX_BUFFER_SIZE - 1
+# error "UART_TX_BUFFER_SIZE too small for the shell output"
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+/* Command handler: called with line 0 when the command is entered and again
+ * with the next line number as long as it returns 1 */
+typedef uint8_t (*shell_handler_t)(const char *arg, uint8_t line);
+
+typedef struct {
+    PGM_P name;
+    PGM_P help;             /* Arguments and description */
+    shell_handler_t handler;
+} shell_command_t;
+
+/* Function prototypes -------------------------------------------------------*/
+static uint8_t shell_help(const char *arg, uint8_t line);
+static uint8_t shell_bright(const char *arg, uint8_t line);
+static uint8_t shell_anim(const char *arg, uint8_t line);
+static uint8_t shell_thresh(const char *arg, uint8_t line);
+static uint8_t shell_sensor(const char *arg, uint8_t line);
+static uint8_t shell_stats(const char *arg, uint8_t line);
+static uint8_t shell_rate(const char *arg, uint8_t line);
+static uint8_t shell_stream(const char *arg, uint8_t line);
+static uint8_t shell_telemetry(const char *arg, uint8_t line);
+static uint8_t shell_save(const char *arg, uint8_t line);
+static void shell_execute(void);
+static uint8_t shell_number(const char *s, int32_t *value);
+static void shell_ok(void);
+static void shell_invalid(void);
+
+/* Global variables ----------------------------------------------------------*/
+static const char shell_name_help[] PROGMEM = "help";
+static const char shell_name_bright[] PROGMEM = "bright";
+static const char shell_name_anim[] PROGMEM = "anim";
+static const char shell_name_thresh[] PROGMEM = "thresh";
+static const char shell_name_sensor[] PROGMEM = "sensor";
+static const char shell_name_stats[] PROGMEM = "stats";
+static const char shell_name_rate[] PROGMEM = "rate";
+static const char shell_name_stream[] PROGMEM = "stream";
+static const char shell_name_telemetry[] PROGMEM = "telemetry";
+static const char shell_name_save[] PROGMEM = "save";
+
+static const char shell_help_help[] PROGMEM = "- list the commands";
+static const char shell_help_bright[] PROGMEM = "[0..255] - global brightness";
+static const char shell_help_anim[] PROGMEM = "[id|name|list|auto] - animation";
+static const char shell_help_thresh[] PROGMEM = "[centi-C] - animation threshold";
+static const char shell_help_sensor[] PROGMEM = "- sensor readings";
+static const char shell_help_stats[] PROGMEM = "- counters";
+static const char shell_help_rate[] PROGMEM = "[Hz] - refresh rate of binary frames";
+static const char shell_help_stream[] PROGMEM = "- receive frames until idle";
+static const char shell_help_telemetry[] PROGMEM = "[on|off] - binary telemetry frames";
+static const char shell_help_save[] PROGMEM = "- store the settings in EEPROM";
+
+static const shell_command_t shell_commands[] PROGMEM = {
+    {shell_name_help,      shell_help_help,      shell_help},
+    {shell_name_bright,    shell_help_bright,    shell_bright},
+    {shell_name_anim,      shell_help_anim,      shell_anim},
+    {shell_name_thresh,    shell_help_thresh,    shell_thresh},
+    {shell_name_sensor,    shell_help_sensor,    shell_sensor},
+    {shell_name_stats,     shell_help_stats,     shell_stats},
+    {shell_name_rate,      shell_help_rate,      shell_rate},
+    {shell_name_stream,    shell_help_stream,    shell_stream},
+    {shell_name_telemetry, shell_help_telemetry, shell_telemetry},
+    {shell_name_save,      shell_help_save,      shell_save},
+};
+
+#define SHELL_COMMANDS ((uint8_t)(sizeof(shell_commands) / sizeof(shell_commands[0])))
+
+/* Line being typed, kept as argument of the running command */
+static char shell_buffer[SHELL_LINE_MAX + 1];
+static uint8_t shell_length = 0;
+static uint8_t shell_overflow = 0;
+static uint8_t shell_previous = 0;
+static uint32_t shell_time;         /* timer_millis() of the last character */
+
+/* Command with more output lines to write */
+static shell_handler_t shell_pending = NULL;
+static const char *shell_arg;
+static uint8_t shell_line;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: shell_init()
+ * Purpose:  Print the prompt.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void shell_init(void)
+{
+    uart_puts_P("\r\n> ");
+}
+
+/*******************************************************************************
+ * Function: shell_task()
+ * Purpose:  Collect received characters and run the entered commands.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void shell_task(void)
+{
+    unsigned int c;
+
+    if (stream_enabled()) {
+        return;
+    }
+    /* Every step writes at most one output line, so uart_putc() never
+     * waits for the transmitter */
+    if (uart_tx_free() < SHELL_STEP_MAX) {
+        return;
+    }
+
+    if (shell_pending != NULL) {
+        if (!shell_pending(shell_arg, ++shell_line)) {
+            shell_pending = NULL;
+            uart_puts_P("> ");
+        }
+        return;
+    }
+
+    /* A line nobody finishes must not hold back telemetry */
+    if ((shell_length || shell_overflow) &&
+        timer_millis() - shell_time >= SHELL_IDLE_MS) {
+        shell_length = 0;
+        shell_overflow = 0;
+        uart_puts_P("\r\n> ");
+    }
+
+    /* The rest of the input waits in the receive buffer until its echo
+     * fits */
+    while (uart_tx_free() >= SHELL_ECHO_MAX &&
+           !((c = uart_getc()) & UART_NO_DATA)) {
+        c &= 0xff;
+        shell_time = timer_millis();
+        /* CR, LF and CR LF all end one line */
+        if (c == '\n' && shell_previous == '\r') {
+            shell_previous = 0;
+            continue;
+        }
+        shell_previous = c;
+        if (c == '\r' || c == '\n') {
+            uart_puts_P("\r\n");
+            shell_execute();
+            /* Further input waits until the output is written */
+            return;
+        }
+        if (c == SHELL_BACKSPACE || c == SHELL_DELETE) {
+            if (shell_length) {
+                shell_length--;
+                uart_puts_P("\b \b");
+            }
+        }
+        else if (c >= ' ' && c < SHELL_DELETE) {
+            if (shell_length < SHELL_LINE_MAX) {
+                shell_buffer[shell_length++] = c;
+                uart_putc(c);
+            }
+            else {
+                shell_overflow = 1;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function: shell_busy()
+ * Purpose:  Check whether shell text is being written.
+ * Input:    None
+ * Returns:  1 while a line is typed or a command writes output lines
+ ******************************************************************************/
+uint8_t shell_busy(void)
+{
+    return shell_length != 0 || shell_overflow || shell_pending != NULL;
+}
+
+/*******************************************************************************
+ * Function: shell_execute()
+ * Purpose:  Look up the command of the entered line and run its first step.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+static void shell_execute(void)
+{
+    shell_command_t command;
+    char *arg;
+    uint8_t i;
+
+    /* Without trailing spaces */
+    while (shell_length && shell_buffer[shell_length - 1] == ' ') {
+        shell_length--;
+    }
+    shell_buffer[shell_length] = '\0';
+    shell_length = 0;
+    if (shell_overflow) {
+        shell_overflow = 0;
+        uart_puts_P("? line too long\r\n> ");
+        return;
+    }
+
+    /* Split the command name from the argument */
+    arg = shell_buffer;
+    while (*arg == ' ') {
+        arg++;
+    }
+    if (*arg == '\0') {
+        uart_puts_P("> ");
+        return;
+    }
+    memmove(shell_buffer, arg, strlen(arg) + 1);
+    arg = strchr(shell_buffer, ' ');
+    if (arg != NULL) {
+        *arg++ = '\0';
+        while (*arg == ' ') {
+            arg++;
+        }
+    }
+    else {
+        arg = &shell_buffer[strlen(shell_buffer)];
+    }
+
+    for (i = 0; i < SHELL_COMMANDS; i++) {
+        memcpy_P(&command, &shell_commands[i], sizeof(command));
+        if (strcmp_P(shell_buffer, command.name) == 0) {
+            shell_arg = arg;
+            shell_line = 0;
+            if (command.handler(arg, 0)) {
+                shell_pending = command.handler;
+            }
+            else {
+                uart_puts_P("> ");
+            }
+            return;
+        }
+    }
+    uart_puts_P("? unknown command, try help\r\n> ");
+}
+
+/*******************************************************************************
+ * Function: shell_help()
+ * Purpose:  List the commands, one per line.
+ * Input:    arg - Unused
+ *           line - Command index
+ * Returns:  1 while more commands follow
+ ******************************************************************************/
+static uint8_t shell_help(const char *arg, uint8_t line)
+{
+    shell_command_t command;
+
+    memcpy_P(&command, &shell_commands[line], sizeof(command));
+    uart_puts_p(command.name);
+    uart_putc(' ');
+    uart_puts_p(command.help);
+    uart_puts_P("\r\n");
+    return line + 1 < SHELL_COMMANDS;
+}
+
+/*******************************************************************************
+ * Function: shell_bright()
+ * Purpose:  Show or set the global brightness.
+ * Input:    arg - Empty or 0 .. 255
+ *           line - Unused
+ * Returns:  0
+ ******************************************************************************/
+static uint8_t shell_bright(const char *arg, uint8_t line)
+{
+    int32_t value;
+
+    if (*arg == '\0') {
+        fmt_dec(cube_get_brightness());
+        uart_puts_P("\r\n");
+    }
+    else if (shell_number(arg, &value) && value >= 0 &&
+             value <= CUBE_BRIGHTNESS_MAX) {
+        cube_set_brightness(value);
+        shell_ok();
+    }
+    else {
+        shell_invalid();
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: shell_anim()
+ * Purpose:  Show, list, fix or release the animation.
+ * Input:    arg - Empty, "list", "auto", an id or a name
+ *           line - Animation id while listing
+ * Returns:  1 while more animations are listed
+ ******************************************************************************/
+static uint8_t shell_anim(const char *arg, uint8_t line)
+{
+    int32_t value;
+    uint8_t id;
+
+    if (*arg == '\0') {
+        uart_puts_p(anim_name(anim_current()));
+        if (mode_fixed() == MODE_AUTO) {
+            uart_puts_P(" (auto)");
+        }
+        uart_puts_P("\r\n");
+        return 0;
+    }
+    if (strcmp_P(arg, PSTR("list")) == 0) {
+        fmt_dec(line);
+        uart_putc(' ');
+        uart_puts_p(anim_name(line));
+        uart_puts_P("\r\n");
+        return line + 1 < ANIM_COUNT;
+    }
+    if (strcmp_P(arg, PSTR("auto")) == 0) {
+        mode_set_fixed(MODE_AUTO);
+        /* The main loop chooses again */
+        anim_start(ANIM_NONE);
+        shell_ok();
+        return 0;
+    }
+
+    if (shell_number(arg, &value)) {
+        id = (value >= 0 && value < ANIM_COUNT) ? value : ANIM_COUNT;
+    }
+    else {
+        for (id = 0; id < ANIM_COUNT; id++) {
+            if (strcmp_P(arg, anim_name(id)) == 0) {
+                break;
+            }
+        }
+    }
+    if (id >= ANIM_COUNT) {
+        shell_invalid();
+        return 0;
+    }
+    mode_set_fixed(id);
+    anim_start(id);
+    shell_ok();
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: shell_thresh()
+ * Purpose:  Show or set the animation threshold.
+ * Input:    arg - Empty or centi-degrees
+ *           line - Unused
+ * Returns:  0
+ ******************************************************************************/
+static uint8_t shell_thresh(const char *arg, uint8_t line)
+{
+    int32_t value;
+
+    if (*arg == '\0') {
+        fmt_fixed(mode_threshold(), 2);
+        uart_puts_P(" C\r\n");
+    }
+    else if (shell_number(arg, &value) && value >= -4000 && value <= 8000) {
+        mode_set_threshold(value);
+        shell_ok();
+    }
+    else {
+        shell_invalid();
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: shell_sensor()
+ * Purpose:  Dump the main sample, then one device per line.
+ * Input:    arg - Unused
+ *           line - 0 for the sample, device index + 1 otherwise
+ * Returns:  1 while more devices follow
+ ******************************************************************************/
+static uint8_t shell_sensor(const char *arg, uint8_t line)
+{
+    sensor_sample_t sample;
+    sensor_device_t device;
+
+    if (line == 0) {
+        if (sensor_get(&sample)) {
+            uart_puts_P("main ");
+            fmt_fixed(sample.temperature, 2);
+            uart_puts_P(" C ");
+            fmt_fixed(sample.humidity, 2);
+            uart_puts_P(" %\r\n");
+        }
+        else {
+            uart_puts_P("main no data\r\n");
+        }
+        return sensor_device_count() > 0;
+    }
+
+    if (sensor_device_get(line - 1, &device)) {
+        uart_puts_P("0x");
+        fmt_hex(device.address, 2);
+        uart_puts_P(" region ");
+        fmt_dec(device.region);
+        uart_putc(' ');
+        if (device.valid) {
+            fmt_fixed(device.value, 2);
+            uart_puts_P(" C");
+        }
+        else {
+            uart_puts_P("-");
+        }
+        uart_puts_P(" errors ");
+        fmt_dec(device.errors);
+        uart_puts_P("\r\n");
+    }
+    return line < sensor_device_count();
+}
+
+/*******************************************************************************
+ * Function: shell_stats()
+ * Purpose:  Print the counters of the tasks.
+ * Input:    arg - Unused
+ *           line - Counter group
+ * Returns:  1 while more groups follow
+ ******************************************************************************/
+static uint8_t shell_stats(const char *arg, uint8_t line)
+{
+    stream_stats_t stats;
+
+    switch (line) {
+    case 0:
+        uart_puts_P("uptime ");
+        fmt_udec(timer_millis() / 1000);
+        uart_puts_P(" s\r\n");
+        return 1;
+    case 1:
+        uart_puts_P("telemetry ");
+        fmt_dec(telemetry_frames());
+        uart_puts_P(" frames, uart ");
+        fmt_dec(uart_tx_dropped());
+        uart_puts_P(" dropped\r\n");
+        return 1;
+    case 2:
+        uart_puts_P("cube ");
+        fmt_dec(cube_frame_count());
+        uart_puts_P(" swaps, ");
+        fmt_dec(cube_get_rate());
+        uart_puts_P(" Hz\r\n");
+        return 1;
+    default:
+        stream_get_stats(&stats);
+        uart_puts_P("stream ");
+        fmt_dec(stats.frames);
+        uart_puts_P(" lost ");
+        fmt_dec(stats.lost);
+        uart_puts_P(" stale ");
+        fmt_dec(stats.stale);
+        uart_puts_P(" errors ");
+        fmt_dec(stats.errors);
+        uart_puts_P("\r\n");
+        return 0;
+    }
+}
+
+/*******************************************************************************
+ * Function: shell_rate()
+ * Purpose:  Show or set the refresh rate.
+ * Input:    arg - Empty or frames per second
+ *           line - Unused
+ * Returns:  0
+ ******************************************************************************/
+static uint8_t shell_rate(const char *arg, uint8_t line)
+{
+    int32_t value;
+
+    if (*arg == '\0') {
+        fmt_dec(cube_get_rate());
+        uart_puts_P(" Hz\r\n");
+    }
+    else if (shell_number(arg, &value) && value >= CUBE_RATE_MIN &&
+             value <= CUBE_RATE_MAX) {
+        cube_set_rate(value);
+        shell_ok();
+    }
+    else {
+        shell_invalid();
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: shell_stream()
+ * Purpose:  Hand the receiver to the frame stream until it times out.
+ * Input:    arg - Unused
+ *           line - Unused
+ * Returns:  0
+ ******************************************************************************/
+static uint8_t shell_stream(const char *arg, uint8_t line)
+{
+    shell_ok();
+    stream_start();
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: shell_telemetry()
+ * Purpose:  Show, start or stop the binary telemetry frames.
+ * Input:    arg - Empty, "on" or "off"
+ *           line - Unused
+ * Returns:  0
+ ******************************************************************************/
+static uint8_t shell_telemetry(const char *arg, uint8_t line)
+{
+    if (*arg == '\0') {
+        if (telemetry_enabled()) {
+            uart_puts_P("on\r\n");
+        }
+        else {
+            uart_puts_P("off\r\n");
+        }
+    }
+    else if (strcmp_P(arg, PSTR("on")) == 0) {
+        telemetry_set_enabled(1);
+        shell_ok();
+    }
+    else if (strcmp_P(arg, PSTR("off")) == 0) {
+        telemetry_set_enabled(0);
+        shell_ok();
+    }
+    else {
+        shell_invalid();
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: shell_save()
+ * Purpose:  Store brightness, rate, threshold and animation in EEPROM.
+ * Input:    arg - Unused
+ *           line - Unused
+ * Returns:  0
+ ******************************************************************************/
+static uint8_t shell_save(const char *arg, uint8_t line)
+{
+    config_save();
+    shell_ok();
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: shell_number()
+ * Purpose:  Parse a decimal number.
+ * Input:    s - Text, optional minus sign and up to 9 digits
+ *           value - Destination
+ * Returns:  1 if the whole text is a number, 0 otherwise
+ ******************************************************************************/
+static uint8_t shell_number(const char *s, int32_t *value)
+{
+    int32_t result = 0;
+    uint8_t negative = 0, digits = 0;
+
+    if (*s == '-') {
+        negative = 1;
+        s++;
+    }
+    while (*s >= '0' && *s <= '9' && digits < 9) {
+        result = result * 10 + (*s++ - '0');
+        digits++;
+    }
+    if (digits == 0 || *s != '\0') {
+        return 0;
+    }
+    *value = negative ? -result : result;
+    return 1;
+}
+
+/*******************************************************************************
+ * Function: shell_ok()
+ * Purpose:  Acknowledge a setting.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+static void shell_ok(void)
+{
+    uart_puts_P("ok\r\n");
+}
+
+/*******************************************************************************
+ * Function: shell_invalid()
+ * Purpose:  Reject an argument.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+static void shell_invalid(void)
+{
+    uart_puts_P("? invalid argument\r\n");
+}
+
+/* END OF FILE ****************************************************************/
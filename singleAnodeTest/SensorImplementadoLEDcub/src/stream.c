@@ -0,0 +1,389 @@
+/**
+  ******************************************************************************
+  * @file    stream.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   COBS framed binary and grey scale cube frames from a host over
+  *          the UART, decoded straight into the cube back buffer.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include "uart.h"
+#include "timer.h"
+#include "anim.h"
+#include "crc.h"
+#include "stream.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* LEDs per frame */
+#define STREAM_LEDS (CUBE_LAYERS * CUBE_COLOURS * CUBE_COLUMNS)
+
+/* COBS code of a block of 254 data bytes without implied zero */
+#define STREAM_COBS_MAX 0xff
+
+/* UART errors that corrupt the packet being received */
+#define STREAM_UART_ERRORS (UART_FRAME_ERROR | UART_OVERRUN_ERROR | \
+                            UART_BUFFER_OVERFLOW)
+
+/* Global variables ----------------------------------------------------------*/
+/* COBS decoder: code of the current block (0 before the first one), data
+ * bytes left in it and error flag until the next delimiter */
+static uint8_t stream_code = 0;
+static uint8_t stream_remaining = 0;
+static uint8_t stream_error = 0;
+
+/* Packet being received: decoded bytes so far, sequence number, frame size
+ * and bit planes per LED of its type */
+static uint8_t stream_position = 0;
+static uint8_t stream_pending = 0;
+static uint8_t stream_size = 0;
+static uint8_t stream_planes = 0;
+static uint8_t stream_in_sequence = 0;
+static uint8_t stream_crc;
+
+/* Next LED of the back buffer */
+static cube_frame_t *stream_frame;
+static uint8_t stream_leds = 0;
+static uint8_t stream_layer = 0;
+static uint8_t stream_colour = 0;
+static uint8_t stream_column = 0;
+
+/* Receiver handed to the stream by stream_start() */
+static volatile uint8_t stream_open = 0;
+
+/* Last frame shown, or stream_start() before the first one */
+static uint8_t stream_sequence = 0;
+static uint32_t stream_time = 0;
+static uint8_t stream_started = 0;
+
+static stream_stats_t stream_counters;
+
+/* Function prototypes -------------------------------------------------------*/
+static void stream_reset(void);
+static void stream_byte(uint8_t data);
+static void stream_led(uint8_t level);
+static void stream_packet_done(void);
+static uint8_t stream_running(void);
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: stream_feed()
+ * Purpose:  COBS decode one byte.
+ * Input:    data - Received byte
+ * Returns:  None
+ ******************************************************************************/
+void stream_feed(uint8_t data)
+{
+    if (data == 0) {
+        /* Delimiter: the packet is complete if the last block is */
+        if (!stream_error && stream_code && !stream_remaining) {
+            stream_packet_done();
+        }
+        stream_reset();
+        return;
+    }
+    if (stream_error) {
+        return;
+    }
+
+    if (stream_remaining == 0) {
+        /* Code byte; every block but a full one is followed by a zero */
+        if (stream_code && stream_code != STREAM_COBS_MAX) {
+            stream_byte(0);
+        }
+        stream_code = data;
+        stream_remaining = data - 1;
+        return;
+    }
+    stream_byte(data);
+    stream_remaining--;
+}
+
+/*******************************************************************************
+ * Function: stream_start()
+ * Purpose:  Hand the UART receiver to the stream decoder and stop the
+ *           animation player, so only the decoder writes the back buffer.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void stream_start(void)
+{
+    anim_start(ANIM_NONE);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stream_reset();
+        stream_started = 0;
+        /* The timeout runs from now until the first frame */
+        stream_time = timer_millis();
+        stream_open = 1;
+    }
+}
+
+/*******************************************************************************
+ * Function: stream_enabled()
+ * Purpose:  Check whether the receiver belongs to the stream decoder.
+ * Input:    None
+ * Returns:  1 between stream_start() and the timeout
+ ******************************************************************************/
+uint8_t stream_enabled(void)
+{
+    return stream_open;
+}
+
+/*******************************************************************************
+ * Function: stream_task()
+ * Purpose:  Feed the received bytes to the decoder, keep the animation
+ *           player stopped while the receiver belongs to it and give the
+ *           receiver back after the timeout.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void stream_task(void)
+{
+#ifndef UART_RX_HOOK
+    unsigned int c;
+#endif
+
+    if (!stream_open) {
+        return;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if ((timer_millis() - stream_time) >= STREAM_TIMEOUT_MS) {
+            stream_open = 0;
+            stream_started = 0;
+        }
+    }
+    if (!stream_open) {
+        return;
+    }
+
+#ifndef UART_RX_HOOK
+    while (!((c = uart_getc()) & UART_NO_DATA)) {
+        if ((c & STREAM_UART_ERRORS) && !stream_error) {
+            /* Bytes were lost, drop the packet up to the next delimiter */
+            stream_error = 1;
+            stream_counters.errors++;
+        }
+        stream_feed((uint8_t)c);
+    }
+#endif
+
+    /* The player is not interrupt safe, so it is stopped from here, e.g.
+     * after the TWI master started an animation */
+    if (anim_current() != ANIM_NONE) {
+        anim_start(ANIM_NONE);
+    }
+}
+
+/*******************************************************************************
+ * Function: stream_active()
+ * Purpose:  Check whether the host is streaming.
+ * Input:    None
+ * Returns:  1 if a frame was shown within STREAM_TIMEOUT_MS
+ ******************************************************************************/
+uint8_t stream_active(void)
+{
+    uint8_t active;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        active = stream_running();
+    }
+    return active;
+}
+
+/*******************************************************************************
+ * Function: stream_get_stats()
+ * Purpose:  Copy the receive counters.
+ * Input:    stats - Destination
+ * Returns:  None
+ ******************************************************************************/
+void stream_get_stats(stream_stats_t *stats)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        *stats = stream_counters;
+    }
+}
+
+#ifdef UART_RX_HOOK
+/*******************************************************************************
+ * Function: uart_rx_hook()
+ * Purpose:  Decode every received byte inside the UART receive interrupt.
+ * Input:    data - Received byte
+ *           error - UART error bits
+ * Returns:  1 if the stream owns the receiver, 0 to store the byte
+ ******************************************************************************/
+unsigned char uart_rx_hook(unsigned char data, unsigned char error)
+{
+    if (!stream_open) {
+        return 0;
+    }
+    if (error && !stream_error) {
+        stream_error = 1;
+        stream_counters.errors++;
+    }
+    stream_feed(data);
+    return 1;
+}
+#endif
+
+/*******************************************************************************
+ * Function: stream_reset()
+ * Purpose:  Wait for the first byte of the next packet.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+static void stream_reset(void)
+{
+    stream_code = 0;
+    stream_remaining = 0;
+    stream_error = 0;
+    stream_position = 0;
+}
+
+/*******************************************************************************
+ * Function: stream_byte()
+ * Purpose:  Handle one decoded byte of the packet.
+ * Input:    data - Packet byte
+ * Returns:  None
+ ******************************************************************************/
+static void stream_byte(uint8_t data)
+{
+    /* CRC over the whole packet including its CRC byte ends at 0 */
+    stream_crc = crc8_update(stream_position ? stream_crc : CRC8_INIT, data);
+
+    switch (stream_position) {
+    case 0:
+        stream_pending = data;
+        stream_in_sequence = stream_running();
+        /* Modulo 256: up to 127 frames ahead are newer */
+        if (stream_in_sequence && (int8_t)(data - stream_sequence) <= 0) {
+            stream_error = 1;
+            stream_counters.stale++;
+            return;
+        }
+        break;
+
+    case 1:
+        if (data == STREAM_BINARY) {
+            stream_frame = cube_back();
+            stream_size = STREAM_BINARY_SIZE;
+            stream_planes = 1;
+        }
+        else if (data == STREAM_GREY) {
+            stream_frame = cube_back_planes();
+            stream_size = STREAM_GREY_SIZE;
+            stream_planes = CUBE_BAM_BITS;
+        }
+        else {
+            stream_error = 1;
+            stream_counters.errors++;
+            return;
+        }
+        stream_leds = 0;
+        stream_layer = 0;
+        stream_colour = 0;
+        stream_column = 0;
+        break;
+
+    default:
+        if (stream_position == STREAM_HEADER + stream_size) {
+            /* CRC byte */
+            break;
+        }
+        if (stream_position > STREAM_HEADER + stream_size) {
+            stream_error = 1;
+            stream_counters.errors++;
+            return;
+        }
+        if (stream_planes == 1) {
+            uint8_t bit;
+
+            for (bit = 0; bit < 8 && stream_leds < STREAM_LEDS; bit++) {
+                stream_led(data);
+                data >>= 1;
+            }
+        }
+        else {
+            stream_led(data);
+            if (stream_leds < STREAM_LEDS) {
+                stream_led(data >> 4);
+            }
+        }
+        break;
+    }
+    stream_position++;
+}
+
+/*******************************************************************************
+ * Function: stream_led()
+ * Purpose:  Write the next LED into every bit plane of the back buffer.
+ * Input:    level - Brightness, bit n for plane n
+ * Returns:  None
+ ******************************************************************************/
+static void stream_led(uint8_t level)
+{
+    uint16_t bit = _BV(stream_column);
+    uint8_t plane;
+
+    for (plane = 0; plane < stream_planes; plane++) {
+        uint16_t *mask = &stream_frame[plane].column[stream_layer][stream_colour];
+
+        if (level & _BV(plane)) {
+            *mask |= bit;
+        }
+        else {
+            *mask &= ~bit;
+        }
+    }
+
+    stream_leds++;
+    if (++stream_column >= CUBE_COLUMNS) {
+        stream_column = 0;
+        if (++stream_colour >= CUBE_COLOURS) {
+            stream_colour = 0;
+            stream_layer++;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function: stream_packet_done()
+ * Purpose:  Show a packet whose delimiter has been received.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+static void stream_packet_done(void)
+{
+    /* Also catches packets that ended within the header */
+    if (stream_position != STREAM_HEADER + stream_size + STREAM_TRAILER ||
+        stream_crc != 0) {
+        stream_counters.errors++;
+        return;
+    }
+
+    if (stream_in_sequence) {
+        stream_counters.lost += (uint8_t)(stream_pending - stream_sequence - 1);
+    }
+    stream_sequence = stream_pending;
+    stream_time = timer_millis();
+    stream_started = 1;
+
+    cube_swap();
+    stream_counters.frames++;
+}
+
+/*******************************************************************************
+ * Function: stream_running()
+ * Purpose:  Check the time of the last frame, with the stream state locked.
+ * Input:    None
+ * Returns:  1 if a frame was shown within STREAM_TIMEOUT_MS
+ ******************************************************************************/
+static uint8_t stream_running(void)
+{
+    return stream_started &&
+           (timer_millis() - stream_time) < STREAM_TIMEOUT_MS;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,198 @@
+/**
+  ******************************************************************************
+  * @file    telemetry.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Binary telemetry frames (sync, type, length, payload, CRC-16)
+  *          replacing the text output of the sensor task.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "settings.h"
+#include "hal.h"
+#include "uart.h"
+#include "crc.h"
+#include "timer.h"
+#include "cube.h"
+#include "anim.h"
+#include "shell.h"
+#include "telemetry.h"
+
+/* Constants and macros ------------------------------------------------------*/
+/* Store a 16-bit value little endian */
+#define telemetry_put16(p, v) do { (p)[0] = (uint8_t)(v); \
+                                   (p)[1] = (uint8_t)((uint16_t)(v) >> 8); } while (0)
+
+/* Global variables ----------------------------------------------------------*/
+static uint16_t telemetry_count = 0;
+static uint16_t telemetry_dropped = 0;
+static uint32_t telemetry_stats_time = 0;
+static uint8_t telemetry_on = TELEMETRY_ENABLE;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: telemetry_send()
+ * Purpose:  Build a complete frame and queue it if it fits into the TX ring,
+ *           unless telemetry is off or the shell text must not be split.
+ * Input:    type - Frame type
+ *           payload - Payload bytes
+ *           length - Payload length
+ * Returns:  None
+ ******************************************************************************/
+void telemetry_send(uint8_t type, const void *payload, uint8_t length)
+{
+    uint8_t frame[TELEMETRY_PAYLOAD_MAX + TELEMETRY_OVERHEAD];
+    const uint8_t *data = payload;
+    uint16_t crc;
+    uint8_t i, n = 0;
+
+    if (!telemetry_on || shell_busy()) {
+        return;
+    }
+    if (length > TELEMETRY_PAYLOAD_MAX) {
+        length = TELEMETRY_PAYLOAD_MAX;
+    }
+    frame[n++] = TELEMETRY_SYNC;
+    frame[n++] = type;
+    frame[n++] = length;
+    for (i = 0; i < length; i++) {
+        frame[n++] = data[i];
+    }
+    /* CRC over type, length and payload, high byte first so that the CRC
+     * of the whole frame after the sync byte is 0 */
+    crc = crc16_block(CRC16_INIT, &frame[1], n - 1);
+    frame[n++] = (uint8_t)(crc >> 8);
+    frame[n++] = (uint8_t)crc;
+
+    /* Whole frame or nothing, a partial frame would only cost the receiver
+     * a resync */
+    if (uart_tx_free() < n) {
+        telemetry_dropped++;
+        return;
+    }
+    uart_write(frame, n);
+    telemetry_count++;
+}
+
+/*******************************************************************************
+ * Function: telemetry_sample()
+ * Purpose:  Send the filtered reading of the main DHT12.
+ * Input:    sample - Sensor reading
+ * Returns:  None
+ ******************************************************************************/
+void telemetry_sample(const sensor_sample_t *sample)
+{
+    uint8_t payload[4];
+
+    telemetry_put16(&payload[0], sample->temperature);
+    telemetry_put16(&payload[2], sample->humidity);
+    telemetry_send(TELEMETRY_SAMPLE, payload, sizeof(payload));
+}
+
+/*******************************************************************************
+ * Function: telemetry_device()
+ * Purpose:  Send the last reading of an additional sensor.
+ * Input:    device - Device table entry
+ * Returns:  None
+ ******************************************************************************/
+void telemetry_device(const sensor_device_t *device)
+{
+    uint8_t payload[4];
+
+    payload[0] = device->region;
+    payload[1] = device->address;
+    telemetry_put16(&payload[2], device->value);
+    telemetry_send(TELEMETRY_DEVICE, payload, sizeof(payload));
+}
+
+/*******************************************************************************
+ * Function: telemetry_scan()
+ * Purpose:  Send the addresses registered by the bus scan.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void telemetry_scan(void)
+{
+    uint8_t payload[SENSOR_MAX_DEVICES];
+    sensor_device_t device;
+    uint8_t i;
+
+    for (i = 0; sensor_device_get(i, &device); i++) {
+        payload[i] = device.address;
+    }
+    telemetry_send(TELEMETRY_SCAN, payload, i);
+}
+
+/*******************************************************************************
+ * Function: telemetry_task()
+ * Purpose:  Send the counter and error frames every TELEMETRY_STATS_MS.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void telemetry_task(void)
+{
+    uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+    sensor_device_t device;
+    uint32_t now = timer_millis();
+    uint8_t i, n;
+
+    if ((now - telemetry_stats_time) < TELEMETRY_STATS_MS) {
+        return;
+    }
+    telemetry_stats_time = now;
+
+    telemetry_put16(&payload[0], now);
+    telemetry_put16(&payload[2], now >> 16);
+    telemetry_put16(&payload[4], telemetry_count);
+    payload[6] = cube_frame_count();
+    payload[7] = anim_current();
+    telemetry_put16(&payload[8], telemetry_dropped);
+    telemetry_put16(&payload[10], uart_tx_dropped());
+    telemetry_send(TELEMETRY_COUNTERS, payload, 12);
+
+    n = 0;
+    for (i = 0; sensor_device_get(i, &device) &&
+                n + 4 <= TELEMETRY_PAYLOAD_MAX; i++) {
+        payload[n++] = device.address;
+        telemetry_put16(&payload[n], device.errors);
+        n += 2;
+        payload[n++] = device.retries;
+    }
+    telemetry_send(TELEMETRY_ERRORS, payload, n);
+}
+
+/*******************************************************************************
+ * Function: telemetry_frames()
+ * Purpose:  Number of frames queued since reset.
+ * Input:    None
+ * Returns:  Frame counter, wraps at 65536
+ ******************************************************************************/
+uint16_t telemetry_frames(void)
+{
+    return telemetry_count;
+}
+
+/*******************************************************************************
+ * Function: telemetry_set_enabled()
+ * Purpose:  Start or stop sending frames.
+ * Input:    enable - 1 to send, 0 to stop
+ * Returns:  None
+ ******************************************************************************/
+void telemetry_set_enabled(uint8_t enable)
+{
+    telemetry_on = enable ? 1 : 0;
+}
+
+/*******************************************************************************
+ * Function: telemetry_enabled()
+ * Purpose:  Check whether frames are sent.
+ * Input:    None
+ * Returns:  1 if sent, 0 if stopped
+ ******************************************************************************/
+uint8_t telemetry_enabled(void)
+{
+    return telemetry_on;
+}
+
+/* END OF FILE ****************************************************************/
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file    timer.c
+  * @version V1.0
+  * @date    Oct 18, 2026
+  * @brief   Millisecond time base on Timer/Counter0 (CTC mode).
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hal.h"
+#include "lcd.h"
+#include "display.h"
+#include "timer.h"
+
+/* Global variables ----------------------------------------------------------*/
+/* Incremented by the compare match interrupt */
+static volatile uint32_t timer_ms = 0;
+
+/* Functions -----------------------------------------------------------------*/
+/*******************************************************************************
+ * Function: timer_init()
+ * Purpose:  Start Timer/Counter0 in CTC mode with a 1 ms compare interrupt.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void timer_init(void)
+{
+    /* CTC mode, TOP = OCR0A */
+    HAL_WRITE(TCCR0A, _BV(WGM01));
+    HAL_WRITE(OCR0A, TIMER_OCR0A_VALUE);
+    /* Clock prescaler 64 => 250 kHz timer clock at 16 MHz */
+    HAL_WRITE(TCCR0B, _BV(CS01) | _BV(CS00));
+    /* Compare match A interrupt enable */
+    HAL_SET(TIMSK0, _BV(OCIE0A));
+}
+
+/*******************************************************************************
+ * Function: timer_millis()
+ * Purpose:  Read the millisecond counter.
+ * Input:    None
+ * Returns:  Milliseconds elapsed since timer_init()
+ ******************************************************************************/
+uint32_t timer_millis(void)
+{
+    uint32_t ms;
+
+    /* 32-bit read is not atomic on AVR */
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = timer_ms;
+    }
+    return ms;
+}
+
+/**
+  * @brief Time base tick, every 1 ms.
+  */
+ISR(TIMER0_COMPA_vect)
+{
+    timer_ms++;
+#if DISPLAY_ENABLE
+    /* Queued LCD nibbles, at most one byte per tick */
+    lcd_tick();
+#endif
+}
+
+/* END OF FILE ****************************************************************/
@@ -28,12 +28,59 @@
  *
  ******************************************************************************/
 
-/* Includes ------------------------------------------------------------------*/
-#include "twi.h"
+/* Includes ------------------------------------------------------------------*/
+#include "hal.h"
+#include "twi.h"
 
-/* Constants and macros ------------------------------------------------------*/
+/* Constants and macros ------------------------------------------------------*/
 /* Address of data direction register of port x */
-#define DDR(x) (*(&x - 1))
+#define DDR(x) HAL_DDR(x)
+
+/* TWI status codes used by the asynchronous transfers */
+#define TW_START        0x08
+#define TW_REP_START    0x10
+#define TW_MT_SLA_ACK   0x18
+#define TW_MT_SLA_NACK  0x20
+#define TW_MT_DATA_ACK  0x28
+#define TW_MT_DATA_NACK 0x30
+#define TW_ARB_LOST     0x38
+#define TW_MR_SLA_ACK   0x40
+#define TW_MR_SLA_NACK  0x48
+#define TW_MR_DATA_ACK  0x50
+#define TW_MR_DATA_NACK 0x58
+
+/* TWI status codes of the slave mode */
+#define TW_SR_SLA_ACK            0x60
+#define TW_SR_ARB_LOST_SLA_ACK   0x68
+#define TW_SR_GCALL_ACK          0x70
+#define TW_SR_ARB_LOST_GCALL_ACK 0x78
+#define TW_SR_DATA_ACK           0x80
+#define TW_SR_DATA_NACK          0x88
+#define TW_SR_GCALL_DATA_ACK     0x90
+#define TW_SR_GCALL_DATA_NACK    0x98
+#define TW_SR_STOP               0xa0
+#define TW_ST_SLA_ACK            0xa8
+#define TW_ST_ARB_LOST_SLA_ACK   0xb0
+#define TW_ST_DATA_ACK           0xb8
+#define TW_ST_DATA_NACK          0xc0
+#define TW_ST_LAST_DATA          0xc8
+#define TW_BUS_ERROR             0x00
+
+/* Global variables ----------------------------------------------------------*/
+/* Asynchronous transfer, owned by TWI_vect while twi_async_state is busy */
+static volatile uint8_t twi_async_state = TWI_ASYNC_OK;
+static uint8_t twi_async_address;
+static const uint8_t *twi_async_tx;
+static uint8_t twi_async_tx_len;
+static uint8_t *twi_async_rx;
+static uint8_t twi_async_rx_len;
+static uint8_t twi_async_pos;
+
+#ifdef TWI_SLAVE_ADDRESS
+/* Register pointer of the slave mode, set by the first byte of a write */
+static uint8_t twi_slave_reg;
+static uint8_t twi_slave_first;
+#endif
 
 /* Functions -----------------------------------------------------------------*/
 /*******************************************************************************
@@ -45,12 +92,12 @@
 void twi_init(void)
 {
     /* Enable internal pull-up resistors */
-    DDR(TWI_PORT) &= ~(_BV(TWI_SDA_PIN) | _BV(TWI_SCL_PIN));
-    TWI_PORT |= _BV(TWI_SDA_PIN) | _BV(TWI_SCL_PIN);
+    HAL_CLEAR(DDR(TWI_PORT), _BV(TWI_SDA_PIN) | _BV(TWI_SCL_PIN));
+    HAL_SET(TWI_PORT, _BV(TWI_SDA_PIN) | _BV(TWI_SCL_PIN));
 
     /* Set SCL frequency */
-    TWSR &= ~(_BV(TWPS1) | _BV(TWPS0));
-    TWBR = TWI_BIT_RATE_REG;
+    HAL_CLEAR(TWSR, _BV(TWPS1) | _BV(TWPS0));
+    HAL_WRITE(TWBR, TWI_BIT_RATE_REG);
 }
 
 /*******************************************************************************
@@ -63,31 +110,31 @@ void twi_init(void)
  *           0x18: SLA+W has been transmitted and ACK has been received
  *           0x40: SLA+R has been transmitted and ACK has been received
  ******************************************************************************/
-uint8_t twi_start(uint8_t slave_address)
-{
-    uint8_t twi_response;
-
-    /* Generate start condition on TWI bus */
-    TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN);
-    while ((TWCR & _BV(TWINT)) == 0);
-
-    /* Send SLA+R or SLA+W frame on TWI bus */
-    TWDR = slave_address;
-    TWCR = _BV(TWINT) | _BV(TWEN);
-    while ((TWCR & _BV(TWINT)) == 0);
-
-    /* Check TWI Status Register and mask TWI prescaler bits */
-    twi_response = TWSR & 0xf8;
-    /* Status Code 0x18: SLA+W has been transmitted and ACK has been received
-                   0x40: SLA+R has been transmitted and ACK has been received */
-        if (twi_response == 0x18 || twi_response == 0x40) {
-        return 0;   /* Slave device accessible */
-    }
-    else {
-        return 1;   /* Failed to access slave device */
-    }
-}
-
+uint8_t twi_start(uint8_t slave_address)
+{
+    uint8_t twi_response;
+
+    /* Generate start condition on TWI bus */
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWSTA) | _BV(TWEN));
+    while ((HAL_READ(TWCR) & _BV(TWINT)) == 0);
+
+    /* Send SLA+R or SLA+W frame on TWI bus */
+    HAL_WRITE(TWDR, slave_address);
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEN));
+    while ((HAL_READ(TWCR) & _BV(TWINT)) == 0);
+
+    /* Check TWI Status Register and mask TWI prescaler bits */
+    twi_response = HAL_READ(TWSR) & 0xf8;
+    /* Status Code 0x18: SLA+W has been transmitted and ACK has been received
+                   0x40: SLA+R has been transmitted and ACK has been received */
+    if (twi_response == 0x18 || twi_response == 0x40) {
+        return 0;   /* Slave device accessible */
+    }
+    else {
+        return 1;   /* Failed to access slave device */
+    }
+}
+
 /*******************************************************************************
  * Function: twi_write()
  * Purpose:  Send one byte to TWI slave device.
@@ -95,11 +142,11 @@ uint8_t twi_start(uint8_t slave_address)
  * Returns:  None
  ******************************************************************************/
 void twi_write(uint8_t data)
-{
-    TWDR = data;
-    TWCR = _BV(TWINT) | _BV(TWEN);
-    while ((TWCR & _BV(TWINT)) == 0);
-}
+{
+    HAL_WRITE(TWDR, data);
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEN));
+    while ((HAL_READ(TWCR) & _BV(TWINT)) == 0);
+}
 
 /*******************************************************************************
  * Function: twi_read_ack()
@@ -108,10 +155,10 @@ void twi_write(uint8_t data)
  * Returns:  Received data
  ******************************************************************************/
 uint8_t twi_read_ack(void)
-{
-	TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWEA);
-    while ((TWCR & _BV(TWINT)) == 0);
-	return (TWDR);
+{
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEN) | _BV(TWEA));
+    while ((HAL_READ(TWCR) & _BV(TWINT)) == 0);
+    return (HAL_READ(TWDR));
 }
 
 /*******************************************************************************
@@ -121,10 +168,10 @@ uint8_t twi_read_ack(void)
  * Returns:  Received data
  ******************************************************************************/
 uint8_t twi_read_nack(void)
-{
-	TWCR = _BV(TWINT) | _BV(TWEN);
-    while ((TWCR & _BV(TWINT)) == 0);
-	return (TWDR);
+{
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEN));
+    while ((HAL_READ(TWCR) & _BV(TWINT)) == 0);
+    return (HAL_READ(TWDR));
 }
 
 /*******************************************************************************
@@ -134,8 +181,218 @@ uint8_t twi_read_nack(void)
  * Returns:  None
  ******************************************************************************/
 void twi_stop(void)
-{
-    TWCR = _BV(TWINT) | _BV(TWSTO) | _BV(TWEN);
-}
-
-/* END OF FILE ****************************************************************/
+{
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWSTO) | _BV(TWEN));
+}
+
+/*******************************************************************************
+ * Function: twi_async_transfer()
+ * Purpose:  Start an interrupt driven write and/or read transfer.
+ * Input:    address - 7-bit address of TWI slave device
+ *           tx, tx_len - Bytes to write
+ *           rx, rx_len - Buffer and number of bytes to read
+ * Returns:  0 - Transfer started
+ *           1 - Previous transfer still running
+ ******************************************************************************/
+uint8_t twi_async_transfer(uint8_t address, const uint8_t *tx, uint8_t tx_len,
+                           uint8_t *rx, uint8_t rx_len)
+{
+    if (twi_async_state == TWI_ASYNC_BUSY) {
+        return 1;
+    }
+    twi_async_address = address;
+    twi_async_tx = tx;
+    twi_async_tx_len = tx_len;
+    twi_async_rx = rx;
+    twi_async_rx_len = rx_len;
+    twi_async_pos = 0;
+    twi_async_state = TWI_ASYNC_BUSY;
+
+    /* The STOP of the previous transfer is still on the bus while TWSTO is
+     * set, a START written now would be lost */
+    while (HAL_READ(TWCR) & _BV(TWSTO)) {
+        HAL_WAIT();
+    }
+
+    /* Generate start condition, the rest is done by TWI_vect */
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE));
+    return 0;
+}
+
+/*******************************************************************************
+ * Function: twi_async_status()
+ * Purpose:  Result of the last asynchronous transfer.
+ * Input:    None
+ * Returns:  TWI_ASYNC_BUSY, TWI_ASYNC_OK, TWI_ASYNC_NACK or TWI_ASYNC_ERROR
+ ******************************************************************************/
+uint8_t twi_async_status(void)
+{
+    return twi_async_state;
+}
+
+/*******************************************************************************
+ * Function: twi_async_abort()
+ * Purpose:  Release the TWI unit after a transfer that does not finish,
+ *           e.g. SDA held low by a slave.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void twi_async_abort(void)
+{
+    /* Disabling the unit releases SDA/SCL and clears the internal state */
+    HAL_WRITE(TWCR, 0);
+    twi_async_state = TWI_ASYNC_ERROR;
+}
+
+#ifndef TWI_SLAVE_ADDRESS
+/*******************************************************************************
+ * Function: twi_async_finish()
+ * Purpose:  Generate stop condition and publish the result of the transfer.
+ * Input:    result - TWI_ASYNC_OK, TWI_ASYNC_NACK or TWI_ASYNC_ERROR
+ * Returns:  None
+ ******************************************************************************/
+static void twi_async_finish(uint8_t result)
+{
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWSTO) | _BV(TWEN));
+    twi_async_state = result;
+}
+
+/**
+  * @brief TWI state machine of the asynchronous transfers, one step per
+  *        TWI status code.
+  */
+ISR(TWI_vect)
+{
+    switch (HAL_READ(TWSR) & 0xf8) {
+    case TW_START:
+    case TW_REP_START:
+        /* Read phase only after the write phase, probe is SLA+W alone */
+        if (twi_async_pos < twi_async_tx_len || twi_async_rx_len == 0) {
+            HAL_WRITE(TWDR, (twi_async_address << 1) + TWI_WRITE);
+        }
+        else {
+            twi_async_pos = 0;
+            HAL_WRITE(TWDR, (twi_async_address << 1) + TWI_READ);
+        }
+        HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEN) | _BV(TWIE));
+        break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        if (twi_async_pos < twi_async_tx_len) {
+            HAL_WRITE(TWDR, twi_async_tx[twi_async_pos++]);
+            HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEN) | _BV(TWIE));
+        }
+        else if (twi_async_rx_len) {
+            /* Repeated start for the read phase */
+            twi_async_tx_len = 0;
+            HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE));
+        }
+        else {
+            twi_async_finish(TWI_ASYNC_OK);
+        }
+        break;
+
+    case TW_MR_DATA_ACK:
+        twi_async_rx[twi_async_pos++] = HAL_READ(TWDR);
+        /* fall through */
+    case TW_MR_SLA_ACK:
+        /* ACK every byte except the last one */
+        if (twi_async_pos + 1 < twi_async_rx_len) {
+            HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE));
+        }
+        else {
+            HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEN) | _BV(TWIE));
+        }
+        break;
+
+    case TW_MR_DATA_NACK:
+        twi_async_rx[twi_async_pos++] = HAL_READ(TWDR);
+        twi_async_finish(TWI_ASYNC_OK);
+        break;
+
+    case TW_MT_SLA_NACK:
+    case TW_MR_SLA_NACK:
+    case TW_MT_DATA_NACK:
+        twi_async_finish(TWI_ASYNC_NACK);
+        break;
+
+    case TW_ARB_LOST:
+    default:
+        /* Bus error or lost arbitration: release the bus */
+        twi_async_finish(TWI_ASYNC_ERROR);
+        break;
+    }
+}
+#else
+/*******************************************************************************
+ * Function: twi_slave_init()
+ * Purpose:  Answer to TWI_SLAVE_ADDRESS as a slave device.
+ * Input:    None
+ * Returns:  None
+ ******************************************************************************/
+void twi_slave_init(void)
+{
+    /* Enable internal pull-up resistors */
+    HAL_CLEAR(DDR(TWI_PORT), _BV(TWI_SDA_PIN) | _BV(TWI_SCL_PIN));
+    HAL_SET(TWI_PORT, _BV(TWI_SDA_PIN) | _BV(TWI_SCL_PIN));
+
+    HAL_WRITE(TWAR, TWI_SLAVE_ADDRESS << 1);
+    HAL_WRITE(TWCR, _BV(TWEA) | _BV(TWEN) | _BV(TWIE));
+}
+
+/**
+  * @brief TWI state machine of the slave mode. The first byte written after
+  *        SLA+W selects the register, every further byte written or read
+  *        moves to the next register.
+  */
+ISR(TWI_vect)
+{
+    switch (HAL_READ(TWSR) & 0xf8) {
+    case TW_SR_SLA_ACK:
+    case TW_SR_ARB_LOST_SLA_ACK:
+    case TW_SR_GCALL_ACK:
+    case TW_SR_ARB_LOST_GCALL_ACK:
+        twi_slave_first = 1;
+        break;
+
+    case TW_SR_DATA_ACK:
+    case TW_SR_GCALL_DATA_ACK:
+        if (twi_slave_first) {
+            twi_slave_reg = HAL_READ(TWDR);
+            twi_slave_first = 0;
+        }
+        else {
+            twi_slave_receive(twi_slave_reg++, HAL_READ(TWDR));
+        }
+        break;
+
+    case TW_SR_STOP:
+        /* Stop or repeated start ends the write */
+        twi_slave_stop();
+        break;
+
+    case TW_ST_SLA_ACK:
+    case TW_ST_ARB_LOST_SLA_ACK:
+    case TW_ST_DATA_ACK:
+        HAL_WRITE(TWDR, twi_slave_transmit(twi_slave_reg++));
+        break;
+
+    case TW_BUS_ERROR:
+        /* Recover from an illegal start or stop */
+        HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWSTO) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE));
+        return;
+
+    case TW_SR_DATA_NACK:
+    case TW_SR_GCALL_DATA_NACK:
+    case TW_ST_DATA_NACK:
+    case TW_ST_LAST_DATA:
+    default:
+        break;
+    }
+    /* Clear the flag and keep answering to the own address */
+    HAL_WRITE(TWCR, _BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE));
+}
+#endif
+
+/* END OF FILE ****************************************************************/